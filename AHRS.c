@@ -0,0 +1,164 @@
+/*
+ * AHRS.c
+ *
+ *	Mahony quaternion filter for the MPU6050
+ *
+ */
+
+#include "AHRS.h"
+#include <math.h>
+
+/*
+ *	--------------------AHRS_Init----------------------
+ *	Reset to level attitude with zero bias
+ *	Input: Filter, Proportional Gain, Integral Gain
+ * 	Output: none
+ */
+void AHRS_Init(AHRS_t* ahrs, float kp, float ki){
+	ahrs->q0 = 1.0f;
+	ahrs->q1 = 0.0f;
+	ahrs->q2 = 0.0f;
+	ahrs->q3 = 0.0f;
+	ahrs->bias_x = 0.0f;
+	ahrs->bias_y = 0.0f;
+	ahrs->bias_z = 0.0f;
+	ahrs->kp = kp;
+	ahrs->ki = ki;
+	ahrs->last_cycles = 0;
+	ahrs->started = 0;
+}
+
+/*
+ *	-------------------AHRS_Update---------------------
+ *	Advance the filter by one sample. dt comes from the difference
+ *	of CYCCNT stamps, the first sample (or one after a long gap)
+ *	only starts the time base
+ *	Input: Filter, Gyro X/Y/Z (deg/s), Accel X/Y/Z (g), CYCCNT stamp
+ * 	Output: none
+ */
+void AHRS_Update(AHRS_t* ahrs, float gx, float gy, float gz, float ax, float ay, float az, uint32_t cycles){
+	float dt;
+	float norm_sq;
+	float recip;
+	float vx, vy, vz;
+	float ex, ey, ez;
+	float q0 = ahrs->q0;
+	float q1 = ahrs->q1;
+	float q2 = ahrs->q2;
+	float q3 = ahrs->q3;
+
+	/* Unsigned difference handles CYCCNT wrap (every ~268s at 16MHz) */
+	dt = (float)(cycles - ahrs->last_cycles) * (1.0f / SYS_CLOCK_HZ);
+	ahrs->last_cycles = cycles;
+	if(!ahrs->started || (dt > AHRS_DT_MAX)){
+		ahrs->started = 1;
+		return;
+	}
+
+	gx = gx * AHRS_DEG_TO_RAD - ahrs->bias_x;
+	gy = gy * AHRS_DEG_TO_RAD - ahrs->bias_y;
+	gz = gz * AHRS_DEG_TO_RAD - ahrs->bias_z;
+
+	/* Accel correction, skipped while the sensor is being shaken */
+	norm_sq = ax*ax + ay*ay + az*az;
+	if((norm_sq > AHRS_ACCEL_MIN_G * AHRS_ACCEL_MIN_G) && (norm_sq < AHRS_ACCEL_MAX_G * AHRS_ACCEL_MAX_G)){
+		recip = 1.0f / sqrtf(norm_sq);
+		ax *= recip;
+		ay *= recip;
+		az *= recip;
+
+		/* Gravity direction predicted by the quaternion (third row of R) */
+		vx = 2.0f * (q1*q3 - q0*q2);
+		vy = 2.0f * (q0*q1 + q2*q3);
+		vz = q0*q0 - q1*q1 - q2*q2 + q3*q3;
+
+		/* Error is the rotation between measured and predicted gravity */
+		ex = ay*vz - az*vy;
+		ey = az*vx - ax*vz;
+		ez = ax*vy - ay*vx;
+
+		/* Integral term learns the bias, proportional term corrects this step */
+		ahrs->bias_x -= ahrs->ki * ex * dt;
+		ahrs->bias_y -= ahrs->ki * ey * dt;
+		ahrs->bias_z -= ahrs->ki * ez * dt;
+		gx += ahrs->kp * ex + ahrs->ki * ex * dt;
+		gy += ahrs->kp * ey + ahrs->ki * ey * dt;
+		gz += ahrs->kp * ez + ahrs->ki * ez * dt;
+	}
+
+	/* q' = q + 0.5 * q x (0, w) * dt */
+	gx *= 0.5f * dt;
+	gy *= 0.5f * dt;
+	gz *= 0.5f * dt;
+	ahrs->q0 = q0 - q1*gx - q2*gy - q3*gz;
+	ahrs->q1 = q1 + q0*gx + q2*gz - q3*gy;
+	ahrs->q2 = q2 + q0*gy - q1*gz + q3*gx;
+	ahrs->q3 = q3 + q0*gz + q1*gy - q2*gx;
+
+	recip = 1.0f / sqrtf(ahrs->q0*ahrs->q0 + ahrs->q1*ahrs->q1 + ahrs->q2*ahrs->q2 + ahrs->q3*ahrs->q3);
+	ahrs->q0 *= recip;
+	ahrs->q1 *= recip;
+	ahrs->q2 *= recip;
+	ahrs->q3 *= recip;
+}
+
+/*
+ *	----------------AHRS_Update_Sample-----------------
+ *	Process a data-ready sample and feed it to the filter
+ *	Input: Filter, MPU6050 the sample came from, MPU6050 Sample
+ * 	Output: none
+ */
+void AHRS_Update_Sample(AHRS_t* ahrs, MPU6050_t* imu, MPU6050_SAMPLE_t* sample){
+	MPU6050_Process_Accel(imu, &sample->Accel);
+	MPU6050_Process_Gyro(imu, &sample->Gyro);
+
+	AHRS_Update(ahrs, sample->Gyro.Gx, sample->Gyro.Gy, sample->Gyro.Gz,
+		sample->Accel.Ax, sample->Accel.Ay, sample->Accel.Az, sample->Timestamp);
+}
+
+/*
+ *	------------------AHRS_Get_Euler-------------------
+ *	Roll, pitch and yaw of the current attitude
+ *	Input: Filter, Euler destination
+ * 	Output: none
+ */
+void AHRS_Get_Euler(AHRS_t* ahrs, AHRS_EULER_t* euler){
+	float q0 = ahrs->q0;
+	float q1 = ahrs->q1;
+	float q2 = ahrs->q2;
+	float q3 = ahrs->q3;
+	float sinp = 2.0f * (q0*q2 - q3*q1);
+
+	//Clamp so rounding near +/-90 degrees pitch cannot leave asinf's domain
+	if(sinp > 1.0f)
+		sinp = 1.0f;
+	if(sinp < -1.0f)
+		sinp = -1.0f;
+
+	euler->Roll = atan2f(2.0f * (q0*q1 + q2*q3), 1.0f - 2.0f * (q1*q1 + q2*q2)) * AHRS_RAD_TO_DEG;
+	euler->Pitch = asinf(sinp) * AHRS_RAD_TO_DEG;
+	euler->Yaw = atan2f(2.0f * (q0*q3 + q1*q2), 1.0f - 2.0f * (q2*q2 + q3*q3)) * AHRS_RAD_TO_DEG;
+}
+
+/*
+ *	-----------------AHRS_Get_Matrix-------------------
+ *	Rotation matrix of the current attitude (body to earth)
+ *	Input: Filter, 3x3 destination (row major)
+ * 	Output: none
+ */
+void AHRS_Get_Matrix(AHRS_t* ahrs, float R[3][3]){
+	float q0 = ahrs->q0;
+	float q1 = ahrs->q1;
+	float q2 = ahrs->q2;
+	float q3 = ahrs->q3;
+
+	R[0][0] = 1.0f - 2.0f * (q2*q2 + q3*q3);
+	R[0][1] = 2.0f * (q1*q2 - q0*q3);
+	R[0][2] = 2.0f * (q1*q3 + q0*q2);
+	R[1][0] = 2.0f * (q1*q2 + q0*q3);
+	R[1][1] = 1.0f - 2.0f * (q1*q1 + q3*q3);
+	R[1][2] = 2.0f * (q2*q3 - q0*q1);
+	R[2][0] = 2.0f * (q1*q3 - q0*q2);
+	R[2][1] = 2.0f * (q2*q3 + q0*q1);
+	R[2][2] = 1.0f - 2.0f * (q1*q1 + q2*q2);
+}
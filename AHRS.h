@@ -0,0 +1,97 @@
+/*
+ * AHRS.h
+ *
+ *	Attitude estimation from the MPU6050 gyroscope and accelerometer.
+ *	Mahony complementary filter on a unit quaternion: the gyro is
+ *	integrated with the real time between samples (CYCCNT stamps),
+ *	the accelerometer's gravity direction pulls roll/pitch back with
+ *	a proportional term, and an integral term tracks the gyro bias.
+ *	There is no magnetometer, so yaw is gyro only and drifts with
+ *	whatever Z bias the accelerometer cannot observe
+ *
+ */
+
+#ifndef AHRS_H_
+#define AHRS_H_
+
+#include <stdint.h>
+#include "util.h"
+#include "MPU6050.h"
+
+/* Filter Gains */
+#define AHRS_KP_DEFAULT				(0.5f)        // Accel correction, higher trusts the accel more
+#define AHRS_KI_DEFAULT				(0.01f)       // Bias learning rate, 0 disables bias estimation
+
+/* Integration Limits */
+#define AHRS_DT_MAX						(0.1f)        // Longer gaps restart the time base instead of integrating
+#define AHRS_ACCEL_MIN_G			(0.5f)        // Accel correction only while |a| is close to 1g
+#define AHRS_ACCEL_MAX_G			(1.5f)
+
+#define AHRS_DEG_TO_RAD				(0.0174532925f)
+#define AHRS_RAD_TO_DEG				(57.2957795f)
+
+/* Filter State */
+typedef struct{
+	float q0;												// Attitude quaternion, body to earth
+	float q1;
+	float q2;
+	float q3;
+	float bias_x;										// Gyro bias estimate (rad/s)
+	float bias_y;
+	float bias_z;
+	float kp;
+	float ki;
+	uint32_t last_cycles;						// CYCCNT of the previous sample
+	uint8_t started;								// Time base valid
+} AHRS_t;
+
+/* Euler Angles (degrees, aerospace ZYX order) */
+typedef struct{
+	float Roll;
+	float Pitch;
+	float Yaw;
+} AHRS_EULER_t;
+
+/*
+ *	--------------------AHRS_Init----------------------
+ *	Reset to level attitude with zero bias
+ *	Input: Filter, Proportional Gain, Integral Gain
+ * 	Output: none
+ */
+void AHRS_Init(AHRS_t* ahrs, float kp, float ki);
+
+/*
+ *	-------------------AHRS_Update---------------------
+ *	Advance the filter by one sample. dt comes from the difference
+ *	of CYCCNT stamps, the first sample (or one after a long gap)
+ *	only starts the time base
+ *	Input: Filter, Gyro X/Y/Z (deg/s), Accel X/Y/Z (g), CYCCNT stamp
+ * 	Output: none
+ */
+void AHRS_Update(AHRS_t* ahrs, float gx, float gy, float gz, float ax, float ay, float az, uint32_t cycles);
+
+/*
+ *	----------------AHRS_Update_Sample-----------------
+ *	Process a data-ready sample and feed it to the filter
+ *	Input: Filter, MPU6050 the sample came from, MPU6050 Sample
+ * 	Output: none
+ */
+void AHRS_Update_Sample(AHRS_t* ahrs, MPU6050_t* imu, MPU6050_SAMPLE_t* sample);
+
+/*
+ *	------------------AHRS_Get_Euler-------------------
+ *	Roll, pitch and yaw of the current attitude
+ *	Input: Filter, Euler destination
+ * 	Output: none
+ */
+void AHRS_Get_Euler(AHRS_t* ahrs, AHRS_EULER_t* euler);
+
+/*
+ *	-----------------AHRS_Get_Matrix-------------------
+ *	Rotation matrix of the current attitude (body to earth)
+ *	Input: Filter, 3x3 destination (row major)
+ * 	Output: none
+ */
+void AHRS_Get_Matrix(AHRS_t* ahrs, float R[3][3]);
+
+#endif
@@ -0,0 +1,246 @@
+/*
+ * DSP16.c
+ *
+ *	Dual 16-bit SIMD kernels for the MPU6050 sample blocks
+ *
+ */
+
+#include "DSP16.h"
+#include <string.h>
+
+/*
+ *	Packed pair primitives. A pair is two consecutive samples read as
+ *	one little-endian word (first sample in the bottom halfword). The
+ *	C versions mirror the instructions exactly, including the modulo
+ *	2^32 wrap of SMLAD, so every path produces the same output
+ */
+#if defined(__CC_ARM) && defined(__TARGET_FEATURE_DSPMUL)
+
+static __inline uint32_t DSP16_QSUB16(uint32_t a, uint32_t b){ return __qsub16(a, b); }
+static __inline int32_t DSP16_SMLAD(uint32_t a, uint32_t b, int32_t acc){ return __smlad(a, b, acc); }
+static __inline int64_t DSP16_SMLALD(uint32_t a, uint32_t b, int64_t acc){ return __smlald(a, b, acc); }
+static __inline int32_t DSP16_SSAT16(int32_t a){ return __ssat(a, 16); }
+/* No PKHBT intrinsic, armcc folds this shift/mask pattern into one */
+static __inline uint32_t DSP16_PKHBT(int32_t lo, int32_t hi){ return ((uint32_t)lo & 0xFFFFU) | ((uint32_t)hi << 16); }
+
+#elif defined(__ARM_FEATURE_DSP) && (defined(__GNUC__) || defined(__clang__))
+
+static __inline uint32_t DSP16_QSUB16(uint32_t a, uint32_t b){
+	uint32_t r;
+
+	__asm("qsub16 %0, %1, %2" : "=r"(r) : "r"(a), "r"(b));
+	return r;
+}
+
+static __inline int32_t DSP16_SMLAD(uint32_t a, uint32_t b, int32_t acc){
+	int32_t r;
+
+	__asm("smlad %0, %1, %2, %3" : "=r"(r) : "r"(a), "r"(b), "r"(acc));
+	return r;
+}
+
+static __inline int64_t DSP16_SMLALD(uint32_t a, uint32_t b, int64_t acc){
+	uint32_t lo = (uint32_t)acc;
+	uint32_t hi = (uint32_t)((uint64_t)acc >> 32);
+
+	__asm("smlald %0, %1, %2, %3" : "+r"(lo), "+r"(hi) : "r"(a), "r"(b));
+	return (int64_t)(((uint64_t)hi << 32) | lo);
+}
+
+static __inline int32_t DSP16_SSAT16(int32_t a){
+	int32_t r;
+
+	__asm("ssat %0, #16, %1" : "=r"(r) : "r"(a));
+	return r;
+}
+
+static __inline uint32_t DSP16_PKHBT(int32_t lo, int32_t hi){
+	uint32_t r;
+
+	__asm("pkhbt %0, %1, %2, lsl #16" : "=r"(r) : "r"(lo), "r"(hi));
+	return r;
+}
+
+#else
+
+static __inline int32_t DSP16_SSAT16(int32_t a){
+	if(a > INT16_MAX)
+		return INT16_MAX;
+	if(a < INT16_MIN)
+		return INT16_MIN;
+	return a;
+}
+
+static __inline uint32_t DSP16_PKHBT(int32_t lo, int32_t hi){
+	return ((uint32_t)lo & 0xFFFFU) | ((uint32_t)hi << 16);
+}
+
+static __inline uint32_t DSP16_QSUB16(uint32_t a, uint32_t b){
+	int32_t lo = DSP16_SSAT16((int32_t)(int16_t)a - (int32_t)(int16_t)b);
+	int32_t hi = DSP16_SSAT16((int32_t)(int16_t)(a >> 16) - (int32_t)(int16_t)(b >> 16));
+
+	return DSP16_PKHBT(lo, hi);
+}
+
+static __inline int32_t DSP16_SMLAD(uint32_t a, uint32_t b, int32_t acc){
+	uint32_t r = (uint32_t)acc;
+
+	r += (uint32_t)((int32_t)(int16_t)a * (int16_t)b);
+	r += (uint32_t)((int32_t)(int16_t)(a >> 16) * (int16_t)(b >> 16));
+	return (int32_t)r;
+}
+
+static __inline int64_t DSP16_SMLALD(uint32_t a, uint32_t b, int64_t acc){
+	return acc + (int32_t)(int16_t)a * (int16_t)b + (int32_t)(int16_t)(a >> 16) * (int16_t)(b >> 16);
+}
+
+#endif
+
+/*
+ *	Block axis arrays are only halfword aligned (Axis[1] starts 170 bytes
+ *	in), the fixed size copy becomes a single unaligned LDR/STR on the M4
+ */
+static __inline uint32_t DSP16_Load_Pair(const int16_t* p){
+	uint32_t v;
+
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static __inline void DSP16_Store_Pair(int16_t* p, uint32_t v){
+	memcpy(p, &v, sizeof(v));
+}
+
+/*
+ *	-------------------DSP16_Sub_Bias-------------------
+ *	Subtract a constant from every sample, saturating to int16
+ *	Input: Samples (modified in place), Bias, Sample Count
+ * 	Output: none
+ */
+void DSP16_Sub_Bias(int16_t* x, int16_t bias, uint32_t n){
+	uint32_t bias2 = (uint32_t)(uint16_t)bias * 0x00010001UL;
+	uint32_t i;
+
+	for(i = 0; i + 1 < n; i += 2)
+		DSP16_Store_Pair(&x[i], DSP16_QSUB16(DSP16_Load_Pair(&x[i]), bias2));
+
+	if(i < n)
+		x[i] = (int16_t)DSP16_SSAT16((int32_t)x[i] - bias);
+}
+
+/*
+ *	--------------------DSP16_Scale---------------------
+ *	Multiply every sample by a fixed point gain, saturating to int16.
+ *	shift sets the gain's format (15 for Q15, 14 for Q14 up to 2.0)
+ *	Input: Samples (modified in place), Gain, Gain Fraction Bits, Sample Count
+ * 	Output: 0 on success, 1 on bad shift
+ */
+uint8_t DSP16_Scale(int16_t* x, int16_t gain, uint8_t shift, uint32_t n){
+	int32_t round;
+	int32_t lo, hi;
+	uint32_t v;
+	uint32_t i;
+
+	/* Asserting Param */
+	if((shift == 0) || (shift > DSP16_Q15_SHIFT))
+		return 1;
+
+	round = 1L << (shift - 1);
+
+	/* One word in, two SMULBB/SMULTB-sized products, one word out */
+	for(i = 0; i + 1 < n; i += 2){
+		v = DSP16_Load_Pair(&x[i]);
+		lo = DSP16_SSAT16(((int32_t)(int16_t)v * gain + round) >> shift);
+		hi = DSP16_SSAT16(((int32_t)(int16_t)(v >> 16) * gain + round) >> shift);
+		DSP16_Store_Pair(&x[i], DSP16_PKHBT(lo, hi));
+	}
+
+	if(i < n)
+		x[i] = (int16_t)DSP16_SSAT16(((int32_t)x[i] * gain + round) >> shift);
+
+	return 0;
+}
+
+/*
+ *	-------------------DSP16_FIR_Init-------------------
+ *	Load Q15 taps and clear the delay line. The accumulator is 32 bits,
+ *	so the absolute tap sum must stay below 2.0
+ *	Input: Filter, Q15 Taps (h[0] applies to the newest sample), Tap Count
+ * 	Output: 0 on success, 1 on bad tap count
+ */
+uint8_t DSP16_FIR_Init(DSP16_FIR_t* fir, const int16_t* taps, uint8_t len){
+	uint8_t k;
+	uint8_t j;
+
+	/* Asserting Param */
+	if((len == 0) || (len > DSP16_FIR_MAX_TAPS))
+		return 1;
+
+	/* Pad to an even count so the tap loop is whole SMLAD pairs */
+	fir->Len = (uint8_t)((len + 1) & ~1U);
+
+	/* Reverse: Taps[Len - 1] meets the newest sample, a padded zero the oldest */
+	for(k = 0; k < fir->Len; k++){
+		j = (uint8_t)(fir->Len - 1 - k);
+		fir->Taps[k] = (j < len) ? taps[j] : 0;
+	}
+
+	memset(fir->Line, 0, sizeof(fir->Line));
+
+	return 0;
+}
+
+/*
+ *	---------------------DSP16_FIR----------------------
+ *	Low pass (or any FIR) a block of samples. The delay line carries
+ *	across calls so consecutive blocks filter as one stream
+ *	Input: Filter, Samples (modified in place), Sample Count
+ * 	Output: none
+ */
+void DSP16_FIR(DSP16_FIR_t* fir, int16_t* x, uint32_t n){
+	const uint32_t hist = fir->Len - 1U;
+	const int16_t* p;
+	uint32_t chunk;
+	uint32_t i, k;
+	int32_t acc;
+
+	while(n){
+		chunk = (n < DSP16_FIR_CHUNK) ? n : DSP16_FIR_CHUNK;
+
+		/* Line = [Len - 1 history][chunk], output i uses Line[i .. i + Len - 1] */
+		memcpy(&fir->Line[hist], x, chunk * sizeof(int16_t));
+
+		for(i = 0; i < chunk; i++){
+			p = &fir->Line[i];
+			acc = 1L << (DSP16_Q15_SHIFT - 1);
+			for(k = 0; k < fir->Len; k += 2)
+				acc = DSP16_SMLAD(DSP16_Load_Pair(&p[k]), DSP16_Load_Pair(&fir->Taps[k]), acc);
+			x[i] = (int16_t)DSP16_SSAT16(acc >> DSP16_Q15_SHIFT);
+		}
+
+		/* Keep the newest Len - 1 inputs as the next chunk's history */
+		memmove(fir->Line, &fir->Line[chunk], hist * sizeof(int16_t));
+
+		x += chunk;
+		n -= chunk;
+	}
+}
+
+/*
+ *	---------------------DSP16_Dot----------------------
+ *	Dot product of two sample arrays (energy when a == b)
+ *	Input: Array A, Array B, Sample Count
+ * 	Output: Sum of a[i] * b[i]
+ */
+int64_t DSP16_Dot(const int16_t* a, const int16_t* b, uint32_t n){
+	int64_t acc = 0;
+	uint32_t i;
+
+	for(i = 0; i + 1 < n; i += 2)
+		acc = DSP16_SMLALD(DSP16_Load_Pair(&a[i]), DSP16_Load_Pair(&b[i]), acc);
+
+	if(i < n)
+		acc += (int32_t)a[i] * b[i];
+
+	return acc;
+}
@@ -0,0 +1,80 @@
+/*
+ * DSP16.h
+ *
+ *	Block kernels over int16 sample arrays (the per-axis arrays of
+ *	an MPU6050_BLOCK_t). Two samples are processed per 32-bit word
+ *	with the Cortex-M4 DSP instructions: QSUB16 for saturating bias
+ *	removal, SSAT/PKHBT to repack scaled pairs, SMLAD for the FIR
+ *	taps and SMLALD for 64-bit dot products. armcc uses its SIMD
+ *	intrinsics, GCC/clang an inline asm path, and any other target
+ *	(or a core without the DSP extension) the portable C version
+ *	which gives bit-identical results
+ *
+ */
+
+#ifndef DSP16_H_
+#define DSP16_H_
+
+#include <stdint.h>
+
+/* FIR Limits */
+#define DSP16_FIR_MAX_TAPS			(32)          // Odd tap counts are padded with one zero tap
+#define DSP16_FIR_CHUNK					(32)          // Samples filtered per pass through the delay line
+
+/* Q15 Fixed Point */
+#define DSP16_Q15_SHIFT					(15)
+#define DSP16_Q15(x)						(((x) * 32768.0f >= (float)INT16_MAX) ? (int16_t)INT16_MAX :	\
+																 ((x) * 32768.0f <= (float)INT16_MIN) ? (int16_t)INT16_MIN :	\
+																 (int16_t)((x) * 32768.0f + (((x) < 0.0f) ? -0.5f : 0.5f)))	// Rounded, saturates at 1.0 and below -1.0
+
+/* FIR Filter State */
+typedef struct{
+	int16_t Taps[DSP16_FIR_MAX_TAPS];								// Q15, reversed so taps and samples both ascend
+	int16_t Line[DSP16_FIR_MAX_TAPS - 1 + DSP16_FIR_CHUNK];	// History followed by the current chunk
+	uint8_t Len;																		// Tap count after padding (even)
+} DSP16_FIR_t;
+
+/*
+ *	-------------------DSP16_Sub_Bias-------------------
+ *	Subtract a constant from every sample, saturating to int16
+ *	Input: Samples (modified in place), Bias, Sample Count
+ * 	Output: none
+ */
+void DSP16_Sub_Bias(int16_t* x, int16_t bias, uint32_t n);
+
+/*
+ *	--------------------DSP16_Scale---------------------
+ *	Multiply every sample by a fixed point gain, saturating to int16.
+ *	shift sets the gain's format (15 for Q15, 14 for Q14 up to 2.0)
+ *	Input: Samples (modified in place), Gain, Gain Fraction Bits, Sample Count
+ * 	Output: 0 on success, 1 on bad shift
+ */
+uint8_t DSP16_Scale(int16_t* x, int16_t gain, uint8_t shift, uint32_t n);
+
+/*
+ *	-------------------DSP16_FIR_Init-------------------
+ *	Load Q15 taps and clear the delay line. The accumulator is 32 bits,
+ *	so the absolute tap sum must stay below 2.0
+ *	Input: Filter, Q15 Taps (h[0] applies to the newest sample), Tap Count
+ * 	Output: 0 on success, 1 on bad tap count
+ */
+uint8_t DSP16_FIR_Init(DSP16_FIR_t* fir, const int16_t* taps, uint8_t len);
+
+/*
+ *	---------------------DSP16_FIR----------------------
+ *	Low pass (or any FIR) a block of samples. The delay line carries
+ *	across calls so consecutive blocks filter as one stream
+ *	Input: Filter, Samples (modified in place), Sample Count
+ * 	Output: none
+ */
+void DSP16_FIR(DSP16_FIR_t* fir, int16_t* x, uint32_t n);
+
+/*
+ *	---------------------DSP16_Dot----------------------
+ *	Dot product of two sample arrays (energy when a == b)
+ *	Input: Array A, Array B, Sample Count
+ * 	Output: Sum of a[i] * b[i]
+ */
+int64_t DSP16_Dot(const int16_t* a, const int16_t* b, uint32_t n);
+
+#endif
@@ -0,0 +1,174 @@
+/*
+ * Decimator.c
+ *
+ *	CIC plus compensating FIR decimation
+ *
+ */
+
+#include "Decimator.h"
+#include <math.h>
+
+/*
+ *	------------------Decim_CIC_Response----------------
+ *	Local function for the CIC magnitude at the CIC output rate
+ *	Input: Decimator, Frequency (rad/sample at the CIC output, 0 .. pi)
+ * 	Output: |sin(w / 2) / (R sin(w / 2R))|^K
+ */
+static float Decim_CIC_Response(DECIM_t* d, float w){
+	float r = (float)d->CIC_Rate;
+	float g;
+	float p = 1.0f;
+	uint8_t k;
+
+	if(w <= 0.0f)
+		return 1.0f;
+
+	g = sinf(0.5f * w) / (r * sinf(0.5f * w / r));
+	if(g < 0.0f)
+		g = -g;
+	for(k = 0; k < d->CIC_Order; k++)
+		p *= g;
+
+	return p;
+}
+
+/*
+ *	--------------------Decim_Init----------------------
+ *	Configure the stages, design the compensating FIR and clear the state
+ *	Input: Decimator, CIC Order K (1 - 4), CIC Rate R, FIR Rate D (>= 1),
+ *				 FIR Taps (odd, up to DECIM_FIR_MAX_TAPS), Units per LSB
+ * 	Output: 0 on success, 1 on bad parameters
+ */
+uint8_t Decim_Init(DECIM_t* d, uint8_t order, uint16_t cic_rate, uint8_t fir_rate, uint8_t taps, float scale){
+	uint32_t gain = 1;
+	uint32_t i, k, half;
+	float wc, dw, w, h, c, inv, sum;
+
+	/* Asserting Param */
+	if((order == 0) || (order > DECIM_CIC_MAX_ORDER) || (cic_rate == 0) || (fir_rate == 0))
+		return 1;
+	if(((taps & 1) == 0) || (taps > DECIM_FIR_MAX_TAPS))
+		return 1;
+	for(k = 0; k < order; k++){
+		gain *= cic_rate;
+		if(gain > DECIM_CIC_MAX_GAIN)
+			return 1;
+	}
+
+	d->CIC_Order = order;
+	d->CIC_Rate = cic_rate;
+	d->FIR_Rate = fir_rate;
+	d->FIR_Len = taps;
+	d->Scale = scale / (float)gain;
+	d->Offset = 0.0f;
+
+	/*
+	 * Frequency sampled design: the inverse CIC response up to the
+	 * cutoff, zero beyond, integrated into a linear phase FIR (midpoint
+	 * rule) and Hamming windowed. The taps are symmetric, so only half
+	 * of them are integrated
+	 */
+	half = taps / 2;
+	wc = DECIM_FIR_CUTOFF * DECIM_PI / (float)fir_rate;
+	dw = wc / DECIM_DESIGN_POINTS;
+	c = 0.5f * (float)(taps - 1);
+	for(i = 0; i <= half; i++)
+		d->Taps[i] = 0.0f;
+	for(k = 0; k < DECIM_DESIGN_POINTS; k++){
+		w = ((float)k + 0.5f) * dw;
+		inv = dw / (DECIM_PI * Decim_CIC_Response(d, w));
+		for(i = 0; i <= half; i++)
+			d->Taps[i] += cosf(w * ((float)i - c)) * inv;
+	}
+
+	sum = 0.0f;
+	for(i = 0; i <= half; i++){
+		h = d->Taps[i];
+		if(taps > 1)
+			h *= 0.54f - 0.46f * cosf(2.0f * DECIM_PI * (float)i / (float)(taps - 1));
+		d->Taps[i] = h;
+		d->Taps[taps - 1 - i] = h;
+		sum += (i == half) ? h : 2.0f * h;
+	}
+
+	/* Unity gain at DC, the CIC's own gain is taken out by Scale */
+	for(i = 0; i < taps; i++)
+		d->Taps[i] /= sum;
+
+	for(k = 0; k < DECIM_CIC_MAX_ORDER; k++){
+		d->Integ[k] = 0;
+		d->Comb[k] = 0;
+	}
+	for(i = 0; i < 2 * DECIM_FIR_MAX_TAPS; i++)
+		d->Line[i] = 0.0f;
+	d->CIC_Phase = 0;
+	d->FIR_Phase = 0;
+	d->Pos = 0;
+
+	return 0;
+}
+
+/*
+ *	-------------------Decim_Set_Offset-----------------
+ *	Set the bias subtracted from the output (it can follow the sensor's
+ *	calibration without touching the filter state)
+ *	Input: Decimator, Offset (units)
+ * 	Output: none
+ */
+void Decim_Set_Offset(DECIM_t* d, float offset){
+	d->Offset = offset;
+}
+
+/*
+ *	-------------------Decim_Process--------------------
+ *	Run a block of raw samples through the pipeline. State carries
+ *	across calls, so blocks of any length join into one stream
+ *	Input: Decimator, Raw Samples, Sample Count, Output array
+ *				 (at least n / (R * D) + 1 entries)
+ * 	Output: Number of outputs written
+ */
+uint32_t Decim_Process(DECIM_t* d, const int16_t* x, uint32_t n, float* out){
+	const uint8_t order = d->CIC_Order;
+	const uint8_t len = d->FIR_Len;
+	const float* line;
+	uint32_t count = 0;
+	uint32_t i;
+	uint32_t v, t;
+	uint8_t k;
+	float acc;
+
+	for(i = 0; i < n; i++){
+		/* Integrators at the input rate, wrap-around cancels in the combs */
+		v = (uint32_t)(int32_t)x[i];
+		for(k = 0; k < order; k++){
+			d->Integ[k] += v;
+			v = d->Integ[k];
+		}
+		if(++d->CIC_Phase < d->CIC_Rate)
+			continue;
+		d->CIC_Phase = 0;
+
+		/* Combs at the CIC output rate */
+		for(k = 0; k < order; k++){
+			t = v - d->Comb[k];
+			d->Comb[k] = v;
+			v = t;
+		}
+
+		/* Newest value goes in front, Taps[0] meets it */
+		d->Pos = (d->Pos == 0) ? (uint8_t)(len - 1) : (uint8_t)(d->Pos - 1);
+		d->Line[d->Pos] = (float)(int32_t)v * d->Scale;
+		d->Line[d->Pos + len] = d->Line[d->Pos];
+		if(++d->FIR_Phase < d->FIR_Rate)
+			continue;
+		d->FIR_Phase = 0;
+
+		line = &d->Line[d->Pos];
+		acc = 0.0f;
+		for(k = 0; k < len; k++)
+			acc += d->Taps[k] * line[k];
+		out[count++] = acc - d->Offset;
+	}
+
+	return count;
+}
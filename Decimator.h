@@ -0,0 +1,82 @@
+/*
+ * Decimator.h
+ *
+ *	Multi-rate decimation of one raw sensor axis, meant to run on the
+ *	per-axis arrays of an MPU6050_BLOCK_t. A cascaded integrator-comb
+ *	(CIC) filter does the bulk of the rate change with nothing but
+ *	integer adds at the input rate, then a compensating FIR running
+ *	at the CIC output rate flattens the CIC's sinc^K droop, removes
+ *	what the CIC lets alias and decimates by the remaining factor.
+ *	Only the kept FIR outputs are computed, so downstream code sees
+ *	(CIC rate x FIR rate) times fewer samples, with the noise of the
+ *	dropped bandwidth averaged out instead of aliased in
+ *
+ */
+
+#ifndef DECIMATOR_H_
+#define DECIMATOR_H_
+
+#include <stdint.h>
+
+/* Limits (the CIC gain R^K must fit the 32-bit integrators above int16) */
+#define DECIM_CIC_MAX_ORDER			(4)
+#define DECIM_CIC_MAX_GAIN			(65536UL)
+#define DECIM_FIR_MAX_TAPS			(48)
+
+/* Compensating FIR Design */
+#define DECIM_FIR_CUTOFF				(0.8f)        // -6dB point as a fraction of the output Nyquist
+#define DECIM_DESIGN_POINTS			(128)         // Frequency grid of the inverse-sinc design integral
+
+#define DECIM_PI								(3.14159265f)
+
+/* Decimator State */
+typedef struct{
+	/* Configuration */
+	uint8_t CIC_Order;							// K, stages
+	uint16_t CIC_Rate;							// R
+	uint8_t FIR_Rate;								// D, 1 for no further decimation
+	uint8_t FIR_Len;
+	float Scale;										// Units per LSB / R^K, applied at the CIC output
+	float Offset;										// Subtracted from every output (bias in units)
+	float Taps[DECIM_FIR_MAX_TAPS];
+
+	/* CIC (modulo 2^32 arithmetic, exact as long as the output fits) */
+	uint32_t Integ[DECIM_CIC_MAX_ORDER];
+	uint32_t Comb[DECIM_CIC_MAX_ORDER];
+	uint16_t CIC_Phase;
+
+	/* FIR, each value is written twice so the taps always see Line[Pos .. Pos + Len - 1] */
+	float Line[2 * DECIM_FIR_MAX_TAPS];
+	uint8_t Pos;
+	uint8_t FIR_Phase;
+} DECIM_t;
+
+/*
+ *	--------------------Decim_Init----------------------
+ *	Configure the stages, design the compensating FIR and clear the state
+ *	Input: Decimator, CIC Order K (1 - 4), CIC Rate R, FIR Rate D (>= 1),
+ *				 FIR Taps (odd, up to DECIM_FIR_MAX_TAPS), Units per LSB
+ * 	Output: 0 on success, 1 on bad parameters
+ */
+uint8_t Decim_Init(DECIM_t* d, uint8_t order, uint16_t cic_rate, uint8_t fir_rate, uint8_t taps, float scale);
+
+/*
+ *	-------------------Decim_Set_Offset-----------------
+ *	Set the bias subtracted from the output (it can follow the sensor's
+ *	calibration without touching the filter state)
+ *	Input: Decimator, Offset (units)
+ * 	Output: none
+ */
+void Decim_Set_Offset(DECIM_t* d, float offset);
+
+/*
+ *	-------------------Decim_Process--------------------
+ *	Run a block of raw samples through the pipeline. State carries
+ *	across calls, so blocks of any length join into one stream
+ *	Input: Decimator, Raw Samples, Sample Count, Output array
+ *				 (at least n / (R * D) + 1 entries)
+ * 	Output: Number of outputs written
+ */
+uint32_t Decim_Process(DECIM_t* d, const int16_t* x, uint32_t n, float* out);
+
+#endif
@@ -0,0 +1,99 @@
+/*
+ * EEPROM.c
+ *
+ *	Word access to the TM4C123 on-chip EEPROM
+ *
+ */
+
+#include "EEPROM.h"
+#include "tm4c123gh6pm.h"
+
+/*
+ *	----------------EEPROM_Wait_Done-------------------
+ *	Local function to wait for the controller to finish
+ *	Input: none
+ *	Output: none
+ */
+static void EEPROM_Wait_Done(void){
+	while(EEPROM_EEDONE_R & EEPROM_EEDONE_WORKING){};
+}
+
+/*
+ *	-------------------EEPROM_Init---------------------
+ *	Enable the EEPROM module and recover it from any interrupted
+ *	write, following the datasheet start-up sequence
+ *	Input: none
+ *	Output: 0 if ready, EEPROM_ERR_RETRY if the module is faulted
+ */
+uint8_t EEPROM_Init(void){
+	
+	SYSCTL_RCGCEEPROM_R |= SYSCTL_RCGCEEPROM_R0;
+	while((SYSCTL_PREEPROM_R & SYSCTL_PREEPROM_R0) == 0){};
+	EEPROM_Wait_Done();
+	
+	if(EEPROM_EESUPP_R & (EEPROM_EESUPP_PRETRY | EEPROM_EESUPP_ERETRY))
+		return EEPROM_ERR_RETRY;
+	
+	/* Reset lets the controller finish any copy/erase left over from a power loss */
+	SYSCTL_SREEPROM_R |= SYSCTL_SREEPROM_R0;
+	SYSCTL_SREEPROM_R &= ~SYSCTL_SREEPROM_R0;
+	while((SYSCTL_PREEPROM_R & SYSCTL_PREEPROM_R0) == 0){};
+	EEPROM_Wait_Done();
+	
+	if(EEPROM_EESUPP_R & (EEPROM_EESUPP_PRETRY | EEPROM_EESUPP_ERETRY))
+		return EEPROM_ERR_RETRY;
+	
+	return 0;
+}
+
+/*
+ *	-------------------EEPROM_Read---------------------
+ *	Read consecutive words
+ *	Input: Word Address, Destination, Word Count
+ *	Output: Any Errors if detected, otherwise 0
+ */
+uint8_t EEPROM_Read(uint32_t addr, uint32_t* data, uint32_t count){
+	uint32_t i;
+	
+	if((addr + count) > EEPROM_SIZE_WORDS)
+		return EEPROM_ERR_RANGE;
+	
+	for(i = 0; i < count; i++, addr++){
+		EEPROM_EEBLOCK_R = addr / EEPROM_BLOCK_WORDS;
+		EEPROM_EEOFFSET_R = addr % EEPROM_BLOCK_WORDS;
+		data[i] = EEPROM_EERDWR_R;
+	}
+	
+	return 0;
+}
+
+/*
+ *	-------------------EEPROM_Write--------------------
+ *	Write consecutive words, words that already hold the value are
+ *	skipped to save endurance
+ *	Input: Word Address, Source, Word Count
+ *	Output: Any Errors if detected, otherwise 0
+ */
+uint8_t EEPROM_Write(uint32_t addr, uint32_t* data, uint32_t count){
+	uint32_t i;
+	
+	if((addr + count) > EEPROM_SIZE_WORDS)
+		return EEPROM_ERR_RANGE;
+	
+	for(i = 0; i < count; i++, addr++){
+		EEPROM_EEBLOCK_R = addr / EEPROM_BLOCK_WORDS;
+		EEPROM_EEOFFSET_R = addr % EEPROM_BLOCK_WORDS;
+		if(EEPROM_EERDWR_R == data[i])
+			continue;
+		
+		EEPROM_EERDWR_R = data[i];
+		EEPROM_Wait_Done();
+		
+		if(EEPROM_EEDONE_R & (EEPROM_EEDONE_NOPERM | EEPROM_EEDONE_INVPL))
+			return EEPROM_ERR_WRITE;
+		if(EEPROM_EESUPP_R & EEPROM_EESUPP_PRETRY)
+			return EEPROM_ERR_RETRY;
+	}
+	
+	return 0;
+}
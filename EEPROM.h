@@ -0,0 +1,49 @@
+/*
+ * EEPROM.h
+ *
+ *	Provides word access to the TM4C123 on-chip EEPROM
+ *	(2KB, 32 blocks of 16 words)
+ *
+ */
+
+#ifndef EEPROM_H_
+#define EEPROM_H_
+
+#include <stdint.h>
+
+/* Geometry */
+#define EEPROM_BLOCK_WORDS		(16)          // Words per block
+#define EEPROM_SIZE_WORDS			(512)         // 2KB
+
+/* Error Codes */
+#define EEPROM_ERR_RETRY			(0x01)        // Controller reports a failed program/erase, power cycle needed
+#define EEPROM_ERR_WRITE			(0x02)        // Write rejected (no permission or bad supply)
+#define EEPROM_ERR_RANGE			(0x04)        // Access past the end of the EEPROM
+
+/*
+ *	-------------------EEPROM_Init---------------------
+ *	Enable the EEPROM module and recover it from any interrupted
+ *	write, following the datasheet start-up sequence
+ *	Input: none
+ *	Output: 0 if ready, EEPROM_ERR_RETRY if the module is faulted
+ */
+uint8_t EEPROM_Init(void);
+
+/*
+ *	-------------------EEPROM_Read---------------------
+ *	Read consecutive words
+ *	Input: Word Address, Destination, Word Count
+ *	Output: Any Errors if detected, otherwise 0
+ */
+uint8_t EEPROM_Read(uint32_t addr, uint32_t* data, uint32_t count);
+
+/*
+ *	-------------------EEPROM_Write--------------------
+ *	Write consecutive words, words that already hold the value are
+ *	skipped to save endurance
+ *	Input: Word Address, Source, Word Count
+ *	Output: Any Errors if detected, otherwise 0
+ */
+uint8_t EEPROM_Write(uint32_t addr, uint32_t* data, uint32_t count);
+
+#endif
@@ -0,0 +1,95 @@
+/*
+ * FastMath.c
+ *
+ *	Polynomial and Newton kernels for the angle computation
+ *
+ */
+
+#include "FastMath.h"
+
+/*
+ *	------------------FastMath_Atan2-------------------
+ *	Four quadrant arctangent
+ *	Input: y, x
+ *	Output: Angle in radians (-pi, pi], 0 for (0, 0)
+ */
+float FastMath_Atan2(float y, float x){
+	float ax = (x < 0.0f) ? -x : x;
+	float ay = (y < 0.0f) ? -y : y;
+	float z;
+	float z2;
+	float r;
+
+	if((ax == 0.0f) && (ay == 0.0f))
+		return 0.0f;
+
+	/* Reduce to z in [0, 1] so the polynomial only covers one octant */
+	if(ay <= ax){
+		z = ay / ax;
+		z2 = z * z;
+		r = z * (FASTMATH_ATAN_C1 + z2 * (FASTMATH_ATAN_C3 + z2 * FASTMATH_ATAN_C5));
+	}
+	else{
+		z = ax / ay;
+		z2 = z * z;
+		r = FASTMATH_PI_2 - z * (FASTMATH_ATAN_C1 + z2 * (FASTMATH_ATAN_C3 + z2 * FASTMATH_ATAN_C5));
+	}
+
+	if(x < 0.0f)
+		r = FASTMATH_PI - r;
+	if(y < 0.0f)
+		r = -r;
+
+	return r;
+}
+
+/*
+ *	------------------FastMath_Sqrt--------------------
+ *	Square root
+ *	Input: x >= 0
+ *	Output: sqrt(x)
+ */
+float FastMath_Sqrt(float x){
+#if defined(__ARM_FP) && (defined(__GNUC__) || defined(__clang__))
+	float r;
+
+	/* Single VSQRT.F32 (14 cycles), no errno handling */
+	__asm("vsqrt.f32 %0, %1" : "=t"(r) : "t"(x));
+	return r;
+#elif defined(__CC_ARM) && defined(__TARGET_FPU_VFP)
+	return __sqrtf(x);
+#else
+	if(x <= 0.0f)
+		return 0.0f;
+
+	return x * FastMath_InvSqrt(x);
+#endif
+}
+
+/*
+ *	-----------------FastMath_InvSqrt------------------
+ *	Reciprocal square root
+ *	Input: x > 0
+ *	Output: 1 / sqrt(x)
+ */
+float FastMath_InvSqrt(float x){
+#if (defined(__ARM_FP) && (defined(__GNUC__) || defined(__clang__))) || (defined(__CC_ARM) && defined(__TARGET_FPU_VFP))
+	return 1.0f / FastMath_Sqrt(x);
+#else
+	union{
+		float f;
+		uint32_t i;
+	} conv;
+	float half = 0.5f * x;
+	uint8_t n;
+
+	/* Halving the exponent through the integer view gives a ~3% seed */
+	conv.f = x;
+	conv.i = FASTMATH_INVSQRT_MAGIC - (conv.i >> 1);
+
+	for(n = 0; n < FASTMATH_INVSQRT_ITER; n++)
+		conv.f = conv.f * (1.5f - half * conv.f * conv.f);
+
+	return conv.f;
+#endif
+}
@@ -0,0 +1,55 @@
+/*
+ * FastMath.h
+ *
+ *	Bounded-error replacements for the libm calls in the angle
+ *	hot path. atan2 is a minimax polynomial on an octant-reduced
+ *	argument (max error 0.035 deg), square roots use VSQRT when
+ *	the build has hardware floating point and a bit-trick seed
+ *	with Newton steps otherwise
+ *
+ */
+
+#ifndef FASTMATH_H_
+#define FASTMATH_H_
+
+#include <stdint.h>
+
+/* Constants */
+#define FASTMATH_PI						(3.14159265f)
+#define FASTMATH_PI_2					(1.57079633f)
+
+/* atan(z) ~ z * (C1 + z^2 * (C3 + z^2 * C5)) on [0, 1], |error| < 6.1e-4 rad (0.035 deg) */
+#define FASTMATH_ATAN_C1			(0.995354f)
+#define FASTMATH_ATAN_C3			(-0.288679f)
+#define FASTMATH_ATAN_C5			(0.079331f)
+
+/* Inverse square root without an FPU: magic seed then Newton steps
+	 (1 step: 1.8e-3 relative error, 2 steps: 5e-6) */
+#define FASTMATH_INVSQRT_MAGIC	(0x5F3759DFUL)
+#define FASTMATH_INVSQRT_ITER		(2)
+
+/*
+ *	------------------FastMath_Atan2-------------------
+ *	Four quadrant arctangent
+ *	Input: y, x
+ *	Output: Angle in radians (-pi, pi], 0 for (0, 0)
+ */
+float FastMath_Atan2(float y, float x);
+
+/*
+ *	------------------FastMath_Sqrt--------------------
+ *	Square root
+ *	Input: x >= 0
+ *	Output: sqrt(x)
+ */
+float FastMath_Sqrt(float x);
+
+/*
+ *	-----------------FastMath_InvSqrt------------------
+ *	Reciprocal square root
+ *	Input: x > 0
+ *	Output: 1 / sqrt(x)
+ */
+float FastMath_InvSqrt(float x);
+
+#endif
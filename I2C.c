@@ -10,142 +10,588 @@
  
 #include "I2C.h"
 #include "tm4c123gh6pm.h"
+#ifdef I2C_TRACE
+#include "UART0.h"
+#include <stdio.h>
+#endif
+
+/* Asynchronous Engine Phases */
+#define XFER_PHASE_REG			(0U)		// Register address byte is on the bus
+#define XFER_PHASE_TX				(1U)		// Writing data bytes
+#define XFER_PHASE_RX				(2U)		// Reading data bytes
+#define XFER_PHASE_STOP			(3U)		// Standalone STOP, finish on next interrupt
+
+/* Register Offsets (same layout on every I2C module / GPIO port) */
+#define I2C_O_MSA						(0x000)
+#define I2C_O_MCS						(0x004)
+#define I2C_O_MDR						(0x008)
+#define I2C_O_MTPR					(0x00C)
+#define I2C_O_MIMR					(0x010)
+#define I2C_O_MRIS					(0x014)
+#define I2C_O_MMIS					(0x018)
+#define I2C_O_MICR					(0x01C)
+#define I2C_O_MCR						(0x020)
+#define I2C_O_MCLKOCNT			(0x024)
+#define GPIO_O_DATA					(0x3FC)
+#define GPIO_O_DIR					(0x400)
+#define GPIO_O_AFSEL				(0x420)
+#define GPIO_O_ODR					(0x50C)
+#define GPIO_O_PUR					(0x510)
+#define GPIO_O_DEN					(0x51C)
+#define GPIO_O_AMSEL				(0x528)
+#define GPIO_O_PCTL					(0x52C)
+
+/* System Control and NVIC */
+#define SYSCTL_RCGCGPIO_ADDR	(0x400FE608)
+#define SYSCTL_RCGCI2C_ADDR		(0x400FE620)
+#define SYSCTL_PRGPIO_ADDR		(0x400FEA08)
+#define SYSCTL_PRI2C_ADDR			(0x400FEA20)
+#define NVIC_EN_BASE_ADDR			(0xE000E100)
+#define NVIC_PRI_BASE_ADDR		(0xE000E400)
+
+/* Register Access, every hardware touch in this file goes through these.
+	 The host build (host/Makefile) routes them into the register level emulator */
+#ifdef I2C_HOST_EMU
+#include "I2C_Emu.h"
+#define REG_RD(addr)						I2C_Emu_Read(addr)
+#define REG_WR(addr, val)				I2C_Emu_Write((addr), (val))
+#else
+#define REG_RD(addr)						(*((volatile uint32_t *)(addr)))
+#define REG_WR(addr, val)				(*((volatile uint32_t *)(addr)) = (val))
+#endif
+#define I2C_RD(bus, off)				REG_RD((bus)->base + (off))
+#define I2C_WR(bus, off, val)		REG_WR((bus)->base + (off), (val))
+#define I2C_SET(bus, off, bits)	I2C_WR(bus, off, I2C_RD(bus, off) | (bits))
+#define I2C_CLR(bus, off, bits)	I2C_WR(bus, off, I2C_RD(bus, off) & ~(bits))
+#define GPIO_RD(bus, off)				REG_RD((bus)->gpio_base + (off))
+#define GPIO_WR(bus, off, val)	REG_WR((bus)->gpio_base + (off), (val))
+#define GPIO_SET(bus, off, bits)	GPIO_WR(bus, off, GPIO_RD(bus, off) | (bits))
+#define GPIO_CLR(bus, off, bits)	GPIO_WR(bus, off, GPIO_RD(bus, off) & ~(bits))
+
+/* Transaction Trace, blocking calls are timed from entry (including
+	 the wait for the bus), queued transfers from when they hit the bus */
+#ifdef I2C_TRACE
+#define I2C_TRACE_DECL		uint32_t trace_start = CYCCNT_Read();
+#define I2C_TRACE_RECORD(bus, addr, reg, dir, size, start, error)	\
+	I2C_Trace_Record((bus), (addr), (reg), (dir), (size), (start), (error))
+
+static I2C_TRACE_ENTRY_t I2C_Trace_Ring[I2C_TRACE_DEPTH];
+static volatile uint32_t I2C_Trace_Head;				// Total records ever claimed
+static volatile uint8_t I2C_Trace_Paused;				// Set while dumping
+
+static void I2C_Trace_Record(I2C_BUS_t* bus, uint8_t addr, uint8_t reg, uint8_t dir, uint32_t size, uint32_t start, uint8_t error);
+#else
+#define I2C_TRACE_DECL
+#define I2C_TRACE_RECORD(bus, addr, reg, dir, size, start, error)
+#endif
+
+/* Bus Table */
+#define I2C_BUS_DEF(n, port, port_idx)	{									\
+	.base = I2C##n##_BASE_ADDR,													\
+	.gpio_base = GPIO##port##_BASE_ADDR,								\
+	.module = n,																				\
+	.gpio_port = port_idx,															\
+	.scl_pin = I2C##n##_SCL_PIN,												\
+	.sda_pin = I2C##n##_SDA_PIN,												\
+	.pctl_msk = I2C##n##_ALT_FUNC_MSK,									\
+	.pctl_set = I2C##n##_ALT_FUNC_SET,									\
+	.irq = I2C##n##_IRQ_NUM															\
+}
+
+I2C_BUS_t I2C0_Bus = I2C_BUS_DEF(0, B, 1);
+I2C_BUS_t I2C1_Bus = I2C_BUS_DEF(1, A, 0);
+I2C_BUS_t I2C2_Bus = I2C_BUS_DEF(2, E, 4);
+I2C_BUS_t I2C3_Bus = I2C_BUS_DEF(3, D, 3);
+
+static uint8_t I2C_Receive_Polled(I2C_BUS_t* bus, uint8_t slave_addr, uint8_t slave_reg_addr, uint8_t* data);
+static uint8_t I2C_Transmit_Polled(I2C_BUS_t* bus, uint8_t slave_addr, uint8_t slave_reg_addr, uint8_t data);
+static uint8_t I2C_Burst_Receive_Polled(I2C_BUS_t* bus, uint8_t slave_addr, uint8_t slave_reg_addr, uint8_t* data, uint32_t size);
+static uint8_t I2C_Burst_Transmit_Polled(I2C_BUS_t* bus, uint8_t slave_addr, uint8_t slave_reg_addr, uint8_t* data, uint32_t size);
 
 /*
- *	-------------------I2C0_Init------------------
- *	Basic I2C Initialization function for master mode @ 100kHz
- *	Input: None
+ *	-----------------I2C_Start_Next------------------
+ *	Local function to put the next queued transfer on the bus,
+ *	taken from the highest priority class that has one.
+ *	Must be called with interrupts masked or from the bus interrupt
+ *	Input: Bus Handle
  *	Output: None
  */
-void I2C0_Init(void){
+static void I2C_Start_Next(I2C_BUS_t* bus){
+	I2C_XFER_t* xfer = 0;
+	uint8_t prio;
 	
-	/* Enable Required System Clock */
-	SYSCTL_RCGC1_R |= SYSCTL_RCGC1_I2C0;    // Enable I2C0 System Clock
-	SYSCTL_RCGC2_R |= SYSCTL_RCGC2_GPIOB;   // Enable GPIOB System Clock
+	/* Nothing to do if bus is in use or queue is empty */
+	if(bus->active || bus->polled_owner)
+		return;
+	
+	/* Highest class with work wins, lower classes only run in the gaps */
+	for(prio = 0; (prio < I2C_PRIO_COUNT) && (xfer == 0); prio++)
+		xfer = bus->head[prio];
+	if(xfer == 0){
+		I2C_CLR(bus, I2C_O_MIMR, (I2C_MIMR_IM | I2C_MIMR_CLKIM));	// Quiet the interrupt for blocking calls
+		return;
+	}
+	
+	bus->active = xfer;
+	xfer->status = I2C_XFER_ACTIVE;
+	xfer->index = 0;
+	xfer->phase = XFER_PHASE_REG;
+	xfer->start_cycles = CYCCNT_Read();
+	
+	/* Send slave address and register address, same as blocking functions */
+	I2C_WR(bus, I2C_O_MICR, I2C_MICR_IC | I2C_MICR_CLKIC);	// Clear any stale completion
+	I2C_SET(bus, I2C_O_MIMR, I2C_MIMR_IM | I2C_MIMR_CLKIM);	// Arm completion and clock timeout interrupts
+	I2C_WR(bus, I2C_O_MSA, (xfer->slave_addr << 1));		// Write mode (RS=0)
+	I2C_WR(bus, I2C_O_MDR, xfer->slave_reg_addr);
+	I2C_WR(bus, I2C_O_MCS, (I2C_MCS_RUN | I2C_MCS_START));
+}
+
+/*
+ *	------------------I2C_Complete-------------------
+ *	Local function to retire the active transfer and start the next
+ *	Input: Bus Handle, Active Transfer, Error bits (0 on success)
+ *	Output: None
+ */
+static void I2C_Complete(I2C_BUS_t* bus, I2C_XFER_t* xfer, uint8_t error){
 	
-	// Wait Until GPIOB System Clock is enabled
-	while((SYSCTL_RCGC2_R & SYSCTL_RCGC2_GPIOB) != SYSCTL_RCGC2_GPIOB);
+	/* Unlink from its class queue (always the head) before the callback so it may resubmit */
+	bus->head[xfer->priority] = xfer->next;
+	if(bus->head[xfer->priority] == 0)
+		bus->tail[xfer->priority] = 0;
+	bus->active = 0;
+	xfer->next = 0;
 	
-	/* GPIOB I2C Alternate Function Setup */
-	GPIO_PORTB_AMSEL_R &= ~I2C0_PINS;   // Disable Analog Mode
-	GPIO_PORTB_AFSEL_R |= I2C0_PINS;    // Enable Alternate Function Selection
-	GPIO_PORTB_DEN_R |= I2C0_PINS;      // Enable Digital I/O
+	xfer->error = error;
+	xfer->status = (error != 0) ? I2C_XFER_ERROR : I2C_XFER_DONE;
+	I2C_TRACE_RECORD(bus, xfer->slave_addr, xfer->slave_reg_addr, xfer->dir, xfer->size, xfer->start_cycles, error);
 	
-	// Select I2C0 as the alternate function 
-	GPIO_PORTB_PCTL_R = (GPIO_PORTB_PCTL_R & I2C0_ALT_FUNC_MSK) | I2C0_ALT_FUNC_SET;
+	if(xfer->callback)
+		xfer->callback(xfer);
+	
+	I2C_Start_Next(bus);
+}
+
+/*
+ *	----------------I2C_Compute_TPR------------------
+ *	Local function to derive the MTPR timer period for a target
+ *	SCL frequency: TPR = SysClk / (2 * (SCL_LP + SCL_HP) * SCL) - 1
+ *	Rounded up so the resulting bus is never faster than requested
+ *	Input: Target SCL frequency in Hz
+ *	Output: TPR value to write into MTPR
+ */
+static uint32_t I2C_Compute_TPR(uint32_t scl_hz){
+	uint32_t ticks_per_period = 2 * (I2C_SCL_LP + I2C_SCL_HP) * scl_hz;
+	uint32_t tpr;
+	
+	if(scl_hz == 0)
+		return I2C_MTPR_TPR_M;									// Slowest possible bus
+	
+	tpr = ((SYS_CLOCK_HZ + ticks_per_period - 1) / ticks_per_period) - 1;
+	
+	/* Clamp to what the timer can express */
+	if(tpr < I2C_MTPR_TPR_MIN)
+		tpr = I2C_MTPR_TPR_MIN;
+	if(tpr > I2C_MTPR_TPR_M)
+		tpr = I2C_MTPR_TPR_M;
+	
+	return tpr;
+}
+
+/*
+ *	-----------------I2C_Wait_Done-------------------
+ *	Local function replacing the bare BUSY poll. Bounded by the
+ *	CYCCNT deadline, and reports the hardware clock-low timeout
+ *	Input: Bus Handle
+ *	Output: MCS error bits, I2C_ERR_TIMEOUT on either timeout
+ */
+static uint8_t I2C_Wait_Done(I2C_BUS_t* bus){
+	uint32_t start = CYCCNT_Read();
+	uint32_t mcs;
+	
+	while((mcs = I2C_RD(bus, I2C_O_MCS)) & I2C_MCS_BUSY){
+		if((CYCCNT_Read() - start) > bus->timeout_cycles){
+			bus->needs_recovery = 1;
+			return I2C_ERR_TIMEOUT;
+		}
+	}
+	
+	if(mcs & I2C_MCS_CLKTO){
+		bus->needs_recovery = 1;
+		return I2C_ERR_TIMEOUT;
+	}
+	
+	return mcs & (I2C_MCS_ERROR | I2C_MCS_ARBLST);
+}
+
+/*
+ *	-------------I2C_Update_Clock_Timeout-------------
+ *	Local function to load MCLKOCNT for the current timeout and
+ *	speed. The counter runs on the internal SCL clock and the
+ *	register holds the upper 8 bits of a 12-bit count
+ *	Input: Bus Handle
+ *	Output: None
+ */
+static void I2C_Update_Clock_Timeout(I2C_BUS_t* bus){
+	uint32_t scl_khz = SYS_CLOCK_HZ / (2 * (I2C_SCL_LP + I2C_SCL_HP) * (bus->tpr + 1) * 1000);
+	uint32_t cntl = ((scl_khz * bus->timeout_us) / 1000) >> 4;
+	
+	if(cntl < I2C_MCLKOCNT_MIN)
+		cntl = I2C_MCLKOCNT_MIN;
+	if(cntl > I2C_MCLKOCNT_MAX)
+		cntl = I2C_MCLKOCNT_MAX;
+	
+	I2C_WR(bus, I2C_O_MCLKOCNT, cntl);
+}
+
+/*
+ *	---------------I2C_Master_Config-----------------
+ *	Local function to hand SCL/SDA to the module and (re)start the master
+ *	at the current speed and timeout. Shared by Init and recovery
+ *	Input: Bus Handle
+ *	Output: None
+ */
+static void I2C_Master_Config(I2C_BUS_t* bus){
+	
+	uint32_t pins = bus->scl_pin | bus->sda_pin;
+	
+	/* GPIO I2C Alternate Function Setup */
+	GPIO_CLR(bus, GPIO_O_AMSEL, pins);   // Disable Analog Mode
+	GPIO_SET(bus, GPIO_O_AFSEL, pins);    // Enable Alternate Function Selection
+	GPIO_SET(bus, GPIO_O_DEN, pins);      // Enable Digital I/O
+	
+	// Select I2C as the alternate function 
+	GPIO_WR(bus, GPIO_O_PCTL, (GPIO_RD(bus, GPIO_O_PCTL) & bus->pctl_msk) | bus->pctl_set);
 	
 	// Configure pins for I2C
-	GPIO_PORTB_ODR_R |= I2C0_SDA_PIN;   // Enable Open Drain for SDA pin
-	GPIO_PORTB_PUR_R |= I2C0_PINS;      // Enable pull-up resistors
+	GPIO_SET(bus, GPIO_O_ODR, bus->sda_pin);   // Enable Open Drain for SDA pin
+	GPIO_SET(bus, GPIO_O_PUR, pins);      // Enable pull-up resistors
+	
+	/* I2C Setup as Master Mode */
+	I2C_WR(bus, I2C_O_MCR, 0); // Ensure module is disabled before configuration
+	I2C_WR(bus, I2C_O_MCR, EN_I2C0_MASTER); // Configure as Master
+	
+	/* Configuring I2C Clock Frequency and Clock Low Timeout */
+	I2C_WR(bus, I2C_O_MTPR, bus->tpr);
+	I2C_Update_Clock_Timeout(bus);
+	
+	// Reset and Enable Master
+	I2C_CLR(bus, I2C_O_MCR, I2C_MCR_MFE); // Disable Master Function
+	I2C_SET(bus, I2C_O_MCR, I2C_MCR_MFE);  // Re-enable Master Function
+}
+
+/*
+ *	--------------I2C_Recover_Locked----------------
+ *	Local bus recovery, caller must own the bus (blocking owner or
+ *	inside the bus interrupt). Bit-bangs at Standard-mode timing
+ *	Input: Bus Handle
+ *	Output: 0 if SDA is released, 1 if the bus is still held low
+ */
+static uint8_t I2C_Recover_Locked(I2C_BUS_t* bus){
+	uint32_t half_period = SYS_CLOCK_HZ / (2 * I2C_SPEED_STANDARD);	// 5us
+	uint32_t start;
+	uint8_t i;
+	uint8_t stuck;
+	
+	/* Stop the master and take SCL/SDA as GPIO: SCL output high, SDA released (input) */
+	I2C_CLR(bus, I2C_O_MCR, I2C_MCR_MFE);
+	GPIO_SET(bus, GPIO_O_DATA, bus->scl_pin);
+	GPIO_WR(bus, GPIO_O_DIR, (GPIO_RD(bus, GPIO_O_DIR) | bus->scl_pin) & ~bus->sda_pin);
+	GPIO_CLR(bus, GPIO_O_AFSEL, (bus->scl_pin | bus->sda_pin));
 	
-	/* I2C0 Setup as Master Mode @ 100kBits */
-	I2C0_MCR_R = 0; // Ensure module is disabled before configuration
-	I2C0_MCR_R = EN_I2C0_MASTER; // Configure I2C0 as Master
+	/* Clock out 9 bits so a slave stuck mid-byte finishes and lets go of SDA */
+	for(i = 0; i < I2C_RECOVER_CLOCKS; i++){
+		GPIO_CLR(bus, GPIO_O_DATA, bus->scl_pin);
+		start = CYCCNT_Read(); while((CYCCNT_Read() - start) < half_period);
+		GPIO_SET(bus, GPIO_O_DATA, bus->scl_pin);
+		start = CYCCNT_Read(); while((CYCCNT_Read() - start) < half_period);
+	}
+	
+	/* STOP: SDA low while SCL low, raise SCL, then release SDA */
+	GPIO_CLR(bus, GPIO_O_DATA, (bus->scl_pin | bus->sda_pin));
+	GPIO_SET(bus, GPIO_O_DIR, bus->sda_pin);			// Open drain, drives low
+	start = CYCCNT_Read(); while((CYCCNT_Read() - start) < half_period);
+	GPIO_SET(bus, GPIO_O_DATA, bus->scl_pin);
+	start = CYCCNT_Read(); while((CYCCNT_Read() - start) < half_period);
+	GPIO_CLR(bus, GPIO_O_DIR, bus->sda_pin);		// Released, pull-up raises SDA
+	start = CYCCNT_Read(); while((CYCCNT_Read() - start) < half_period);
+	
+	stuck = (GPIO_RD(bus, GPIO_O_DATA) & bus->sda_pin) ? 0 : 1;
 	
-	/* Configuring I2C Clock Frequency to 100KHz */
-	I2C0_MTPR_R = I2C_MTPR_TPR_VALUE; // TPR = 7 for 100kHz at 16MHz system clock
+	/* Give the pins back to the I2C peripheral */
+	GPIO_CLR(bus, GPIO_O_DIR, (bus->scl_pin | bus->sda_pin));
+	I2C_Master_Config(bus);
+	bus->needs_recovery = 0;
 	
-	// Reset and Enable I2C0 Master
-	I2C0_MCR_R &= ~I2C_MCR_MFE; // Disable Master Function
-	I2C0_MCR_R |= I2C_MCR_MFE;  // Re-enable Master Function
+	return stuck;
+}
 
-	// Optional: Add a small delay after init/reset
-	// for(volatile uint32_t i=0; i<100; i++); // Simple delay loop
+/*
+ *	------------------I2C_Acquire--------------------
+ *	Local function for blocking calls to take the bus at the next
+ *	transaction boundary. Queued transfers are held back, only the
+ *	one already on the bus is allowed to finish
+ *	Input: Bus Handle
+ *	Output: None
+ */
+static void I2C_Acquire(I2C_BUS_t* bus){
+	long sr;
+	
+	/* Stop the engine from starting anything new */
+	sr = StartCritical();
+	bus->polled_owner = 1;
+	EndCritical(sr);
+	
+	/* Let the in flight transfer complete (or time out) */
+	while(bus->active)
+		I2C_Async_Check_Timeout(bus);
 }
 
 /*
- *	-------------------I2C0_Receive------------------
+ *	------------------I2C_Release--------------------
+ *	Local function to hand the bus back to the asynchronous engine
+ *	Input: Bus Handle
+ *	Output: None
+ */
+static void I2C_Release(I2C_BUS_t* bus){
+	long sr;
+	
+	/* A timed out call leaves the bus in an unknown state, fix it while we still own it */
+	if(bus->needs_recovery)
+		I2C_Recover_Locked(bus);
+	
+	sr = StartCritical();
+	bus->polled_owner = 0;
+	I2C_Start_Next(bus);											// Anything queued meanwhile (e.g. from an ISR)
+	EndCritical(sr);
+}
+
+/*
+ *	-------------------I2C_Init-------------------
+ *	Basic I2C Initialization function for master mode @ 100kHz.
+ *	Every bus has its own interrupt, so transfers on different
+ *	buses run concurrently
+ *	Input: Bus Handle
+ *	Output: None
+ */
+void I2C_Init(I2C_BUS_t* bus){
+	uint8_t i;
+	uint32_t pri_addr;
+	uint32_t pri_shift;
+	
+	/* Enable Required System Clock */
+	REG_WR(SYSCTL_RCGCI2C_ADDR, REG_RD(SYSCTL_RCGCI2C_ADDR) | (1UL << bus->module));			// Enable I2Cn System Clock
+	REG_WR(SYSCTL_RCGCGPIO_ADDR, REG_RD(SYSCTL_RCGCGPIO_ADDR) | (1UL << bus->gpio_port));	// Enable GPIO System Clock
+	
+	// Wait Until both peripherals are ready
+	while((REG_RD(SYSCTL_PRGPIO_ADDR) & (1UL << bus->gpio_port)) == 0);
+	while((REG_RD(SYSCTL_PRI2C_ADDR) & (1UL << bus->module)) == 0);
+	
+	/* Cycle counter bounds every wait below */
+	CYCCNT_Init();
+	
+	/* Default 100KHz and per operation timeout */
+	bus->tpr = I2C_Compute_TPR(I2C_SPEED_STANDARD); // TPR = 7 for 100kHz at 16MHz system clock
+	bus->timeout_us = I2C_DEFAULT_TIMEOUT_US;
+	bus->timeout_cycles = (SYS_CLOCK_HZ / 1000000) * bus->timeout_us;
+	bus->needs_recovery = 0;
+	
+	/* Pins and Master Mode @ 100kBits */
+	I2C_Master_Config(bus);
+	
+	/* Asynchronous Engine Setup (interrupt is only armed while queue is busy) */
+	for(i = 0; i < I2C_PRIO_COUNT; i++)
+		bus->head[i] = bus->tail[i] = 0;
+	bus->active = 0;
+	bus->polled_owner = 0;
+	I2C_WR(bus, I2C_O_MIMR, 0);
+	I2C_WR(bus, I2C_O_MICR, I2C_MICR_IC | I2C_MICR_CLKIC);
+	
+	/* Four priority fields per PRIn register (top 3 bits used), 32 enables per ENn */
+	pri_addr = NVIC_PRI_BASE_ADDR + ((bus->irq >> 2) << 2);
+	pri_shift = ((bus->irq & 0x3) << 3) + 5;
+	REG_WR(pri_addr, (REG_RD(pri_addr) & ~(0x7UL << pri_shift)) | (I2C_IRQ_PRIORITY << pri_shift));
+	REG_WR(NVIC_EN_BASE_ADDR + ((bus->irq >> 5) << 2), 1UL << (bus->irq & 0x1F));	// Write 1 to enable
+}
+
+/*
+ *	-----------------I2C_Set_Speed-------------------
+ *	Change the SCL frequency, TPR is derived from SYS_CLOCK_HZ and
+ *	rounded so the bus never runs faster than requested. Waits for
+ *	any queued transfers to finish before switching.
+ *	Input: Bus Handle, Target SCL frequency in Hz (normally an I2C_SPEED value)
+ *	Output: Actual SCL frequency in Hz
+ */
+uint32_t I2C_Set_Speed(I2C_BUS_t* bus, uint32_t scl_hz){
+	
+	/* Only switch between transactions */
+	I2C_Acquire(bus);
+	I2C_Wait_Done(bus);
+	bus->tpr = I2C_Compute_TPR(scl_hz);
+	I2C_WR(bus, I2C_O_MTPR, bus->tpr);
+	I2C_Update_Clock_Timeout(bus);				// Clock-low count is in SCL periods
+	I2C_Release(bus);
+	
+	return I2C_Get_Speed(bus);
+}
+
+/*
+ *	-----------------I2C_Get_Speed-------------------
+ *	Read back the SCL frequency the bus is currently running at
+ *	Input: Bus Handle
+ *	Output: Actual SCL frequency in Hz
+ */
+uint32_t I2C_Get_Speed(I2C_BUS_t* bus){
+	uint32_t tpr = I2C_RD(bus, I2C_O_MTPR) & I2C_MTPR_TPR_M;
+	
+	return SYS_CLOCK_HZ / (2 * (I2C_SCL_LP + I2C_SCL_HP) * (tpr + 1));
+}
+
+/*
+ *	----------------I2C_Set_Timeout------------------
+ *	Bound every bus operation. Sets both the hardware clock-low
+ *	timeout (MCLKOCNT) and the software CYCCNT deadline used by
+ *	the blocking functions. A timed out call returns I2C_ERR_TIMEOUT
+ *	and the bus is recovered before the next transaction.
+ *	Input: Bus Handle, Timeout per bus operation in microseconds
+ *	Output: None
+ */
+void I2C_Set_Timeout(I2C_BUS_t* bus, uint32_t timeout_us){
+	I2C_Acquire(bus);
+	bus->timeout_us = timeout_us;
+	bus->timeout_cycles = (SYS_CLOCK_HZ / 1000000) * timeout_us;
+	I2C_Update_Clock_Timeout(bus);
+	I2C_Release(bus);
+}
+
+/*
+ *	----------------I2C_Bus_Recover------------------
+ *	Free a bus held by a stuck slave: switch SCL/SDA to GPIO, clock
+ *	out 9 SCL pulses, generate a STOP, then re-initialize the module
+ *	at the current speed
+ *	Input: Bus Handle
+ *	Output: 0 if SDA is released, 1 if the bus is still held low
+ */
+uint8_t I2C_Bus_Recover(I2C_BUS_t* bus){
+	uint8_t ret;
+	
+	I2C_Acquire(bus);
+	ret = I2C_Recover_Locked(bus);
+	I2C_Release(bus);
+	
+	return ret;
+}
+
+/*
+ *	-------------------I2C_Receive-------------------
  *	Polls to receive data from specified peripheral
- *	Input: Slave address & Slave Register Address
+ *	Input: Bus Handle, Slave address & Slave Register Address
  *	Output: Returns 8-bit data that has been received
  */
-uint8_t I2C0_Receive(uint8_t slave_addr, uint8_t slave_reg_addr){
-	char error;
+uint8_t I2C_Receive(I2C_BUS_t* bus, uint8_t slave_addr, uint8_t slave_reg_addr){
+	uint8_t ret;
+	uint8_t data = 0;
+	I2C_TRACE_DECL
 	
-	/* Check if I2C0 is busy */
-	while(I2C0_MCS_R & I2C_MCS_BUSY);
+	I2C_Acquire(bus);
+	ret = I2C_Receive_Polled(bus, slave_addr, slave_reg_addr, &data);
+	I2C_TRACE_RECORD(bus, slave_addr, slave_reg_addr, I2C_XFER_READ, 1, trace_start, ret);
+	I2C_Release(bus);
 	
-	/* Configure I2C0 Slave Address and Read Mode */
-	I2C0_MSA_R = (slave_addr << 1);     // Slave Address is the 7 MSB (Write mode)
-	I2C0_MSA_R &= ~I2C_MSA_RS;          // Ensure write mode (RS=0)
-	I2C0_MDR_R = slave_reg_addr;        // Set Data Register to slave register address
+	return (ret != 0) ? 0xFF : data;
+}
+
+/* Polled implementation of I2C_Receive, returns error bits */
+static uint8_t I2C_Receive_Polled(I2C_BUS_t* bus, uint8_t slave_addr, uint8_t slave_reg_addr, uint8_t* data){
+	uint8_t error;
 	
-	/* Initiate I2C by generating a START & RUN cmd (NO STOP) */
-	I2C0_MCS_R = (I2C_MCS_RUN | I2C_MCS_START); // = 0x03
+	/* Check if the bus is busy, give up if it never frees */
+	if(I2C_Wait_Done(bus) & I2C_ERR_TIMEOUT)
+		return I2C_ERR_TIMEOUT;
 	
-	/* Wait until write is done and bus is idle */
-	while(I2C0_MCS_R & I2C_MCS_BUSY);
+	/* Configure Slave Address and Read Mode */
+	I2C_WR(bus, I2C_O_MSA, (slave_addr << 1));     // Slave Address is the 7 MSB (Write mode)
+	I2C_CLR(bus, I2C_O_MSA, I2C_MSA_RS);          // Ensure write mode (RS=0)
+	I2C_WR(bus, I2C_O_MDR, slave_reg_addr);        // Set Data Register to slave register address
+	
+	/* Initiate I2C by generating a START & RUN cmd (NO STOP) */
+	I2C_WR(bus, I2C_O_MCS, (I2C_MCS_RUN | I2C_MCS_START)); // = 0x03
 	
-	/* Check for errors after first transaction (ACK check) */
-	error = I2C0_MCS_R & (I2C_MCS_ERROR | I2C_MCS_ARBLST);
+	/* Wait until write is done and bus is idle, then check for errors after first transaction (ACK check) */
+	error = I2C_Wait_Done(bus);
 	if(error != 0) {
-		I2C0_MCS_R = I2C_MCS_STOP;  // Generate STOP condition
+		I2C_WR(bus, I2C_O_MCS, I2C_MCS_STOP);  // Generate STOP condition
 		// Wait for STOP to finish
-		while(I2C0_MCS_R & I2C_MCS_BUSY);
-		return 0xFF;  // Return error code
+		I2C_Wait_Done(bus);
+		return error;  // Return error code
 	}
 	
 	/* Set I2C to Receive with Slave Address and change to Read */
-	I2C0_MSA_R = (slave_addr << 1) | I2C_MSA_RS;  // Set read bit (RS=1)
+	I2C_WR(bus, I2C_O_MSA, (slave_addr << 1) | I2C_MSA_RS);  // Set read bit (RS=1)
 	
 	/* Initiate single byte read with repeated START, RUN, STOP */
-	I2C0_MCS_R = (I2C_MCS_RUN | I2C_MCS_START | I2C_MCS_STOP); // = 0x07
+	I2C_WR(bus, I2C_O_MCS, (I2C_MCS_RUN | I2C_MCS_START | I2C_MCS_STOP)); // = 0x07
 	
-	/* Wait until read is done and bus is idle */
-	while(I2C0_MCS_R & I2C_MCS_BUSY);
-	
-	/* Check for any error */
-	error = I2C0_MCS_R & (I2C_MCS_ERROR | I2C_MCS_ARBLST);
+	/* Wait until read is done and bus is idle, then check for any error */
+	error = I2C_Wait_Done(bus);
 	if(error != 0) {
 		// STOP was already sent, just return error
-		return 0xFF;  // Return error code
+		return error;  // Return error code
 	}
-	else
-		return I2C0_MDR_R & 0xFF;  // return I2C data register least significant 8 bits.
+	
+	*data = I2C_RD(bus, I2C_O_MDR) & 0xFF;  // I2C data register least significant 8 bits.
+	return 0;
 }
 
 /*
- *	-------------------I2C0_Transmit------------------
+ *	-------------------I2C_Transmit-------------------
  *	Transmit a byte of data to specified peripheral
- *	Input: Slave address, Slave Register Address, Data to Transmit
+ *	Input: Bus Handle, Slave address, Slave Register Address, Data to Transmit
  *	Output: Any Errors if detected, otherwise 0
  */
-uint8_t I2C0_Transmit(uint8_t slave_addr, uint8_t slave_reg_addr, uint8_t data){
-	char error;  // Temp Variable to hold errors
+uint8_t I2C_Transmit(I2C_BUS_t* bus, uint8_t slave_addr, uint8_t slave_reg_addr, uint8_t data){
+	uint8_t ret;
+	I2C_TRACE_DECL
 	
-	/* Check if I2C0 is busy */
-	while(I2C0_MCS_R & I2C_MCS_BUSY);
+	I2C_Acquire(bus);
+	ret = I2C_Transmit_Polled(bus, slave_addr, slave_reg_addr, data);
+	I2C_TRACE_RECORD(bus, slave_addr, slave_reg_addr, I2C_XFER_WRITE, 1, trace_start, ret);
+	I2C_Release(bus);
+	
+	return ret;
+}
+
+/* Polled implementation of I2C_Transmit */
+static uint8_t I2C_Transmit_Polled(I2C_BUS_t* bus, uint8_t slave_addr, uint8_t slave_reg_addr, uint8_t data){
+	uint8_t error;  // Temp Variable to hold errors
+	
+	/* Check if the bus is busy, give up if it never frees */
+	if(I2C_Wait_Done(bus) & I2C_ERR_TIMEOUT)
+		return I2C_ERR_TIMEOUT;
 	
 	/* Configure I2C Slave Address, R/W Mode, and what to transmit */
-	I2C0_MSA_R = (slave_addr << 1);  // Slave Address is the first 7 MSB
-	I2C0_MSA_R &= ~I2C_MSA_RS;      // Ensure write mode (RS=0)
-	I2C0_MDR_R = slave_reg_addr;      // Transmit register addr to interact
+	I2C_WR(bus, I2C_O_MSA, (slave_addr << 1));  // Slave Address is the first 7 MSB
+	I2C_CLR(bus, I2C_O_MSA, I2C_MSA_RS);      // Ensure write mode (RS=0)
+	I2C_WR(bus, I2C_O_MDR, slave_reg_addr);      // Transmit register addr to interact
 	
 	/* Initiate I2C by generate a START bit and RUN cmd (NO STOP) */
-	I2C0_MCS_R = (I2C_MCS_RUN | I2C_MCS_START); // = 0x03
+	I2C_WR(bus, I2C_O_MCS, (I2C_MCS_RUN | I2C_MCS_START)); // = 0x03
 	
-	/* Wait until write has been completed and bus is idle */
-	while(I2C0_MCS_R & I2C_MCS_BUSY);
-	
-	/* Check for errors after sending register address */
-	error = I2C0_MCS_R & (I2C_MCS_ERROR | I2C_MCS_ARBLST);
+	/* Wait until write has been completed and bus is idle, then check for errors after sending register address */
+	error = I2C_Wait_Done(bus);
 	if (error != 0) {
-		I2C0_MCS_R = I2C_MCS_STOP; // Generate STOP
-		while(I2C0_MCS_R & I2C_MCS_BUSY); // Wait for STOP
+		I2C_WR(bus, I2C_O_MCS, I2C_MCS_STOP); // Generate STOP
+		I2C_Wait_Done(bus); // Wait for STOP
 		return error; // Return error code
 	}
 	
 	/* Update Data Register with data to be transmitted */
-	I2C0_MDR_R = data;
+	I2C_WR(bus, I2C_O_MDR, data);
 	
 	/* Initiate I2C by generating a STOP & RUN cmd */
-	I2C0_MCS_R = (I2C_MCS_RUN | I2C_MCS_STOP); // = 0x05
-	
-	/* Wait until write has been completed and bus is idle */
-	while(I2C0_MCS_R & I2C_MCS_BUSY);
+	I2C_WR(bus, I2C_O_MCS, (I2C_MCS_RUN | I2C_MCS_STOP)); // = 0x05
 	
-	/* Check for any error after sending data*/
-	error = I2C0_MCS_R & (I2C_MCS_ERROR | I2C_MCS_ARBLST);
+	/* Wait until write has been completed and bus is idle, then check for any error after sending data */
+	error = I2C_Wait_Done(bus);
 	if(error != 0)
 		return error; // STOP was already sent
 	else
@@ -153,152 +599,667 @@ uint8_t I2C0_Transmit(uint8_t slave_addr, uint8_t slave_reg_addr, uint8_t data){
 }
 
 /*
- *	----------------I2C0_Burst_Receive-----------------
+ *	----------------I2C_Burst_Receive------------------
  *	Polls to receive multiple bytes of data from specified
  *  peripheral by incrementing starting slave register address
- *	Input: Slave address, Slave Register Address, Data Buffer
- *	Output: None
+ *	Input: Bus Handle, Slave address, Slave Register Address, Data Buffer, Size of Receive
+ *	Output: Any Errors if detected, otherwise 0
  */
-void I2C0_Burst_Receive(uint8_t slave_addr, uint8_t slave_reg_addr, uint8_t* data, uint32_t size){
-	char error;
+uint8_t I2C_Burst_Receive(I2C_BUS_t* bus, uint8_t slave_addr, uint8_t slave_reg_addr, uint8_t* data, uint32_t size){
+	uint8_t ret;
+	I2C_TRACE_DECL
 	
-	if (size <= 0) return; // No bytes to receive
+	I2C_Acquire(bus);
+	ret = I2C_Burst_Receive_Polled(bus, slave_addr, slave_reg_addr, data, size);
+	I2C_TRACE_RECORD(bus, slave_addr, slave_reg_addr, I2C_XFER_READ, size, trace_start, ret);
+	I2C_Release(bus);
 	
-	/* Check if I2C0 is busy */
-	while(I2C0_MCS_R & I2C_MCS_BUSY);
+	return ret;
+}
+
+/* Polled implementation of I2C_Burst_Receive */
+static uint8_t I2C_Burst_Receive_Polled(I2C_BUS_t* bus, uint8_t slave_addr, uint8_t slave_reg_addr, uint8_t* data, uint32_t size){
+	uint8_t error;
 	
-	/* Configure I2C0 Slave Address and Read Mode */
-	I2C0_MSA_R = (slave_addr << 1);  // Slave Address is the 7 MSB (Write mode)
-	I2C0_MSA_R &= ~I2C_MSA_RS;       // Ensure write mode
-	I2C0_MDR_R = slave_reg_addr;     // Set Data Register to slave register address
+	if (size <= 0) return 0; // No bytes to receive
 	
-	/* Initiate I2C by generating a START & RUN cmd (NO STOP) */
-	I2C0_MCS_R = (I2C_MCS_RUN | I2C_MCS_START); // = 0x03
+	/* Check if the bus is busy, give up if it never frees */
+	if(I2C_Wait_Done(bus) & I2C_ERR_TIMEOUT)
+		return I2C_ERR_TIMEOUT;
 	
-	/* Wait until write is done and bus is idle */
-	while(I2C0_MCS_R & I2C_MCS_BUSY);
+	/* Configure Slave Address and Read Mode */
+	I2C_WR(bus, I2C_O_MSA, (slave_addr << 1));  // Slave Address is the 7 MSB (Write mode)
+	I2C_CLR(bus, I2C_O_MSA, I2C_MSA_RS);       // Ensure write mode
+	I2C_WR(bus, I2C_O_MDR, slave_reg_addr);     // Set Data Register to slave register address
 	
-	/* Check for errors after sending register address */
-	error = I2C0_MCS_R & (I2C_MCS_ERROR | I2C_MCS_ARBLST);
+	/* Initiate I2C by generating a START & RUN cmd (NO STOP) */
+	I2C_WR(bus, I2C_O_MCS, (I2C_MCS_RUN | I2C_MCS_START)); // = 0x03
+	
+	/* Wait until write is done and bus is idle, then check for errors after sending register address */
+	error = I2C_Wait_Done(bus);
 	if(error != 0) {
-		I2C0_MCS_R = I2C_MCS_STOP;  // Generate STOP condition
-		while(I2C0_MCS_R & I2C_MCS_BUSY);
-		return; // Exit on error
+		I2C_WR(bus, I2C_O_MCS, I2C_MCS_STOP);  // Generate STOP condition
+		I2C_Wait_Done(bus);
+		return error; // Exit on error
 	}
 	
 	/* Set I2C to Receive with Slave Address and change to Read */
-	I2C0_MSA_R = (slave_addr << 1) | I2C_MSA_RS;  // Set read bit
+	I2C_WR(bus, I2C_O_MSA, (slave_addr << 1) | I2C_MSA_RS);  // Set read bit
 	
 	/* Check number of bytes to receive */
 	if (size == 1) {
 		// Single byte receive: START, RUN, STOP
-		I2C0_MCS_R = (I2C_MCS_RUN | I2C_MCS_START | I2C_MCS_STOP); // = 0x07
-		while(I2C0_MCS_R & I2C_MCS_BUSY); // Wait for completion
-		error = I2C0_MCS_R & (I2C_MCS_ERROR | I2C_MCS_ARBLST);
+		I2C_WR(bus, I2C_O_MCS, (I2C_MCS_RUN | I2C_MCS_START | I2C_MCS_STOP)); // = 0x07
+		error = I2C_Wait_Done(bus);
 		if (error == 0) {
-			*data = I2C0_MDR_R & 0xFF; // Store received data
+			*data = I2C_RD(bus, I2C_O_MDR) & 0xFF; // Store received data
 		}
-		// Error handling (optional): could set data to 0xFF or similar
-		return;
+		return error; // STOP was already sent
 	} else {
 		// Multiple bytes receive
 		// First byte: START, RUN, ACK
-		I2C0_MCS_R = (I2C_MCS_RUN | I2C_MCS_START | I2C_MCS_ACK); // = 0x0B
-		while(I2C0_MCS_R & I2C_MCS_BUSY);
-		error = I2C0_MCS_R & (I2C_MCS_ERROR | I2C_MCS_ARBLST);
+		I2C_WR(bus, I2C_O_MCS, (I2C_MCS_RUN | I2C_MCS_START | I2C_MCS_ACK)); // = 0x0B
+		error = I2C_Wait_Done(bus);
 		if (error != 0) {
-				I2C0_MCS_R = I2C_MCS_STOP; // Generate STOP
-				while(I2C0_MCS_R & I2C_MCS_BUSY);
-				return; // Exit on error
+				I2C_WR(bus, I2C_O_MCS, I2C_MCS_STOP); // Generate STOP
+				I2C_Wait_Done(bus);
+				return error; // Exit on error
 		}
-		*data++ = I2C0_MDR_R & 0xFF; // Store first byte
+		*data++ = I2C_RD(bus, I2C_O_MDR) & 0xFF; // Store first byte
 		size--;
 		
 		// Middle bytes: RUN, ACK
 		while(size > 1){
-			I2C0_MCS_R = (I2C_MCS_RUN | I2C_MCS_ACK); // = 0x09
-			while(I2C0_MCS_R & I2C_MCS_BUSY);
-			error = I2C0_MCS_R & (I2C_MCS_ERROR | I2C_MCS_ARBLST);
+			I2C_WR(bus, I2C_O_MCS, (I2C_MCS_RUN | I2C_MCS_ACK)); // = 0x09
+			error = I2C_Wait_Done(bus);
 			if (error != 0) {
-					I2C0_MCS_R = I2C_MCS_STOP; // Generate STOP
-					while(I2C0_MCS_R & I2C_MCS_BUSY);
-					return; // Exit on error
+					I2C_WR(bus, I2C_O_MCS, I2C_MCS_STOP); // Generate STOP
+					I2C_Wait_Done(bus);
+					return error; // Exit on error
 			}
-			*data++ = I2C0_MDR_R & 0xFF;
+			*data++ = I2C_RD(bus, I2C_O_MDR) & 0xFF;
 			size--;
 		}
 		
 		// Last byte: RUN, STOP (Master sends NACK implicitly with STOP)
-		I2C0_MCS_R = (I2C_MCS_RUN | I2C_MCS_STOP); // = 0x05
-		while(I2C0_MCS_R & I2C_MCS_BUSY);
-		error = I2C0_MCS_R & (I2C_MCS_ERROR | I2C_MCS_ARBLST);
-		// Don't check error strictly here as NACK from slave is possible but maybe expected
-		// But check ARBLST etc. If needed.
-		*data = I2C0_MDR_R & 0xFF; // Store last byte regardless of final NACK
+		I2C_WR(bus, I2C_O_MCS, (I2C_MCS_RUN | I2C_MCS_STOP)); // = 0x05
+		error = I2C_Wait_Done(bus);
+		// Master NACK on the last byte does not raise ERROR, so anything here is real
+		*data = I2C_RD(bus, I2C_O_MDR) & 0xFF; // Store last byte regardless of final NACK
+		return error; // STOP was already sent
 	}
 }
 
 /*
- *	----------------I2C0_Burst_Transmit-----------------
+ *	----------------I2C_Burst_Transmit------------------
  *	Transmit multiple bytes of data to specified peripheral
  *  by incrementing starting slave address
- *	Input: Slave address, Slave Register Address, Data Buffer to transmit
+ *	Input: Bus Handle, Slave address, Slave Register Address, Data Buffer to transmit
  *	Output: None
  */
-uint8_t I2C0_Burst_Transmit(uint8_t slave_addr, uint8_t slave_reg_addr, uint8_t* data, uint32_t size){
-	char error;  // Temp Error Variable
+uint8_t I2C_Burst_Transmit(I2C_BUS_t* bus, uint8_t slave_addr, uint8_t slave_reg_addr, uint8_t* data, uint32_t size){
+	uint8_t ret;
+	I2C_TRACE_DECL
+	
+	I2C_Acquire(bus);
+	ret = I2C_Burst_Transmit_Polled(bus, slave_addr, slave_reg_addr, data, size);
+	I2C_TRACE_RECORD(bus, slave_addr, slave_reg_addr, I2C_XFER_WRITE, size, trace_start, ret);
+	I2C_Release(bus);
+	
+	return ret;
+}
+
+/* Polled implementation of I2C_Burst_Transmit */
+static uint8_t I2C_Burst_Transmit_Polled(I2C_BUS_t* bus, uint8_t slave_addr, uint8_t slave_reg_addr, uint8_t* data, uint32_t size){
+	uint8_t error;  // Temp Error Variable
 	
 	/* Asserting Param */
 	if(size <= 0)
 		return 0; // No data to send
 	
-	/* Check if I2C0 is busy */
-	while(I2C0_MCS_R & I2C_MCS_BUSY);
+	/* Check if the bus is busy, give up if it never frees */
+	if(I2C_Wait_Done(bus) & I2C_ERR_TIMEOUT)
+		return I2C_ERR_TIMEOUT;
 	
 	/* Configure I2C Slave Address, R/W Mode, and what to transmit */
-	I2C0_MSA_R = (slave_addr << 1);  // Slave Address is the first 7 MSB
-	I2C0_MSA_R &= ~I2C_MSA_RS;      // Ensure write mode (RS=0)
-	I2C0_MDR_R = slave_reg_addr;      // Transmit register addr to interact
+	I2C_WR(bus, I2C_O_MSA, (slave_addr << 1));  // Slave Address is the first 7 MSB
+	I2C_CLR(bus, I2C_O_MSA, I2C_MSA_RS);      // Ensure write mode (RS=0)
+	I2C_WR(bus, I2C_O_MDR, slave_reg_addr);      // Transmit register addr to interact
 	
 	/* Initiate I2C by generate a START bit and RUN cmd (NO STOP) */
-	I2C0_MCS_R = (I2C_MCS_RUN | I2C_MCS_START); // = 0x03
+	I2C_WR(bus, I2C_O_MCS, (I2C_MCS_RUN | I2C_MCS_START)); // = 0x03
 	
-	/* Wait until write has been completed and bus is idle */
-	while(I2C0_MCS_R & I2C_MCS_BUSY);
-	
-	/* Check for errors after sending register address */
-	error = I2C0_MCS_R & (I2C_MCS_ERROR | I2C_MCS_ARBLST);
+	/* Wait until write has been completed and bus is idle, then check for errors after sending register address */
+	error = I2C_Wait_Done(bus);
 	if (error != 0) {
-		I2C0_MCS_R = I2C_MCS_STOP; // Generate STOP
-		while(I2C0_MCS_R & I2C_MCS_BUSY); // Wait for STOP
+		I2C_WR(bus, I2C_O_MCS, I2C_MCS_STOP); // Generate STOP
+		I2C_Wait_Done(bus); // Wait for STOP
 		return error; // Return error code
 	}
 	
 	/* Loop to Burst Transmit what is stored in data buffer */
 	while(size > 1){
-		I2C0_MDR_R = *data++;  // Load data and increment pointer
-		I2C0_MCS_R = I2C_MCS_RUN;     // RUN (Continue transaction) = 0x01
-		while(I2C0_MCS_R & I2C_MCS_BUSY);  // Wait until transmit is complete
-		error = I2C0_MCS_R & (I2C_MCS_ERROR | I2C_MCS_ARBLST);
+		I2C_WR(bus, I2C_O_MDR, *data++);  // Load data and increment pointer
+		I2C_WR(bus, I2C_O_MCS, I2C_MCS_RUN);     // RUN (Continue transaction) = 0x01
+		error = I2C_Wait_Done(bus);
 		if (error != 0) {
-			I2C0_MCS_R = I2C_MCS_STOP; // Generate STOP
-			while(I2C0_MCS_R & I2C_MCS_BUSY); // Wait for STOP
+			I2C_WR(bus, I2C_O_MCS, I2C_MCS_STOP); // Generate STOP
+			I2C_Wait_Done(bus); // Wait for STOP
 			return error; // Return error code
 		}
 		size--;
 	}
 	
 	/* Last byte with STOP condition */
-	I2C0_MDR_R = *data;  // Load last data byte
-	I2C0_MCS_R = (I2C_MCS_RUN | I2C_MCS_STOP);   // STOP + RUN = 0x05
-	
-	/* Wait until write has been completed and bus is idle */
-	while(I2C0_MCS_R & I2C_MCS_BUSY);
+	I2C_WR(bus, I2C_O_MDR, *data);  // Load last data byte
+	I2C_WR(bus, I2C_O_MCS, (I2C_MCS_RUN | I2C_MCS_STOP));   // STOP + RUN = 0x05
 	
-	/* Check for any error after sending last byte */
-	error = I2C0_MCS_R & (I2C_MCS_ERROR | I2C_MCS_ARBLST);
+	/* Wait until write has been completed and bus is idle, then check for any error after sending last byte */
+	error = I2C_Wait_Done(bus);
 	if(error != 0)
 		return error; // STOP was already sent
 	else
 		return 0; // Success
 }
+
+
+/*
+ *	---------------I2C_Shadow_Write------------------
+ *	Transmit a register through the device's shadow cache, the
+ *	cached value is only updated if the slave ACKs the write
+ *	Input: Shadow Cache, Register Address, Data to Transmit
+ *	Output: Any Errors if detected, otherwise 0
+ */
+uint8_t I2C_Shadow_Write(I2C_SHADOW_t* shadow, uint8_t reg, uint8_t data){
+	return I2C_Shadow_Burst_Write(shadow, reg, &data, 1);
+}
+
+/*
+ *	------------I2C_Shadow_Burst_Write---------------
+ *	Burst transmit consecutive registers through the shadow cache
+ *	Input: Shadow Cache, Starting Register Address, Data Buffer, Size
+ *	Output: Any Errors if detected, otherwise 0
+ */
+uint8_t I2C_Shadow_Burst_Write(I2C_SHADOW_t* shadow, uint8_t reg, uint8_t* data, uint32_t size){
+	uint8_t ret;
+	uint32_t i;
+	uint8_t idx;
+	
+	ret = I2C_Burst_Transmit(shadow->bus, shadow->slave_addr, shadow->cmd | reg, data, size);
+	if(ret != 0)
+		return ret;
+	
+	/* Mirror every register in the window that was written */
+	for(i = 0; i < size; i++){
+		idx = (uint8_t)(reg + i - shadow->base_reg);
+		if(((reg + i) < shadow->base_reg) || (idx >= shadow->size))
+			continue;
+		shadow->value[idx] = data[i];
+		shadow->valid[idx >> 5] |= (1UL << (idx & 0x1F));
+	}
+	
+	return 0;
+}
+
+/*
+ *	----------------I2C_Shadow_Read------------------
+ *	Return a configuration register from the cache, only touching
+ *	the bus the first time (or after invalidation). Never use for
+ *	registers the device changes on its own (data, status)
+ *	Input: Shadow Cache, Register Address
+ *	Output: Register value (0xFF on bus error, not cached)
+ */
+uint8_t I2C_Shadow_Read(I2C_SHADOW_t* shadow, uint8_t reg){
+	uint8_t idx = (uint8_t)(reg - shadow->base_reg);
+	uint8_t data;
+	
+	/* Outside the window, plain read */
+	if((reg < shadow->base_reg) || (idx >= shadow->size))
+		return I2C_Receive(shadow->bus, shadow->slave_addr, shadow->cmd | reg);
+	
+	if(shadow->valid[idx >> 5] & (1UL << (idx & 0x1F)))
+		return shadow->value[idx];
+	
+	/* First access, fill from device */
+	if(I2C_Burst_Receive(shadow->bus, shadow->slave_addr, shadow->cmd | reg, &data, 1) != 0)
+		return 0xFF;
+	
+	shadow->value[idx] = data;
+	shadow->valid[idx >> 5] |= (1UL << (idx & 0x1F));
+	
+	return data;
+}
+
+/*
+ *	-------------I2C_Shadow_Invalidate---------------
+ *	Forget every cached value, e.g. after a device reset
+ *	Input: Shadow Cache
+ *	Output: None
+ */
+void I2C_Shadow_Invalidate(I2C_SHADOW_t* shadow){
+	uint32_t i;
+	
+	for(i = 0; i < I2C_SHADOW_VALID_WORDS(shadow->size); i++)
+		shadow->valid[i] = 0;
+}
+
+/*
+ *	-------------------I2C_Submit---------------------
+ *	Queue a transaction descriptor on the bus's interrupt driven
+ *	engine in its priority class. Returns immediately, the transfer
+ *	runs from the bus interrupt handler. Blocking functions above
+ *	act as real-time: they take the bus at the next transaction
+ *	boundary, ahead of anything still queued.
+ *	Input: Bus Handle, Filled in Transaction Descriptor
+ *	Output: 0 if queued, 1 if the descriptor is already in flight
+ */
+uint8_t I2C_Submit(I2C_BUS_t* bus, I2C_XFER_t* xfer){
+	long sr;
+	
+	sr = StartCritical();
+	
+	/* Reject descriptors that are still owned by the engine */
+	if((xfer->status == I2C_XFER_PENDING) || (xfer->status == I2C_XFER_ACTIVE)){
+		EndCritical(sr);
+		return 1;
+	}
+	
+	if(xfer->priority >= I2C_PRIO_COUNT)
+		xfer->priority = I2C_PRIO_BULK;
+	
+	xfer->status = I2C_XFER_PENDING;
+	xfer->error = 0;
+	xfer->bus = bus;
+	xfer->next = 0;
+	
+	/* Append to end of its class queue, FIFO within a class */
+	if(bus->tail[xfer->priority])
+		bus->tail[xfer->priority]->next = xfer;
+	else
+		bus->head[xfer->priority] = xfer;
+	bus->tail[xfer->priority] = xfer;
+	
+	I2C_Start_Next(bus);
+	EndCritical(sr);
+	
+	return 0;
+}
+
+/*
+ *	---------------I2C_Async_Receive------------------
+ *	Fill in a descriptor for a burst read and submit it
+ *	Input: Bus Handle, Descriptor, Slave address, Slave Register Address,
+ *				 Data Buffer, Size, Completion Callback (NULL to poll)
+ *	Output: 0 if queued, 1 if the descriptor is already in flight
+ */
+uint8_t I2C_Async_Receive(I2C_BUS_t* bus, I2C_XFER_t* xfer, uint8_t slave_addr, uint8_t slave_reg_addr, uint8_t* data, uint32_t size, I2C_XFER_CALLBACK callback){
+	
+	/* Asserting Param */
+	if(size == 0)
+		return 1;
+	
+	xfer->slave_addr = slave_addr;
+	xfer->slave_reg_addr = slave_reg_addr;
+	xfer->dir = I2C_XFER_READ;
+	xfer->data = data;
+	xfer->size = size;
+	xfer->callback = callback;
+	
+	return I2C_Submit(bus, xfer);
+}
+
+/*
+ *	---------------I2C_Async_Transmit-----------------
+ *	Fill in a descriptor for a burst write and submit it
+ *	Input: Bus Handle, Descriptor, Slave address, Slave Register Address,
+ *				 Data Buffer, Size, Completion Callback (NULL to poll)
+ *	Output: 0 if queued, 1 if the descriptor is already in flight
+ */
+uint8_t I2C_Async_Transmit(I2C_BUS_t* bus, I2C_XFER_t* xfer, uint8_t slave_addr, uint8_t slave_reg_addr, uint8_t* data, uint32_t size, I2C_XFER_CALLBACK callback){
+	xfer->slave_addr = slave_addr;
+	xfer->slave_reg_addr = slave_reg_addr;
+	xfer->dir = I2C_XFER_WRITE;
+	xfer->data = data;
+	xfer->size = size;
+	xfer->callback = callback;
+	
+	return I2C_Submit(bus, xfer);
+}
+
+/*
+ *	-----------------I2C_Async_Busy-------------------
+ *	Check if the bus still has queued or active transactions in any class
+ *	Input: Bus Handle
+ *	Output: 1 if busy, 0 if idle
+ */
+uint8_t I2C_Async_Busy(I2C_BUS_t* bus){
+	uint8_t prio;
+	
+	for(prio = 0; prio < I2C_PRIO_COUNT; prio++){
+		if(bus->head[prio] != 0)
+			return 1;
+	}
+	
+	return 0;
+}
+
+/*
+ *	-------------I2C_Async_Check_Timeout--------------
+ *	Abort the active transfer if it has overrun its deadline of
+ *	(size + 2) bus operations. Call periodically when polling status.
+ *	Input: Bus Handle
+ *	Output: 1 if a transfer was aborted, otherwise 0
+ */
+uint8_t I2C_Async_Check_Timeout(I2C_BUS_t* bus){
+	I2C_XFER_t* xfer;
+	long sr;
+	
+	sr = StartCritical();
+	xfer = bus->active;
+	if((xfer == 0) || ((CYCCNT_Read() - xfer->start_cycles) <= (xfer->size + 2) * bus->timeout_cycles)){
+		EndCritical(sr);
+		return 0;
+	}
+	
+	/* Engine stalled without an interrupt, reset the bus and drop the transfer */
+	I2C_Recover_Locked(bus);
+	I2C_Complete(bus, xfer, I2C_ERR_TIMEOUT);
+	EndCritical(sr);
+	
+	return 1;
+}
+
+/*
+ *	-----------------I2C_Async_Wait------------------
+ *	Sleep until the given transaction completes
+ *	Input: Submitted Transaction Descriptor
+ *	Output: 0 on success, otherwise MCS error bits
+ */
+uint8_t I2C_Async_Wait(I2C_XFER_t* xfer){
+	long sr;
+	
+	while(1){
+		
+		/* Check and sleep with interrupts masked so completion can't slip past WFI */
+		sr = StartCritical();
+		if((xfer->status != I2C_XFER_PENDING) && (xfer->status != I2C_XFER_ACTIVE)){
+			EndCritical(sr);
+			break;
+		}
+		WaitForInterrupt();
+		EndCritical(sr);
+		
+		/* Still in flight, so xfer->bus is valid */
+		I2C_Async_Check_Timeout(xfer->bus);
+	}
+	
+	return xfer->error;
+}
+
+/*
+ *	-----------------I2C_Bus_Handler------------------
+ *	Master interrupt shared by every bus, advances the active
+ *	transfer by one byte each time the previous bus operation completes
+ *	Input: Bus Handle
+ *	Output: None
+ */
+static void I2C_Bus_Handler(I2C_BUS_t* bus){
+	I2C_XFER_t* xfer = bus->active;
+	uint32_t mis = I2C_RD(bus, I2C_O_MMIS);
+	uint8_t error;
+	
+	I2C_WR(bus, I2C_O_MICR, I2C_MICR_IC | I2C_MICR_CLKIC);	// Acknowledge interrupt
+	
+	if(xfer == 0)
+		return;
+	
+	/* Slave held SCL low past MCLKOCNT, hardware already sent STOP */
+	if((mis & I2C_MMIS_CLKMIS) || (I2C_RD(bus, I2C_O_MCS) & I2C_MCS_CLKTO)){
+		I2C_Recover_Locked(bus);
+		I2C_Complete(bus, xfer, I2C_ERR_TIMEOUT);
+		return;
+	}
+	
+	error = I2C_RD(bus, I2C_O_MCS) & (I2C_MCS_ERROR | I2C_MCS_ARBLST);
+	
+	switch(xfer->phase){
+		
+		case XFER_PHASE_REG:
+			/* Register address sent, check for NACK */
+			if(error != 0){
+				xfer->error = error;
+				if(error & I2C_MCS_ARBLST){
+					I2C_Complete(bus, xfer, error);				// Bus already released
+				}
+				else{
+					I2C_WR(bus, I2C_O_MCS, I2C_MCS_STOP);				// Generate STOP and finish after it
+					xfer->phase = XFER_PHASE_STOP;
+				}
+				return;
+			}
+			
+			if(xfer->dir == I2C_XFER_READ){
+				/* Repeated START in read mode */
+				I2C_WR(bus, I2C_O_MSA, (xfer->slave_addr << 1) | I2C_MSA_RS);
+				if(xfer->size == 1)
+					I2C_WR(bus, I2C_O_MCS, (I2C_MCS_RUN | I2C_MCS_START | I2C_MCS_STOP));
+				else
+					I2C_WR(bus, I2C_O_MCS, (I2C_MCS_RUN | I2C_MCS_START | I2C_MCS_ACK));
+				xfer->phase = XFER_PHASE_RX;
+			}
+			else if(xfer->size == 0){
+				/* Register pointer write only */
+				I2C_WR(bus, I2C_O_MCS, I2C_MCS_STOP);
+				xfer->phase = XFER_PHASE_STOP;
+			}
+			else{
+				I2C_WR(bus, I2C_O_MDR, xfer->data[xfer->index++]);
+				I2C_WR(bus, I2C_O_MCS, (xfer->index == xfer->size) ? (I2C_MCS_RUN | I2C_MCS_STOP) : I2C_MCS_RUN);
+				xfer->phase = XFER_PHASE_TX;
+			}
+			break;
+			
+		case XFER_PHASE_TX:
+			if(error != 0){
+				if((xfer->index == xfer->size) || (error & I2C_MCS_ARBLST)){
+					I2C_Complete(bus, xfer, error);				// STOP was already sent
+				}
+				else{
+					xfer->error = error;
+					I2C_WR(bus, I2C_O_MCS, I2C_MCS_STOP);
+					xfer->phase = XFER_PHASE_STOP;
+				}
+				return;
+			}
+			
+			if(xfer->index == xfer->size){
+				I2C_Complete(bus, xfer, 0);
+				return;
+			}
+			
+			I2C_WR(bus, I2C_O_MDR, xfer->data[xfer->index++]);
+			I2C_WR(bus, I2C_O_MCS, (xfer->index == xfer->size) ? (I2C_MCS_RUN | I2C_MCS_STOP) : I2C_MCS_RUN);
+			break;
+			
+		case XFER_PHASE_RX:
+			if(error != 0){
+				if(((xfer->index + 1) == xfer->size) || (error & I2C_MCS_ARBLST)){
+					I2C_Complete(bus, xfer, error);				// STOP was already sent
+				}
+				else{
+					xfer->error = error;
+					I2C_WR(bus, I2C_O_MCS, I2C_MCS_STOP);
+					xfer->phase = XFER_PHASE_STOP;
+				}
+				return;
+			}
+			
+			xfer->data[xfer->index++] = I2C_RD(bus, I2C_O_MDR) & 0xFF;
+			
+			if(xfer->index == xfer->size){
+				I2C_Complete(bus, xfer, 0);
+				return;
+			}
+			
+			/* Last byte is NACKed by sending STOP without ACK */
+			if((xfer->size - xfer->index) == 1)
+				I2C_WR(bus, I2C_O_MCS, (I2C_MCS_RUN | I2C_MCS_STOP));
+			else
+				I2C_WR(bus, I2C_O_MCS, (I2C_MCS_RUN | I2C_MCS_ACK));
+			break;
+			
+		case XFER_PHASE_STOP:
+		default:
+			I2C_Complete(bus, xfer, xfer->error);
+			break;
+	}
+}
+
+#ifdef I2C_TRACE
+/*
+ *	----------------I2C_Trace_Record------------------
+ *	Local function to append one record. Only the slot claim is
+ *	done with interrupts masked, the record itself is filled in
+ *	afterwards so an ISR completing meanwhile just takes the next slot
+ *	Input: Bus Handle, Slave address, Register, Direction, Size,
+ *				 Start CYCCNT, Error bits
+ *	Output: None
+ */
+static void I2C_Trace_Record(I2C_BUS_t* bus, uint8_t addr, uint8_t reg, uint8_t dir, uint32_t size, uint32_t start, uint8_t error){
+	uint32_t end = CYCCNT_Read();
+	I2C_TRACE_ENTRY_t* entry;
+	long sr;
+	
+	if(I2C_Trace_Paused)
+		return;
+	
+	sr = StartCritical();
+	entry = &I2C_Trace_Ring[I2C_Trace_Head & (I2C_TRACE_DEPTH - 1)];
+	I2C_Trace_Head++;
+	EndCritical(sr);
+	
+	entry->start_cycles = start;
+	entry->end_cycles = end;
+	entry->size = (size > 0xFFFF) ? 0xFFFF : (uint16_t)size;
+	entry->bus = bus->module;
+	entry->slave_addr = addr;
+	entry->reg = reg;
+	entry->dir = dir;
+	entry->error = error;
+}
+
+/*
+ *	-----------------I2C_Trace_Clear------------------
+ *	Discard every trace record
+ *	Input: None
+ *	Output: None
+ */
+void I2C_Trace_Clear(void){
+	I2C_Trace_Head = 0;
+}
+
+/*
+ *	-----------------I2C_Trace_Dump-------------------
+ *	Print the trace ring oldest first over UART0, then the total
+ *	bus time per call (bus, slave, register, direction) so the
+ *	call dominating loop latency stands out. Recording is paused
+ *	while printing
+ *	Input: None
+ *	Output: None
+ */
+void I2C_Trace_Dump(void){
+	static I2C_TRACE_ENTRY_t key[I2C_TRACE_SUMMARY_MAX];		// start_cycles holds the total
+	static uint16_t count[I2C_TRACE_SUMMARY_MAX];
+	char buf[100];
+	uint32_t head, first, i, cycles;
+	uint8_t keys = 0;
+	uint8_t k;
+	I2C_TRACE_ENTRY_t* entry;
+	
+	I2C_Trace_Paused = 1;
+	head = I2C_Trace_Head;
+	first = (head > I2C_TRACE_DEPTH) ? (head - I2C_TRACE_DEPTH) : 0;
+	
+	sprintf(buf, "I2C trace: %lu recorded, last %lu shown\r\n", (unsigned long)head, (unsigned long)(head - first));
+	UART0_OutString(buf);
+	
+	for(i = first; i < head; i++){
+		entry = &I2C_Trace_Ring[i & (I2C_TRACE_DEPTH - 1)];
+		cycles = entry->end_cycles - entry->start_cycles;
+		
+		sprintf(buf, "%4lu I2C%u %c 0x%02X reg 0x%02X len %3u  @%10lu  %6lu cyc %5lu us  err 0x%02X\r\n",
+			(unsigned long)i, entry->bus, (entry->dir == I2C_XFER_READ) ? 'R' : 'W',
+			entry->slave_addr, entry->reg, entry->size, (unsigned long)entry->start_cycles,
+			(unsigned long)cycles, (unsigned long)(cycles / (SYS_CLOCK_HZ / 1000000)), entry->error);
+		UART0_OutString(buf);
+		
+		/* Accumulate per call */
+		for(k = 0; k < keys; k++){
+			if((key[k].bus == entry->bus) && (key[k].slave_addr == entry->slave_addr) &&
+				 (key[k].reg == entry->reg) && (key[k].dir == entry->dir))
+				break;
+		}
+		if(k == keys){
+			if(keys == I2C_TRACE_SUMMARY_MAX)
+				continue;
+			key[k] = *entry;
+			key[k].start_cycles = 0;
+			count[k] = 0;
+			keys++;
+		}
+		key[k].start_cycles += cycles;
+		count[k]++;
+	}
+	
+	UART0_OutString("Totals:\r\n");
+	for(k = 0; k < keys; k++){
+		sprintf(buf, "  I2C%u %c 0x%02X reg 0x%02X  x%3u  %8lu cyc %6lu us\r\n",
+			key[k].bus, (key[k].dir == I2C_XFER_READ) ? 'R' : 'W', key[k].slave_addr, key[k].reg,
+			count[k], (unsigned long)key[k].start_cycles,
+			(unsigned long)(key[k].start_cycles / (SYS_CLOCK_HZ / 1000000)));
+		UART0_OutString(buf);
+	}
+	
+	I2C_Trace_Paused = 0;
+}
+
+/*
+ *	-----------------I2C_Trace_Poll-------------------
+ *	UART command hook for the main loop, never blocks.
+ *	't' dumps the trace, 'c' clears it
+ *	Input: None
+ *	Output: None
+ */
+void I2C_Trace_Poll(void){
+	switch(UART0_InCharNonBlocking()){
+		case 't':
+		case 'T':
+			I2C_Trace_Dump();
+			break;
+		case 'c':
+		case 'C':
+			I2C_Trace_Clear();
+			UART0_OutString("I2C trace cleared\r\n");
+			break;
+		default:
+			break;
+	}
+}
+#endif
+
+/* NVIC entry points, one per module */
+void I2C0_Handler(void){
+	I2C_Bus_Handler(&I2C0_Bus);
+}
+
+void I2C1_Handler(void){
+	I2C_Bus_Handler(&I2C1_Bus);
+}
+
+void I2C2_Handler(void){
+	I2C_Bus_Handler(&I2C2_Bus);
+}
+
+void I2C3_Handler(void){
+	I2C_Bus_Handler(&I2C3_Bus);
+}
@@ -15,6 +15,10 @@
 #include "tm4c123gh6pm.h"
 #include "util.h"
 
+/* Uncomment to record every transaction into a trace ring (costs RAM and a
+	 few hundred cycles per transaction, compiled out completely otherwise) */
+//#define I2C_TRACE
+
 /* List of Fill In Macros */
 
 //Init Function
@@ -26,8 +30,35 @@
 #define I2C0_SDA_PIN			(0x00000008)  // PB3 (SDA)
 #define I2C0_SCL_PIN			(0x00000004)  // PB2 (SCL)
 #define EN_I2C0_MASTER		(0x00000010)  // Bit 4 in MCR enables master mode
-#define I2C_MTPR_TPR_VALUE	(0x00000007)  // TPR value for 100kHz at 40MHz system clock
-#define I2C_MTPR_STD_SPEED (0x00000000)  // Standard speed mode (100kHz)
+
+//Remaining Modules (every I2C pin uses PCTL encoding 3)
+#define I2C1_SDA_PIN			(0x00000080)  // PA7 (SDA)
+#define I2C1_SCL_PIN			(0x00000040)  // PA6 (SCL)
+#define I2C1_ALT_FUNC_MSK	(0x00FFFFFF)  // Mask for PCTL bits 24-31
+#define I2C1_ALT_FUNC_SET	(0x33000000)  // Set PCTL bits 24-31 to 3 for I2C
+#define I2C2_SDA_PIN			(0x00000020)  // PE5 (SDA)
+#define I2C2_SCL_PIN			(0x00000010)  // PE4 (SCL)
+#define I2C2_ALT_FUNC_MSK	(0xFF00FFFF)  // Mask for PCTL bits 16-23
+#define I2C2_ALT_FUNC_SET	(0x00330000)  // Set PCTL bits 16-23 to 3 for I2C
+#define I2C3_SDA_PIN			(0x00000002)  // PD1 (SDA), tied to PB7 on the LaunchPad via R10
+#define I2C3_SCL_PIN			(0x00000001)  // PD0 (SCL), tied to PB6 on the LaunchPad via R9
+#define I2C3_ALT_FUNC_MSK	(0xFFFFFF00)  // Mask for PCTL bits 0-7
+#define I2C3_ALT_FUNC_SET	(0x00000033)  // Set PCTL bits 0-7 to 3 for I2C
+
+//Register Blocks
+#define I2C0_BASE_ADDR			(0x40020000)
+#define I2C1_BASE_ADDR			(0x40021000)
+#define I2C2_BASE_ADDR			(0x40022000)
+#define I2C3_BASE_ADDR			(0x40023000)
+#define GPIOA_BASE_ADDR			(0x40004000)
+#define GPIOB_BASE_ADDR			(0x40005000)
+#define GPIOD_BASE_ADDR			(0x40007000)
+#define GPIOE_BASE_ADDR			(0x40024000)
+
+//Bus Speed Function
+#define I2C_SCL_LP					(6U)          // SCL low period in timer ticks (fixed by hardware)
+#define I2C_SCL_HP					(4U)          // SCL high period in timer ticks (fixed by hardware)
+#define I2C_MTPR_TPR_MIN		(1U)          // Smallest usable TPR (see Table 16-2)
 
 //Transmit Function
 #define I2C0_RW_PIN				(0x00000001)  // Bit 0 in MSA for read/write control
@@ -35,49 +66,339 @@
 //Burst Transmit Function
 #define RUN_CMD						(0x00000001)  // Bit 0 in MCS for run command
 
+//Timeout and Recovery
+#define I2C_ERR_TIMEOUT				(0x80)        // Returned on clock-low timeout (MCS CLKTO) or missed deadline
+#define I2C_DEFAULT_TIMEOUT_US	(1000U)     // Longest wait for any single bus operation
+#define I2C_MCLKOCNT_MIN			(0x02U)       // CNTL must be greater than 0x1
+#define I2C_MCLKOCNT_MAX			(0xFFU)       // 8-bit field (upper 8 bits of a 12-bit count)
+#define I2C_RECOVER_CLOCKS		(9U)          // SCL pulses to flush a slave stuck mid-byte
+
+//Asynchronous Engine
+#define I2C0_IRQ_NUM				(8U)          // NVIC interrupt numbers
+#define I2C1_IRQ_NUM				(37U)
+#define I2C2_IRQ_NUM				(68U)
+#define I2C3_IRQ_NUM				(69U)
+#define I2C_IRQ_PRIORITY		(3U)          // Same priority on every bus
+
+//Transaction Trace
+#define I2C_TRACE_DEPTH			(64U)         // Records kept, must be a power of 2
+#define I2C_TRACE_SUMMARY_MAX	(16U)       // Distinct calls totalled by I2C_Trace_Dump
+
+typedef struct I2C_BUS I2C_BUS_t;
+typedef struct I2C_XFER I2C_XFER_t;
+
+/* Register Shadow Cache (one per device, covers a contiguous window of
+	 configuration registers so reads can be served without bus traffic) */
+#define I2C_SHADOW_VALID_WORDS(size)	((((uint32_t)(size)) + 31U) / 32U)
+
+typedef struct{
+	I2C_BUS_t* bus;									// Bus the device is attached to
+	uint8_t slave_addr;							// Device the window belongs to
+	uint8_t cmd;										// OR'd onto register address (e.g. command bit), 0 if none
+	uint8_t base_reg;								// First register in window
+	uint8_t size;										// Number of registers in window
+	uint8_t* value;									// Cached register values [size]
+	uint32_t* valid;								// Valid bitmask [I2C_SHADOW_VALID_WORDS(size)]
+} I2C_SHADOW_t;
+
+/* Standard Bus Speeds (SCL frequency in Hz) */
+typedef enum{
+	I2C_SPEED_STANDARD	= 100000,		// Standard-mode 100kHz
+	I2C_SPEED_FAST			= 400000,		// Fast-mode 400kHz
+	I2C_SPEED_FAST_PLUS	= 1000000		// Fast-mode Plus 1MHz (needs >= 40MHz system clock; clamps to 400kHz at 16MHz)
+} I2C_SPEED;
+
+/* Asynchronous Transaction Direction */
+typedef enum{
+	I2C_XFER_WRITE	= 0,
+	I2C_XFER_READ		= 1
+} I2C_XFER_DIR;
+
+/* Asynchronous Transaction Status */
+typedef enum{
+	I2C_XFER_IDLE		= 0,			// Never submitted or already collected
+	I2C_XFER_PENDING	= 1,			// Waiting in queue
+	I2C_XFER_ACTIVE		= 2,			// Currently on the bus
+	I2C_XFER_DONE		= 3,			// Completed successfully
+	I2C_XFER_ERROR		= 4				// Completed with error (see error field)
+} I2C_XFER_STATUS;
+
+/* Scheduling Class, lower value wins at every transaction boundary.
+	 A transfer waits for at most the one transaction already on the bus */
+typedef enum{
+	I2C_PRIO_REALTIME	= 0,			// Periodic sensor reads (default for zeroed descriptors)
+	I2C_PRIO_CONFIG		= 1,			// Configuration writes
+	I2C_PRIO_BULK			= 2,			// Display and other throughput traffic
+	I2C_PRIO_COUNT		= 3
+} I2C_PRIORITY;
+
+/* Completion callback, runs inside the bus interrupt handler */
+typedef void (*I2C_XFER_CALLBACK)(I2C_XFER_t* xfer);
+
+/* Transaction Descriptor (owned by the caller until completion) */
+struct I2C_XFER{
+	uint8_t slave_addr;							// 7-bit slave address
+	uint8_t slave_reg_addr;					// Starting slave register address
+	I2C_XFER_DIR dir;								// Read or Write
+	uint8_t* data;									// Data buffer to fill or transmit
+	uint32_t size;									// Number of data bytes
+	I2C_XFER_CALLBACK callback;			// Optional completion callback (NULL if polling)
+	void* context;									// Optional user pointer for callback
+	I2C_PRIORITY priority;					// Scheduling class
+	
+	volatile I2C_XFER_STATUS status;	// Polled by caller
+	volatile uint8_t error;						// MCS error bits on failure, otherwise 0
+	
+	/* Driver Private */
+	I2C_BUS_t* bus;									// Bus the transfer was submitted on
+	uint32_t start_cycles;					// CYCCNT when the transfer went on the bus
+	uint32_t index;									// Bytes transferred so far
+	uint8_t phase;									// Engine state
+	I2C_XFER_t* next;								// Queue link
+};
+
+/* Transaction Trace Record */
+typedef struct{
+	uint32_t start_cycles;					// CYCCNT at call entry (blocking) or bus start (queued)
+	uint32_t end_cycles;						// CYCCNT at completion
+	uint16_t size;									// Number of data bytes
+	uint8_t bus;										// n in I2Cn
+	uint8_t slave_addr;							// 7-bit slave address
+	uint8_t reg;										// Starting slave register address
+	uint8_t dir;										// I2C_XFER_READ or I2C_XFER_WRITE
+	uint8_t error;									// MCS error bits, I2C_ERR_TIMEOUT or 0
+} I2C_TRACE_ENTRY_t;
+
+/* Bus Handle (hardware description is fixed, the rest is driver state) */
+struct I2C_BUS{
+	uint32_t base;									// I2Cn register block
+	uint32_t gpio_base;							// Port register block holding SCL/SDA
+	uint8_t module;									// n in I2Cn, bit in RCGCI2C/PRI2C
+	uint8_t gpio_port;							// Port index, bit in RCGCGPIO/PRGPIO
+	uint8_t scl_pin;								// SCL pin mask
+	uint8_t sda_pin;								// SDA pin mask
+	uint32_t pctl_msk;							// PCTL mask for both pins
+	uint32_t pctl_set;							// PCTL value selecting I2C on both pins
+	uint8_t irq;										// NVIC interrupt number
+	
+	/* Driver Private */
+	uint32_t tpr;										// Current MTPR value (kept across recovery)
+	uint32_t timeout_us;						// Per bus operation timeout
+	uint32_t timeout_cycles;				// Same timeout in CYCCNT cycles
+	volatile uint8_t needs_recovery;	// Set when a blocking call timed out
+	volatile uint8_t polled_owner;		// Set while a blocking call owns the bus
+	I2C_XFER_t* volatile head[I2C_PRIO_COUNT];	// Front of each class queue
+	I2C_XFER_t* volatile tail[I2C_PRIO_COUNT];	// Back of each class queue
+	I2C_XFER_t* volatile active;		// Transfer currently on the bus
+};
+
+/* Available Buses */
+extern I2C_BUS_t I2C0_Bus;						// PB2 (SCL), PB3 (SDA)
+extern I2C_BUS_t I2C1_Bus;						// PA6 (SCL), PA7 (SDA)
+extern I2C_BUS_t I2C2_Bus;						// PE4 (SCL), PE5 (SDA)
+extern I2C_BUS_t I2C3_Bus;						// PD0 (SCL), PD1 (SDA)
+
 /*
- *	-------------------I2C0_Init------------------
- *	Basic I2C Initialization function for master mode @ 100kHz
- *	Input: None
+ *	--------------------I2C_Init-------------------
+ *	Basic I2C Initialization function for master mode @ 100kHz.
+ *	Every bus has its own interrupt, so transfers on different
+ *	buses run concurrently
+ *	Input: Bus Handle
+ *	Output: None
+ */
+void I2C_Init(I2C_BUS_t* bus);
+
+/*
+ *	-----------------I2C_Set_Speed------------------
+ *	Change the SCL frequency, TPR is derived from SYS_CLOCK_HZ and
+ *	rounded so the bus never runs faster than requested. Waits for
+ *	any queued transfers to finish before switching.
+ *	Input: Bus Handle, Target SCL frequency in Hz (normally an I2C_SPEED value)
+ *	Output: Actual SCL frequency in Hz
+ */
+uint32_t I2C_Set_Speed(I2C_BUS_t* bus, uint32_t scl_hz);
+
+/*
+ *	-----------------I2C_Get_Speed------------------
+ *	Read back the SCL frequency the bus is currently running at
+ *	Input: Bus Handle
+ *	Output: Actual SCL frequency in Hz
+ */
+uint32_t I2C_Get_Speed(I2C_BUS_t* bus);
+
+/*
+ *	----------------I2C_Set_Timeout-----------------
+ *	Bound every bus operation. Sets both the hardware clock-low
+ *	timeout (MCLKOCNT) and the software CYCCNT deadline used by
+ *	the blocking functions. A timed out call returns I2C_ERR_TIMEOUT
+ *	and the bus is recovered before the next transaction.
+ *	Input: Bus Handle, Timeout per bus operation in microseconds
  *	Output: None
  */
-void I2C0_Init(void);
+void I2C_Set_Timeout(I2C_BUS_t* bus, uint32_t timeout_us);
 
 /*
- *	-------------------I2C0_Receive------------------
+ *	----------------I2C_Bus_Recover-----------------
+ *	Free a bus held by a stuck slave: switch SCL/SDA to GPIO, clock
+ *	out 9 SCL pulses, generate a STOP, then re-initialize the module
+ *	at the current speed
+ *	Input: Bus Handle
+ *	Output: 0 if SDA is released, 1 if the bus is still held low
+ */
+uint8_t I2C_Bus_Recover(I2C_BUS_t* bus);
+
+/*
+ *	-------------------I2C_Receive------------------
  *	Polls to receive data from specified peripheral
- *	Input: Slave address & Slave Register Address
+ *	Input: Bus Handle, Slave address & Slave Register Address
  *	Output: Returns 8-bit data that has been received
  */
-uint8_t I2C0_Receive(uint8_t slave_addr, uint8_t slave_reg_addr);
+uint8_t I2C_Receive(I2C_BUS_t* bus, uint8_t slave_addr, uint8_t slave_reg_addr);
 
 /*
- *	-------------------I2C0_Transmit------------------
+ *	-------------------I2C_Transmit------------------
  *	Transmit a byte of data to specified peripheral
- *	Input: Slave address, Slave Register Address, Data to Transmit
+ *	Input: Bus Handle, Slave address, Slave Register Address, Data to Transmit
  *	Output: Any Errors if detected, otherwise 0
  */
-uint8_t I2C0_Transmit(uint8_t slave_addr, uint8_t slave_reg_addr, uint8_t data);
+uint8_t I2C_Transmit(I2C_BUS_t* bus, uint8_t slave_addr, uint8_t slave_reg_addr, uint8_t data);
 
-//Has Yet to be Implemented
 /*
- *	----------------I2C0_Burst_Receive-----------------
+ *	----------------I2C_Burst_Receive-----------------
  *	Polls to receive multiple bytes of data from specified
  *  peripheral by incrementing starting slave register address
- *	Input: Slave address, Slave Register Address, Data Buffer
- *	Output: None
+ *	Input: Bus Handle, Slave address, Slave Register Address, Data Buffer, Size of Receive
+ *	Output: Any Errors if detected, otherwise 0
  */
-void I2C0_Burst_Receive(uint8_t slave_addr, uint8_t slave_reg_addr, uint8_t* data, uint32_t size);
+uint8_t I2C_Burst_Receive(I2C_BUS_t* bus, uint8_t slave_addr, uint8_t slave_reg_addr, uint8_t* data, uint32_t size);
 
 /*
- *	----------------I2C0_Burst_Transmit-----------------
+ *	----------------I2C_Burst_Transmit-----------------
  *	Transmit multiple bytes of data to specified peripheral
  *  by incrementing starting slave address
- *	Input: Slave address, Slave Register Address, Data Buffer to transmit, Size of Transmit
+ *	Input: Bus Handle, Slave address, Slave Register Address, Data Buffer to transmit, Size of Transmit
+ *	Output: Any Errors if detected, otherwise 0
+ */
+uint8_t I2C_Burst_Transmit(I2C_BUS_t* bus, uint8_t slave_addr, uint8_t slave_reg_addr, uint8_t* data, uint32_t size);
+
+/*
+ *	---------------I2C_Shadow_Write------------------
+ *	Transmit a register through the device's shadow cache, the
+ *	cached value is only updated if the slave ACKs the write
+ *	Input: Shadow Cache, Register Address, Data to Transmit
+ *	Output: Any Errors if detected, otherwise 0
+ */
+uint8_t I2C_Shadow_Write(I2C_SHADOW_t* shadow, uint8_t reg, uint8_t data);
+
+/*
+ *	------------I2C_Shadow_Burst_Write---------------
+ *	Burst transmit consecutive registers through the shadow cache
+ *	Input: Shadow Cache, Starting Register Address, Data Buffer, Size
+ *	Output: Any Errors if detected, otherwise 0
+ */
+uint8_t I2C_Shadow_Burst_Write(I2C_SHADOW_t* shadow, uint8_t reg, uint8_t* data, uint32_t size);
+
+/*
+ *	----------------I2C_Shadow_Read------------------
+ *	Return a configuration register from the cache, only touching
+ *	the bus the first time (or after invalidation). Never use for
+ *	registers the device changes on its own (data, status)
+ *	Input: Shadow Cache, Register Address
+ *	Output: Register value (0xFF on bus error, not cached)
+ */
+uint8_t I2C_Shadow_Read(I2C_SHADOW_t* shadow, uint8_t reg);
+
+/*
+ *	-------------I2C_Shadow_Invalidate---------------
+ *	Forget every cached value, e.g. after a device reset
+ *	Input: Shadow Cache
  *	Output: None
  */
-uint8_t I2C0_Burst_Transmit(uint8_t slave_addr, uint8_t slave_reg_addr, uint8_t* data, uint32_t size);
+void I2C_Shadow_Invalidate(I2C_SHADOW_t* shadow);
 
-#endif //I2C_H_
+/*
+ *	-------------------I2C_Submit--------------------
+ *	Queue a transaction descriptor on the bus's interrupt driven
+ *	engine in its priority class. Returns immediately, the transfer
+ *	runs from the bus interrupt handler. Blocking functions above
+ *	act as real-time: they take the bus at the next transaction
+ *	boundary, ahead of anything still queued.
+ *	Input: Bus Handle, Filled in Transaction Descriptor
+ *	Output: 0 if queued, 1 if the descriptor is already in flight
+ */
+uint8_t I2C_Submit(I2C_BUS_t* bus, I2C_XFER_t* xfer);
 
+/*
+ *	---------------I2C_Async_Receive-----------------
+ *	Fill in a descriptor for a burst read and submit it
+ *	Input: Bus Handle, Descriptor, Slave address, Slave Register Address,
+ *				 Data Buffer, Size, Completion Callback (NULL to poll)
+ *	Output: 0 if queued, 1 if the descriptor is already in flight
+ */
+uint8_t I2C_Async_Receive(I2C_BUS_t* bus, I2C_XFER_t* xfer, uint8_t slave_addr, uint8_t slave_reg_addr, uint8_t* data, uint32_t size, I2C_XFER_CALLBACK callback);
+
+/*
+ *	---------------I2C_Async_Transmit----------------
+ *	Fill in a descriptor for a burst write and submit it
+ *	Input: Bus Handle, Descriptor, Slave address, Slave Register Address,
+ *				 Data Buffer, Size, Completion Callback (NULL to poll)
+ *	Output: 0 if queued, 1 if the descriptor is already in flight
+ */
+uint8_t I2C_Async_Transmit(I2C_BUS_t* bus, I2C_XFER_t* xfer, uint8_t slave_addr, uint8_t slave_reg_addr, uint8_t* data, uint32_t size, I2C_XFER_CALLBACK callback);
 
+/*
+ *	-----------------I2C_Async_Busy------------------
+ *	Check if the bus still has queued or active transactions in any class
+ *	Input: Bus Handle
+ *	Output: 1 if busy, 0 if idle
+ */
+uint8_t I2C_Async_Busy(I2C_BUS_t* bus);
+
+/*
+ *	-------------I2C_Async_Check_Timeout-------------
+ *	Abort the active transfer if it has overrun its deadline of
+ *	(size + 2) bus operations. Call periodically when polling status.
+ *	Input: Bus Handle
+ *	Output: 1 if a transfer was aborted, otherwise 0
+ */
+uint8_t I2C_Async_Check_Timeout(I2C_BUS_t* bus);
+
+/*
+ *	-----------------I2C_Async_Wait------------------
+ *	Sleep until the given transaction completes
+ *	Input: Submitted Transaction Descriptor
+ *	Output: 0 on success, otherwise MCS error bits
+ */
+uint8_t I2C_Async_Wait(I2C_XFER_t* xfer);
+
+#ifdef I2C_TRACE
+/*
+ *	-----------------I2C_Trace_Clear------------------
+ *	Discard every trace record
+ *	Input: None
+ *	Output: None
+ */
+void I2C_Trace_Clear(void);
+
+/*
+ *	-----------------I2C_Trace_Dump-------------------
+ *	Print the trace ring oldest first over UART0, then the total
+ *	bus time per call (bus, slave, register, direction) so the
+ *	call dominating loop latency stands out. Recording is paused
+ *	while printing
+ *	Input: None
+ *	Output: None
+ */
+void I2C_Trace_Dump(void);
+
+/*
+ *	-----------------I2C_Trace_Poll-------------------
+ *	UART command hook for the main loop, never blocks.
+ *	't' dumps the trace, 'c' clears it
+ *	Input: None
+ *	Output: None
+ */
+void I2C_Trace_Poll(void);
+#endif
+
+#endif //I2C_H_
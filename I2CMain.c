@@ -22,6 +22,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "ModuleTest.h"
+#include "EEPROM.h"
 
 /* List of Predefined Macros for individual Peripheral Testing */
 //#define DELAY
@@ -29,8 +30,14 @@
 //#define I2C
 //#define TCS34727
 //#define MPU6050
+//#define MPU6050_IDLE				// With MPU6050, sleep in wake-on-motion mode while the board is still
+//#define MPU6050_VIBRATION		// With MPU6050, stream the accel vibration spectrum instead of angles
+//#define MPU6050_DECIM				// With MPU6050, decimate the 1kHz FIFO gyro stream to 10Hz instead of angles
+//#define MPU6050_DUAL
 //#define SERVO
 //#define LCD
+//#define FASTMATH
+//#define DSP16
 #define FULL_SYSTEM
 
 int main(void){
@@ -39,22 +46,54 @@ int main(void){
 	UART0_Init();
 	LED_Init();
 	BTN_Init();
-	#if defined(DELAY) || defined(TCS34727) || defined(MPU6050) || defined(LCD) || defined(FULL_SYSTEM)	
+	#if defined(DELAY) || defined(TCS34727) || defined(MPU6050) || defined(MPU6050_DUAL) || defined(LCD) || defined(FULL_SYSTEM)	
 	WTIMER0_Init();
 	#endif
 	
-	#if defined (I2C) || defined(TCS34727) || defined(MPU6050) || defined(LCD) || defined(FULL_SYSTEM)
-	I2C0_Init();
+	#if defined (I2C) || defined(TCS34727) || defined(MPU6050) || defined(MPU6050_DUAL) || defined(LCD) || defined(FULL_SYSTEM)
+	I2C_Init(IMU_BUS);
+	if(DISPLAY_BUS != IMU_BUS)
+		I2C_Init(DISPLAY_BUS);
 	#endif
 	
 	#if defined(TCS34727) || defined(FULL_SYSTEM)
 	/* Color Sensor Initialization */
-	TCS34727_Init();
+	TCS34727_Init(DISPLAY_BUS);
 	#endif
 	
 	#if defined(MPU6050) || defined(FULL_SYSTEM)
 	/* MPU6050 Initialization */
-	MPU6050_Init();
+	MPU6050_Init(&IMU_Instance, IMU_BUS, MPU6050_ADDR_AD0_LOW);
+	
+	/* Bias offsets from EEPROM, calibrate (keep the board still and level) only if none are stored */
+	EEPROM_Init();
+	if(MPU6050_Load_Calibration(&IMU_Instance) != 0){
+		UART0_OutString("Calibrating MPU6050, keep still\r\n");
+		if(MPU6050_Calibrate(&IMU_Instance, MPU6050_CAL_SAMPLES) == 0)
+			MPU6050_Save_Calibration(&IMU_Instance);
+		else
+			UART0_OutString("Calibration failed, running without offsets\r\n");
+	}
+	#endif
+	
+	#ifdef MPU6050
+	/* Sample on the data-ready edge, 1kHz needs Fast-mode (the LCD on a shared bus does not) */
+	#ifndef LCD
+	I2C_Set_Speed(IMU_BUS, I2C_SPEED_FAST);
+	#endif
+	AHRS_Init(&AHRS_Instance, AHRS_KP_DEFAULT, AHRS_KI_DEFAULT);
+	MPU6050_DRDY_Init(&IMU_Instance);
+	#endif
+	
+	#ifdef MPU6050_DUAL
+	/* Two MPU6050s on one bus (the second with AD0 pulled high), polled back-to-back */
+	MPU6050_Init(&IMU_Instance, IMU_BUS, MPU6050_ADDR_AD0_LOW);
+	MPU6050_Init(&IMU2_Instance, IMU_BUS, MPU6050_ADDR_AD0_HIGH);
+	
+	/* Each device keeps its own EEPROM record */
+	EEPROM_Init();
+	MPU6050_Load_Calibration(&IMU_Instance);
+	MPU6050_Load_Calibration(&IMU2_Instance);
 	#endif
 	
 	#if defined(SERVO) || defined(FULL_SYSTEM)
@@ -64,7 +103,7 @@ int main(void){
 	
 	#if defined(LCD) || defined(FULL_SYSTEM)
 	/* LCD Initialization */
-	LCD_Init();
+	LCD_Init(DISPLAY_BUS);
 	#endif
 	
 	while(1){
@@ -82,8 +121,20 @@ int main(void){
 		#endif
 		
 		#ifdef MPU6050
+		#if defined(MPU6050_IDLE)
+		Module_Test(MPU6050_IDLE_TEST);
+		#elif defined(MPU6050_VIBRATION)
+		Module_Test(MPU6050_VIBRATION_TEST);
+		#elif defined(MPU6050_DECIM)
+		Module_Test(MPU6050_DECIM_TEST);
+		#else
 		Module_Test(MPU6050_TEST);
 		#endif
+		#endif
+		
+		#ifdef MPU6050_DUAL
+		Module_Test(MPU6050_DUAL_TEST);
+		#endif
 		
 		#ifdef TCS34727
 		Module_Test(TCS34727_TEST);
@@ -97,10 +148,22 @@ int main(void){
 		Module_Test(LCD_TEST);
 		#endif
 		
+		#ifdef FASTMATH
+		Module_Test(FASTMATH_TEST);
+		#endif
+		
+		#ifdef DSP16
+		Module_Test(DSP16_TEST);
+		#endif
+		
 		#ifdef FULL_SYSTEM
 		Module_Test(FULL_SYSTEM_TEST);
 		#endif
 		
+		#ifdef I2C_TRACE
+		I2C_Trace_Poll();			// 't' on the terminal dumps the bus trace
+		#endif
+		
 	}
 	
 	return 0;
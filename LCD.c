@@ -14,34 +14,64 @@
 #include "util.h"
 #include "I2C.h"
 
+/* Bus the backpack is attached to, set by LCD_Init */
+static I2C_BUS_t* LCD_Bus;
+
+/* Asynchronous Frame Ring, one 4-byte frame per command or character */
+typedef struct{
+	I2C_XFER_t xfer;
+	uint8_t data[LCD_FRAME_SIZE];
+} LCD_FRAME_t;
+
+static LCD_FRAME_t LCD_Queue[LCD_QUEUE_DEPTH];
+static uint8_t LCD_Queue_Next;									// Next slot to fill
+static LCD_FRAME_t* LCD_Queue_Last;							// Most recently submitted frame
+
 /*
- *	-------------------LCD_Send_CMD------------------
- *	Local LCD send commands function
- *	Input: Command to send
+ *	------------------LCD_Send_Frame-----------------
+ *	Local function to queue one byte as a bulk priority I2C
+ *	transfer. Each frame takes about 0.5ms on a 100kHz bus, which
+ *	covers the 37us the LCD needs per ordinary command or character,
+ *	so frames are sent back to back without delays. Only blocks
+ *	when every slot in the ring is still waiting for the bus
+ *	Input: Byte to send, RS_Pin for data or 0 for a command
  *	Output: None
  */
-static void LCD_Send_CMD(uint8_t cmd){
+static void LCD_Send_Frame(uint8_t value, uint8_t mode){
+	LCD_FRAME_t* frame = &LCD_Queue[LCD_Queue_Next];
 	
 	/* Temp Variables to hold upper and lower value */
-	uint8_t cmd_upper, cmd_lower;
-	uint8_t cmd_array[4];								//Command Array to Burst Transmit
+	uint8_t upper, lower;
+	
+	/* Slots are reused in order, wait for the oldest one to go out */
+	I2C_Async_Wait(&frame->xfer);
 	
 	/* Seperate Upper and Lower Nibble */
-	cmd_upper = (cmd & UPPER_NIBBLE_MSK);
-	cmd_lower = ((cmd << NIBBLE_SHIFT) & UPPER_NIBBLE_MSK);
+	upper = (value & UPPER_NIBBLE_MSK);
+	lower = ((value << NIBBLE_SHIFT) & UPPER_NIBBLE_MSK);
 	
 	/* LCD I2C Message Pattern */
-	cmd_array[0] = cmd_upper | (BACKLIGHT|EN_Pin);  // Send upper nibble with EN high
-	DELAY_1MS(1);                                    // Short delay
-	cmd_array[1] = cmd_upper | BACKLIGHT;           // Send upper nibble with EN low
-	DELAY_1MS(1);                                    // Short delay
-	cmd_array[2] = cmd_lower | (BACKLIGHT|EN_Pin);  // Send lower nibble with EN high
-	DELAY_1MS(1);                                    // Short delay
-	cmd_array[3] = cmd_lower | BACKLIGHT;           // Send lower nibble with EN low
-	
-	/* I2C Burst Transmit Command Array to LCD */
-	I2C0_Burst_Transmit(LCD_WRITE_ADDR, PCF8574A_REG, cmd_array, sizeof(cmd_array));
-	DELAY_1MS(2);                                    // Delay after command
+	frame->data[0] = upper | (BACKLIGHT|EN_Pin|mode);  // Send upper nibble with EN high
+	frame->data[1] = upper | (BACKLIGHT|mode);         // Send upper nibble with EN low
+	frame->data[2] = lower | (BACKLIGHT|EN_Pin|mode);  // Send lower nibble with EN high
+	frame->data[3] = lower | (BACKLIGHT|mode);         // Send lower nibble with EN low
+	
+	/* Display traffic must never hold up sensor reads */
+	frame->xfer.priority = I2C_PRIO_BULK;
+	I2C_Async_Transmit(LCD_Bus, &frame->xfer, LCD_WRITE_ADDR, PCF8574A_REG, frame->data, LCD_FRAME_SIZE, 0);
+	
+	LCD_Queue_Last = frame;
+	LCD_Queue_Next = (LCD_Queue_Next + 1) % LCD_QUEUE_DEPTH;
+}
+
+/*
+ *	-------------------LCD_Send_CMD------------------
+ *	Local LCD send commands function
+ *	Input: Command to send
+ *	Output: None
+ */
+static void LCD_Send_CMD(uint8_t cmd){
+	LCD_Send_Frame(cmd, 0);
 }
 
 /*
@@ -51,36 +81,31 @@ static void LCD_Send_CMD(uint8_t cmd){
  *	Output: None
  */
 static void LCD_Send_Data(uint8_t data){
+	LCD_Send_Frame(data, RS_Pin);
+}
+
+/*
+ *	--------------------LCD_Flush--------------------
+ *	Wait until every queued frame has reached the LCD
+ *	Input: None
+ *	Output: None
+ */
+void LCD_Flush(void){
 	
-	/* Temp Variables to hold upper and lower value */
-	uint8_t data_upper, data_lower;
-	uint8_t data_array[4];							//Data Array to Burst Transmit
-	
-	/* Seperate Upper and Lower Nibble */
-	data_upper = (data & UPPER_NIBBLE_MSK);
-	data_lower = ((data << NIBBLE_SHIFT) & UPPER_NIBBLE_MSK);
-	
-	/* LCD I2C Message Pattern */
-	data_array[0] = data_upper | (BACKLIGHT|EN_Pin|RS_Pin);  // Send upper nibble with EN high
-	DELAY_1MS(1);                                             // Short delay
-	data_array[1] = data_upper | (BACKLIGHT|RS_Pin);         // Send upper nibble with EN low
-	DELAY_1MS(1);                                             // Short delay
-	data_array[2] = data_lower | (BACKLIGHT|EN_Pin|RS_Pin);  // Send lower nibble with EN high
-	DELAY_1MS(1);                                             // Short delay
-	data_array[3] = data_lower | (BACKLIGHT|RS_Pin);         // Send lower nibble with EN low
-	
-	/* I2C Burst Transmit Data Array to LCD */
-	I2C0_Burst_Transmit(LCD_WRITE_ADDR, PCF8574A_REG, data_array, sizeof(data_array));
-	DELAY_1MS(2);                                             // Delay after data
+	/* Frames leave in order, so the last one finishing means all did */
+	if(LCD_Queue_Last)
+		I2C_Async_Wait(&LCD_Queue_Last->xfer);
 }
 
 /*
  *	-------------------LCD_Init------------------
  *	Basic LCD Initialization Function
- *	Input: None
+ *	Input: Bus the PCF8574A backpack is attached to (100kHz max)
  *	Output: None
  */
-void LCD_Init(void){
+void LCD_Init(I2C_BUS_t* bus){
+	
+	LCD_Bus = bus;
 	
 	/* Power up delay */
 	DELAY_1MS(100);  // Increased initial delay for power stabilization
@@ -130,7 +155,8 @@ void LCD_Init(void){
  */
 void LCD_Clear(void){
 	LCD_Send_CMD(CLEAR_DISP_CMD);
-	DELAY_1MS(1);
+	LCD_Flush();
+	DELAY_1MS(2);								// Clear takes 1.52ms inside the LCD
 }
 
 /*
@@ -156,8 +182,6 @@ void LCD_Set_Cursor(uint8_t row, uint8_t col){
 	
 	/* Send Command to set Row and Column */
 	LCD_Send_CMD(col);
-	DELAY_1MS(2);
-	
 }
 
 /*
@@ -168,7 +192,8 @@ void LCD_Set_Cursor(uint8_t row, uint8_t col){
  */
 void LCD_Reset_Cursor(void){
 	LCD_Send_CMD(RETURN_HOME_CMD);
-	DELAY_1MS(1);
+	LCD_Flush();
+	DELAY_1MS(2);								// Return home takes 1.52ms inside the LCD
 }
 
 /*
@@ -179,18 +204,16 @@ void LCD_Reset_Cursor(void){
  */
 void LCD_Print_Char(uint8_t data){
 	LCD_Send_Data(data);
-	DELAY_1MS(1);
 }
 
 /*
  *	----------------LCD_Print_Str-----------------
- *	Prints a string to LCD
+ *	Prints a string to LCD. Characters are copied into the frame
+ *	ring, so the string may be reused as soon as this returns
  *	Input: Pointer to Character Array
  *	Output: None
  */
 void LCD_Print_Str(uint8_t* str){
-	while(*str){
+	while(*str)
 		LCD_Send_Data(*str++);
-		DELAY_1MS(2);
-	}
 }
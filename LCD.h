@@ -12,6 +12,7 @@
 #ifndef LCD_H_
 #define LCD_H_
 #include "util.h"
+#include "I2C.h"
 
 /*************PCF8574A Register*************/
 #define LCD_WRITE_ADDR			(0x3FU)
@@ -57,16 +58,18 @@
 #define ROW1								(0U)
 #define ROW2								(1U)
 #define LCD_ROW_SIZE				(16U)
+#define LCD_FRAME_SIZE			(4U)		// I2C bytes per command or character
+#define LCD_QUEUE_DEPTH			(36U)		// Frames in flight, two full rows plus cursor moves
 
 #include <stdint.h>
 
 /*
  *	-------------------LCD_Init------------------
  *	Basic LCD Initialization Function
- *	Input: None
+ *	Input: Bus the PCF8574A backpack is attached to (100kHz max)
  *	Output: None
  */
-void LCD_Init(void);
+void LCD_Init(I2C_BUS_t* bus);
 
 /*
  *	-------------------LCD_Clear------------------
@@ -102,10 +105,19 @@ void LCD_Print_Char(uint8_t data);
 
 /*
  *	----------------LCD_Print_Str-----------------
- *	Prints a string to LCD
+ *	Prints a string to LCD. Characters are copied into the frame
+ *	ring, so the string may be reused as soon as this returns
  *	Input: Pointer to Character Array
  *	Output: None
  */
 void LCD_Print_Str(uint8_t* str);
 
+/*
+ *	--------------------LCD_Flush--------------------
+ *	Wait until every queued frame has reached the LCD
+ *	Input: None
+ *	Output: None
+ */
+void LCD_Flush(void);
+
 #endif
\ No newline at end of file
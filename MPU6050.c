@@ -13,6 +13,8 @@
 #include "I2C.h"
 #include "UART0.h"
 #include "tm4c123gh6pm.h"
+#include "FastMath.h"
+#include "EEPROM.h"
 #include <stdio.h>
 #include <math.h>
 
@@ -26,40 +28,129 @@
 #define GYRO_LSB_2_VALUE		(32.8)
 #define GYRO_LSB_3_VALUE		(16.4)
 
+/*
+Q16.16 conversion: out = (raw * MULT + rounding) >> SHIFT with
+MULT = 2^(16 + SHIFT) / LSB_VALUE. MULT stays below 2^16 so the
+product of a 16-bit sample always fits in int32
+*/
+#define ACCEL_Q16_MULT_0		(4)					// 2^16 / 16384
+#define ACCEL_Q16_MULT_1		(8)					// 2^16 / 8192
+#define ACCEL_Q16_MULT_2		(16)				// 2^16 / 4096
+#define ACCEL_Q16_MULT_3		(32)				// 2^16 / 2048
+#define ACCEL_Q16_SHIFT			(0)
+
+#define GYRO_Q16_MULT_0			(64035)			// 2^23 / 131
+#define GYRO_Q16_SHIFT_0		(7)
+#define GYRO_Q16_MULT_1			(64035)			// 2^22 / 65.5
+#define GYRO_Q16_SHIFT_1		(6)
+#define GYRO_Q16_MULT_2			(63938)			// 2^21 / 32.8
+#define GYRO_Q16_SHIFT_2		(5)
+#define GYRO_Q16_MULT_3			(63938)			// 2^20 / 16.4
+#define GYRO_Q16_SHIFT_3		(4)
+
+#define MPU6050_Q16_SCALE(raw, mult, shift)		((((int32_t)(raw) * (mult)) + ((1L << (shift)) >> 1)) >> (shift))
+
+/* Profile Register Values: SMPLRT_DIV, CONFIG, GYRO_CONFIG, ACCEL_CONFIG */
+static const uint8_t MPU6050_Profile[MPU6050_PROFILE_COUNT][MPU6050_PROFILE_REGS] = {
+	{SMPLRT_DIV_8, CONFIG_DFPL_0, GYRO_FS_SEL_0, ACCEL_AFS_SEL_0},		// Low latency
+	{SMPLRT_DIV_5, CONFIG_DFPL_3, GYRO_FS_SEL_0, ACCEL_AFS_SEL_0},		// Low noise
+	{SMPLRT_DIV_8, CONFIG_DFPL_0, GYRO_FS_SEL_3, ACCEL_AFS_SEL_3}		// High dynamics
+};
+
+/* Device wired to the data-ready pin, set by MPU6050_DRDY_Init */
+static MPU6050_t* DRDY_Dev;
+
+/*
+ *	---------------MPU6050_Resolve_Scale---------------
+ *	Local function to pick the LSB sensitivity for a range setting
+ *	Input: Device Handle, Register Address (ACCEL_CONFIG or GYRO_CONFIG), Register Value
+ * 	Output: none
+ */
+static void MPU6050_Resolve_Scale(MPU6050_t* dev, uint8_t reg, uint8_t value){
+	
+	if(reg == ACCEL_CONFIG){
+		switch(value & MPU6050_FS_SEL_MSK){
+			case ACCEL_AFS_SEL_0:	dev->Accel_Q16_Mult = ACCEL_Q16_MULT_0;	break;
+			case ACCEL_AFS_SEL_1:	dev->Accel_Q16_Mult = ACCEL_Q16_MULT_1;	break;
+			case ACCEL_AFS_SEL_2:	dev->Accel_Q16_Mult = ACCEL_Q16_MULT_2;	break;
+			case ACCEL_AFS_SEL_3:	dev->Accel_Q16_Mult = ACCEL_Q16_MULT_3;	break;
+		}
+	}
+	else if(reg == GYRO_CONFIG){
+		switch(value & MPU6050_FS_SEL_MSK){
+			case GYRO_FS_SEL_0:		dev->Gyro_Q16_Mult = GYRO_Q16_MULT_0;	dev->Gyro_Q16_Shift = GYRO_Q16_SHIFT_0;	break;
+			case GYRO_FS_SEL_1:		dev->Gyro_Q16_Mult = GYRO_Q16_MULT_1;	dev->Gyro_Q16_Shift = GYRO_Q16_SHIFT_1;	break;
+			case GYRO_FS_SEL_2:		dev->Gyro_Q16_Mult = GYRO_Q16_MULT_2;	dev->Gyro_Q16_Shift = GYRO_Q16_SHIFT_2;	break;
+			case GYRO_FS_SEL_3:		dev->Gyro_Q16_Mult = GYRO_Q16_MULT_3;	dev->Gyro_Q16_Shift = GYRO_Q16_SHIFT_3;	break;
+		}
+	}
+}
+
 /*
  *	-------------------MPU6050_Init---------------------
  *	Basic Initialization Function for MPU6050 @ default settings
- *	Input: none
- * 	Output: none
+ *	Input: Device Handle, Bus the MPU6050 is attached to (must
+ *				 already be initialized), 7-bit Address
+ * 	Output: MPU6050_NOT_FOUND if WHO_AM_I did not match, otherwise 0
  */
-void MPU6050_Init(void){
+uint8_t MPU6050_Init(MPU6050_t* dev, I2C_BUS_t* bus, uint8_t addr){
 	
 	uint8_t ret;
 	uint8_t who_am_i_val;
+	uint8_t k;
 	char stringBuf[20]; // Increased buffer size slightly
 	
+	dev->Bus = bus;
+	dev->Addr = addr;
+	dev->Timestamp = 0;
+	
+	dev->Shadow.bus = bus;
+	dev->Shadow.slave_addr = addr;
+	dev->Shadow.cmd = 0;
+	dev->Shadow.base_reg = MPU6050_SHADOW_BASE;
+	dev->Shadow.size = MPU6050_SHADOW_SIZE;
+	dev->Shadow.value = dev->Shadow_Value;
+	dev->Shadow.valid = dev->Shadow_Valid;
+	I2C_Shadow_Invalidate(&dev->Shadow);
+	
+	dev->Accel_Q16_Mult = ACCEL_Q16_MULT_0;
+	dev->Gyro_Q16_Mult = GYRO_Q16_MULT_0;
+	dev->Gyro_Q16_Shift = GYRO_Q16_SHIFT_0;
+	for(k = 0; k < 3; k++){
+		dev->Accel_Offset_Q16[k] = 0;
+		dev->Gyro_Offset_Q16[k] = 0;
+		dev->Gyro_Slope_Q16[k] = 0;
+		dev->Thermal.Sy[k] = 0.0f;
+		dev->Thermal.Sxy[k] = 0.0f;
+	}
+	dev->Temp_Ref_RAW = 0;
+	dev->Temp_RAW = 0;
+	dev->Bias_Stale = 1;
+	dev->Thermal.Block_Count = 0;
+	dev->Thermal.N = 0.0f;
+	dev->Thermal.Sx = 0.0f;
+	dev->Thermal.Sxx = 0.0f;
+	dev->Angle_Mode = MPU6050_ANGLE_FAST;
+	dev->Aux_Slots = 0;
+	dev->Aux_Len = 0;
+	dev->Idle = 0;
+	dev->Motion = 0;
+	
+	dev->DRDY_Xfer.status = I2C_XFER_IDLE;
+	dev->DRDY_Edges = 0;
+	dev->DRDY_Ready = 0;
+	dev->DRDY_Callback = 0;
+	
 	// Check the WHO_AM_I register to confirm identity
-	#ifndef USE_HIGH
-	who_am_i_val = I2C0_Receive(MPU6050_ADDR_AD0_LOW, WHO_AM_I);
+	who_am_i_val = I2C_Receive(dev->Bus, dev->Addr, WHO_AM_I);
 	if(who_am_i_val != MPU6050_WHO_AM_I_CONST){
 		UART0_OutString("MPU6050 WHO_AM_I check failed! Read: 0x");
 		UART0_OutUHex(who_am_i_val);
 		UART0_OutString(", Expected: 0x");
 		UART0_OutUHex(MPU6050_WHO_AM_I_CONST);
 		UART0_OutString("\r\n");
-		return;
+		return MPU6050_NOT_FOUND;
 	}
-	#else
-	who_am_i_val = I2C0_Receive(MPU6050_ADDR_AD0_HIGH, WHO_AM_I);
-	if(who_am_i_val != MPU6050_WHO_AM_I_CONST){
-		UART0_OutString("MPU6050 WHO_AM_I check failed! Read: 0x");
-		UART0_OutUHex(who_am_i_val);
-		UART0_OutString(", Expected: 0x");
-		UART0_OutUHex(MPU6050_WHO_AM_I_CONST);
-		UART0_OutString("\r\n");
-		return;
-	}
-	#endif
 	
 	//Print ID out to terminal
 	sprintf(stringBuf, "WHO_AM_I: 0x%02X\r\n", who_am_i_val);
@@ -69,215 +160,1093 @@ void MPU6050_Init(void){
 	UART0_OutString("MPU6050 is initializing\r\n");
 	
 	/* Reset the MPU6050 Module */
-	ret = I2C0_Transmit(MPU6050_ADDR_AD0_LOW, PWR_MGMT_1, PWR_DEVICE_RESET);
+	ret = I2C_Transmit(dev->Bus, dev->Addr, PWR_MGMT_1, PWR_DEVICE_RESET);
+	I2C_Shadow_Invalidate(&dev->Shadow);		// Every register is back to default
 	UART0_OutString("Reset MPU6050\r\n");
 	
 	/* 0 to wake up sensor */
-	ret = I2C0_Transmit(MPU6050_ADDR_AD0_LOW, PWR_MGMT_1, PWR_CLK_SEL_INTERNAL);
+	ret = MPU6050_Write_Reg(dev, PWR_MGMT_1, PWR_CLK_SEL_INTERNAL);
 	if(ret != 0)
 		UART0_OutString("Error On Transmit\r\n");
 	else
 		UART0_OutString("Sensor is awake\r\n");
 	
-	/* Set Data Rate to 1kHz */
-	ret = I2C0_Transmit(MPU6050_ADDR_AD0_LOW, SMPLRT_DIV, SMPLRT_DIV_8);
-	if(ret != 0)
-		UART0_OutString("Error On Transmit\r\n");
-	else
-		UART0_OutString("Data Rate is 1kHz\r\n");
-	
-	/* Default Configuration */
-	ret = I2C0_Transmit(MPU6050_ADDR_AD0_LOW, CONFIG, CONFIG_DFPL_0);
-	if(ret != 0)
-		UART0_OutString("Error On Transmit\r\n");
-	else
-		UART0_OutString("Default Configuration\r\n");
-	
-	/* Default config for Accelerometer */
-	ret = I2C0_Transmit(MPU6050_ADDR_AD0_LOW, ACCEL_CONFIG, ACCEL_AFS_SEL_0);
+	/* 1kHz, DLPF off, +/-2g, +/-250 deg/s in one burst */
+	ret = MPU6050_Set_Profile(dev, MPU6050_PROFILE_LOW_LATENCY);
 	if(ret != 0)
 		UART0_OutString("Error On Transmit\r\n");
 	else
-		UART0_OutString("Default Accelerometer Configuration\r\n");
-	
-	/* Default config for Gyroscope */
-	ret = I2C0_Transmit(MPU6050_ADDR_AD0_LOW, GYRO_CONFIG, GYRO_FS_SEL_0);
-	if(ret != 0)
-		UART0_OutString("Error On Transmit\r\n");
-	else
-		UART0_OutString("Default Gyroscope Configuration\r\n");
+		UART0_OutString("Low Latency Profile (1kHz, DLPF off, +/-2g, +/-250dps)\r\n");
 	
 	UART0_OutString("MPU6050 Initialized\r\n");
+	
+	return 0;
 }
 
 /*
  *	-----------------MPU6050_Get_Accel------------------
  *	Receive Raw Accelerometer Data and store it in the user struct
- *	Input: MPU6050 Accel User Instance Struct
+ *	Input: Device Handle, MPU6050 Accel User Instance Struct
  * 	Output: none
  */
-void MPU6050_Get_Accel(MPU6050_ACCEL_t* Accel_Instance){
+void MPU6050_Get_Accel(MPU6050_t* dev, MPU6050_ACCEL_t* Accel_Instance){
 	
 	/* Local Variables */
-	uint8_t ACCEL_X_LOW;
-	uint8_t ACCEL_X_HIGH;
-	uint8_t ACCEL_Y_LOW;
-	uint8_t ACCEL_Y_HIGH;
-	uint8_t ACCEL_Z_LOW;
-	uint8_t ACCEL_Z_HIGH;
-	uint8_t MPU_ADDR = MPU6050_ADDR_AD0_LOW; // Default address
-	#ifdef USE_HIGH
-		MPU_ADDR = MPU6050_ADDR_AD0_HIGH;
-	#endif
-	
-	/* Grab 16-bit Accel data of each axis by reading ACCEL data register using I2C*/
-	// It's generally more efficient to do a burst read if the I2C function supports it.
-	// Assuming I2C0_Receive only reads one byte at a time:
-	ACCEL_X_HIGH = I2C0_Receive(MPU_ADDR, ACCEL_XOUT_H);
-	ACCEL_X_LOW  = I2C0_Receive(MPU_ADDR, ACCEL_XOUT_L);
-	ACCEL_Y_HIGH = I2C0_Receive(MPU_ADDR, ACCEL_YOUT_H);
-	ACCEL_Y_LOW  = I2C0_Receive(MPU_ADDR, ACCEL_YOUT_L);
-	ACCEL_Z_HIGH = I2C0_Receive(MPU_ADDR, ACCEL_ZOUT_H);
-	ACCEL_Z_LOW  = I2C0_Receive(MPU_ADDR, ACCEL_ZOUT_L);
+	uint8_t ACCEL_DATA[MPU6050_AXIS_BURST_SIZE];
+	
+	/* Grab 16-bit Accel data of each axis in one burst starting at ACCEL_XOUT_H */
+	if(I2C_Burst_Receive(dev->Bus, dev->Addr, ACCEL_XOUT_H, ACCEL_DATA, sizeof(ACCEL_DATA)) != 0)
+		return;
 	
 	/* Concatanate and Save Into Accelerometer Struct Instance */
-	// Combine HIGH and LOW bytes. Cast HIGH byte to int16_t first to ensure sign extension.
-	Accel_Instance->Ax_RAW = (int16_t)(ACCEL_X_HIGH << 8 | ACCEL_X_LOW);
-	Accel_Instance->Ay_RAW = (int16_t)(ACCEL_Y_HIGH << 8 | ACCEL_Y_LOW);
-	Accel_Instance->Az_RAW = (int16_t)(ACCEL_Z_HIGH << 8 | ACCEL_Z_LOW);
+	// Combine HIGH and LOW bytes. Cast to int16_t to ensure sign extension.
+	Accel_Instance->Ax_RAW = (int16_t)(ACCEL_DATA[0] << 8 | ACCEL_DATA[1]);
+	Accel_Instance->Ay_RAW = (int16_t)(ACCEL_DATA[2] << 8 | ACCEL_DATA[3]);
+	Accel_Instance->Az_RAW = (int16_t)(ACCEL_DATA[4] << 8 | ACCEL_DATA[5]);
 	
 }
 
 /*
  *	-----------------MPU6050_Get_Gyro-------------------
  *	Receive Raw Gyroscope Data and store it in the user struct
- *	Input: MPU6050 Gyro User Instance Struct
+ *	Input: Device Handle, MPU6050 Gyro User Instance Struct
  * 	Output: none
  */
-void MPU6050_Get_Gyro(MPU6050_GYRO_t* Gyro_Instance){
+void MPU6050_Get_Gyro(MPU6050_t* dev, MPU6050_GYRO_t* Gyro_Instance){
 		
 	/* Local Variables */
-	uint8_t GYRO_X_LOW;
-	uint8_t GYRO_X_HIGH;
-	uint8_t GYRO_Y_LOW;
-	uint8_t GYRO_Y_HIGH;
-	uint8_t GYRO_Z_LOW;
-	uint8_t GYRO_Z_HIGH;
-	uint8_t MPU_ADDR = MPU6050_ADDR_AD0_LOW; // Default address
-	#ifdef USE_HIGH
-		MPU_ADDR = MPU6050_ADDR_AD0_HIGH;
-	#endif
-	
-	/* Grab 16-but Gyro Data of each Axis y reading GYRO data register using I2C*/
-	// Assuming I2C0_Receive only reads one byte at a time:
-	GYRO_X_HIGH = I2C0_Receive(MPU_ADDR, GYRO_XOUT_H);
-	GYRO_X_LOW  = I2C0_Receive(MPU_ADDR, GYRO_XOUT_L);
-	GYRO_Y_HIGH = I2C0_Receive(MPU_ADDR, GYRO_YOUT_H);
-	GYRO_Y_LOW  = I2C0_Receive(MPU_ADDR, GYRO_YOUT_L);
-	GYRO_Z_HIGH = I2C0_Receive(MPU_ADDR, GYRO_ZOUT_H);
-	GYRO_Z_LOW  = I2C0_Receive(MPU_ADDR, GYRO_ZOUT_L);
+	uint8_t GYRO_DATA[MPU6050_AXIS_BURST_SIZE];
+	
+	/* Grab 16-bit Gyro data of each axis in one burst starting at GYRO_XOUT_H */
+	if(I2C_Burst_Receive(dev->Bus, dev->Addr, GYRO_XOUT_H, GYRO_DATA, sizeof(GYRO_DATA)) != 0)
+		return;
 	
 	/* Concatanate and Save Into Gyro Struct Instance */
-	// Combine HIGH and LOW bytes. Cast HIGH byte to int16_t first to ensure sign extension.
-	Gyro_Instance->Gx_RAW = (int16_t)(GYRO_X_HIGH << 8 | GYRO_X_LOW);
-	Gyro_Instance->Gy_RAW = (int16_t)(GYRO_Y_HIGH << 8 | GYRO_Y_LOW);
-	Gyro_Instance->Gz_RAW = (int16_t)(GYRO_Z_HIGH << 8 | GYRO_Z_LOW);
+	// Combine HIGH and LOW bytes. Cast to int16_t to ensure sign extension.
+	Gyro_Instance->Gx_RAW = (int16_t)(GYRO_DATA[0] << 8 | GYRO_DATA[1]);
+	Gyro_Instance->Gy_RAW = (int16_t)(GYRO_DATA[2] << 8 | GYRO_DATA[3]);
+	Gyro_Instance->Gz_RAW = (int16_t)(GYRO_DATA[4] << 8 | GYRO_DATA[5]);
 }
 
 /*
- *	---------------MPU6050_Process_Accel----------------
- *	Process Raw Accelerometer Data into usable data and store
- *	it in the user stuct
- *	Input: MPU6050 Accel User Instance Struct
+ *	---------------MPU6050_Parse_Sample----------------
+ *	Local function to split a 14-byte ACCEL_XOUT_H .. GYRO_ZOUT_L
+ *	block into the raw fields
+ *	Input: Sample Block, Accel and Gyro Structs, Temperature (NULL if not needed)
  * 	Output: none
  */
-void MPU6050_Process_Accel(MPU6050_ACCEL_t* Accel_Instance){
+static void MPU6050_Parse_Sample(uint8_t* SAMPLE_DATA, MPU6050_ACCEL_t* Accel_Instance, MPU6050_GYRO_t* Gyro_Instance, int16_t* Temp_RAW){
 	
-	char LSB_Sensitivity;
+	/* Accelerometer: bytes 0-5 */
+	Accel_Instance->Ax_RAW = (int16_t)(SAMPLE_DATA[0] << 8 | SAMPLE_DATA[1]);
+	Accel_Instance->Ay_RAW = (int16_t)(SAMPLE_DATA[2] << 8 | SAMPLE_DATA[3]);
+	Accel_Instance->Az_RAW = (int16_t)(SAMPLE_DATA[4] << 8 | SAMPLE_DATA[5]);
 	
-	//Read LSB Sensitivity Setting from ACCEL_CONFIG Register
-	#ifndef USE_HIGH
-		LSB_Sensitivity = I2C0_Receive(MPU6050_ADDR_AD0_LOW, ACCEL_CONFIG);
-	#else
-		LSB_Sensitivity = I2C0_Receive(MPU6050_ADDR_AD0_HIGH, ACCEL_CONFIG);
-	#endif
+	/* Temperature: bytes 6-7 */
+	if(Temp_RAW)
+		*Temp_RAW = (int16_t)(SAMPLE_DATA[6] << 8 | SAMPLE_DATA[7]);
 	
-	//Based on setting, process raw data accordingly
-	switch(LSB_Sensitivity){
-		case ACCEL_AFS_SEL_0:
-			Accel_Instance->Ax = (float)Accel_Instance->Ax_RAW / ACCEL_LSB_0_VALUE;
-			Accel_Instance->Ay = (float)Accel_Instance->Ay_RAW / ACCEL_LSB_0_VALUE;
-			Accel_Instance->Az = (float)Accel_Instance->Az_RAW / ACCEL_LSB_0_VALUE;
-			break;
-		case ACCEL_AFS_SEL_1:
-			Accel_Instance->Ax = (float)Accel_Instance->Ax_RAW / ACCEL_LSB_1_VALUE;
-			Accel_Instance->Ay = (float)Accel_Instance->Ay_RAW / ACCEL_LSB_1_VALUE;
-			Accel_Instance->Az = (float)Accel_Instance->Az_RAW / ACCEL_LSB_1_VALUE;
-			break;
-		case ACCEL_AFS_SEL_2:
-			Accel_Instance->Ax = (float)Accel_Instance->Ax_RAW / ACCEL_LSB_2_VALUE;
-			Accel_Instance->Ay = (float)Accel_Instance->Ay_RAW / ACCEL_LSB_2_VALUE;
-			Accel_Instance->Az = (float)Accel_Instance->Az_RAW / ACCEL_LSB_2_VALUE;
-			break;
-		case ACCEL_AFS_SEL_3:
-			Accel_Instance->Ax = (float)Accel_Instance->Ax_RAW / ACCEL_LSB_3_VALUE;
-			Accel_Instance->Ay = (float)Accel_Instance->Ay_RAW / ACCEL_LSB_3_VALUE;
-			Accel_Instance->Az = (float)Accel_Instance->Az_RAW / ACCEL_LSB_3_VALUE;
-			break;
+	/* Gyroscope: bytes 8-13 */
+	Gyro_Instance->Gx_RAW = (int16_t)(SAMPLE_DATA[8] << 8 | SAMPLE_DATA[9]);
+	Gyro_Instance->Gy_RAW = (int16_t)(SAMPLE_DATA[10] << 8 | SAMPLE_DATA[11]);
+	Gyro_Instance->Gz_RAW = (int16_t)(SAMPLE_DATA[12] << 8 | SAMPLE_DATA[13]);
+}
+
+/*
+ *	-----------------MPU6050_Get_Sample-----------------
+ *	Receive Raw Accelerometer, Temperature and Gyroscope Data in
+ *	a single 14-byte burst so every axis comes from the same sample
+ *	Input: Device Handle, MPU6050 Accel and Gyro User Instance Structs,
+ *				 Raw Temperature destination (NULL if not needed)
+ * 	Output: Any I2C Errors if detected, otherwise 0
+ */
+uint8_t MPU6050_Get_Sample(MPU6050_t* dev, MPU6050_ACCEL_t* Accel_Instance, MPU6050_GYRO_t* Gyro_Instance, int16_t* Temp_RAW){
+	
+	/* Local Variables */
+	uint8_t SAMPLE_DATA[MPU6050_SAMPLE_BURST_SIZE];
+	int16_t temp;
+	uint8_t ret;
+	
+	/* 
+	ACCEL_XOUT_H .. GYRO_ZOUT_L are contiguous, the MPU6050 latches the whole
+	block at the start of the burst so all axes belong to one sample
+	*/
+	dev->Timestamp = CYCCNT_Read();
+	ret = I2C_Burst_Receive(dev->Bus, dev->Addr, ACCEL_XOUT_H, SAMPLE_DATA, sizeof(SAMPLE_DATA));
+	if(ret != 0)
+		return ret;
+	
+	MPU6050_Parse_Sample(SAMPLE_DATA, Accel_Instance, Gyro_Instance, &temp);
+	dev->Temp_RAW = temp;
+	if(Temp_RAW)
+		*Temp_RAW = temp;
+	
+	return 0;
+}
+
+/*
+ *	-----------------MPU6050_Copy_Ext------------------
+ *	Local function to move the EXT_SENS_DATA tail of a burst into a sample
+ *	Input: Sample, Bytes following GYRO_ZOUT_L, Byte count
+ * 	Output: none
+ */
+static void MPU6050_Copy_Ext(MPU6050_SAMPLE_t* sample, uint8_t* ext, uint32_t len){
+	uint32_t i;
+	
+	for(i = 0; i < len; i++)
+		sample->Ext[i] = ext[i];
+	sample->Ext_Len = (uint8_t)len;
+}
+
+/*
+ *	---------------MPU6050_Get_Sample_Ext--------------
+ *	Read accel, temperature, gyro and every auxiliary slave's data
+ *	in one burst (polled). The timestamp is the CYCCNT at the read
+ *	Input: Device Handle, Sample destination
+ * 	Output: Any I2C Errors if detected, otherwise 0
+ */
+uint8_t MPU6050_Get_Sample_Ext(MPU6050_t* dev, MPU6050_SAMPLE_t* sample){
+	uint8_t SAMPLE_DATA[MPU6050_SAMPLE_BURST_SIZE + MPU6050_EXT_SENS_MAX];
+	uint8_t len = dev->Aux_Len;
+	uint8_t ret;
+	
+	dev->Timestamp = CYCCNT_Read();
+	sample->Timestamp = dev->Timestamp;
+	ret = I2C_Burst_Receive(dev->Bus, dev->Addr, ACCEL_XOUT_H, SAMPLE_DATA, MPU6050_SAMPLE_BURST_SIZE + len);
+	if(ret != 0)
+		return ret;
+	
+	MPU6050_Parse_Sample(SAMPLE_DATA, &sample->Accel, &sample->Gyro, &sample->Temp_RAW);
+	dev->Temp_RAW = sample->Temp_RAW;
+	MPU6050_Copy_Ext(sample, &SAMPLE_DATA[MPU6050_SAMPLE_BURST_SIZE], len);
+	
+	return 0;
+}
+
+/*
+ *	------------------MPU6050_Aux_Init-----------------
+ *	Enable the MPU6050's own I2C master (400kHz) with no slaves.
+ *	Data ready waits for the slaves and EXT_SENS_DATA is shadowed,
+ *	so IMU and auxiliary data always come from the same sample
+ *	Input: Device Handle
+ * 	Output: Any I2C Errors if detected, otherwise 0
+ */
+uint8_t MPU6050_Aux_Init(MPU6050_t* dev){
+	uint8_t ret;
+	uint8_t slot;
+	
+	/* The auxiliary bus is driven by the MPU6050, not passed through to the host */
+	ret = MPU6050_Write_Reg(dev, INT_PIN_CFG, MPU6050_Config_Reg(dev, INT_PIN_CFG) & ~INT_PIN_I2C_BYPASS_EN);
+	
+	for(slot = 0; (slot < MPU6050_AUX_SLOTS) && (ret == 0); slot++)
+		ret = MPU6050_Write_Reg(dev, I2C_SLV0_CTRL + slot * MPU6050_SLV_REG_STRIDE, 0);
+	
+	if(ret == 0)
+		ret = MPU6050_Write_Reg(dev, I2C_MST_CTRL, I2C_MST_WAIT_FOR_ES | I2C_MST_CLK_400);
+	if(ret == 0)
+		ret = MPU6050_Write_Reg(dev, I2C_MST_DELAY_CTRL, I2C_MST_DELAY_ES_SHADOW);
+	if(ret == 0)
+		ret = MPU6050_Write_Reg(dev, USER_CTRL, MPU6050_Config_Reg(dev, USER_CTRL) | USER_CTRL_I2C_MST_EN);
+	
+	dev->Aux_Slots = 0;
+	dev->Aux_Len = 0;
+	
+	return ret;
+}
+
+/*
+ *	---------------MPU6050_Aux_Add_Slave---------------
+ *	Have the MPU6050 read a block from an auxiliary device every
+ *	sample. Slaves fill EXT_SENS_DATA in the order they are added
+ *	Input: Device Handle, 7-bit Address, First Register, Length (1-15),
+ *				 Offset of the data in MPU6050_SAMPLE_t.Ext (out)
+ * 	Output: Any I2C Errors, 1 if out of slots or bytes, otherwise 0
+ */
+uint8_t MPU6050_Aux_Add_Slave(MPU6050_t* dev, uint8_t slave_addr, uint8_t reg, uint8_t len, uint8_t* offset){
+	uint8_t data[MPU6050_SLV_REG_STRIDE];
+	uint8_t ret;
+	
+	/* Asserting Param */
+	if((dev->Aux_Slots == MPU6050_AUX_SLOTS) || (len == 0) || (len > I2C_SLV_LEN_MSK) || ((dev->Aux_Len + len) > MPU6050_EXT_SENS_MAX))
+		return 1;
+	
+	/* I2C_SLVx_ADDR, I2C_SLVx_REG, I2C_SLVx_CTRL in one burst */
+	data[0] = I2C_SLV_RNW | slave_addr;
+	data[1] = reg;
+	data[2] = I2C_SLV_EN | len;
+	ret = I2C_Shadow_Burst_Write(&dev->Shadow, I2C_SLV0_ADDR + dev->Aux_Slots * MPU6050_SLV_REG_STRIDE, data, sizeof(data));
+	if(ret != 0)
+		return ret;
+	
+	*offset = dev->Aux_Len;
+	dev->Aux_Slots++;
+	dev->Aux_Len += len;
+	
+	return 0;
+}
+
+/*
+ *	-----------------MPU6050_Aux_Write-----------------
+ *	Write one register of an auxiliary device through SLV4, used to
+ *	configure it (e.g. put a magnetometer in continuous mode)
+ *	Input: Device Handle, 7-bit Address, Register, Data
+ * 	Output: Any I2C Errors, MPU6050_AUX_NACK, otherwise 0
+ */
+uint8_t MPU6050_Aux_Write(MPU6050_t* dev, uint8_t slave_addr, uint8_t reg, uint8_t data){
+	uint8_t SLV4_DATA[3];
+	uint8_t status;
+	uint8_t n;
+	uint8_t ret;
+	
+	/* I2C_SLV4_ADDR, I2C_SLV4_REG, I2C_SLV4_DO */
+	SLV4_DATA[0] = slave_addr;
+	SLV4_DATA[1] = reg;
+	SLV4_DATA[2] = data;
+	ret = I2C_Burst_Transmit(dev->Bus, dev->Addr, I2C_SLV4_ADDR, SLV4_DATA, sizeof(SLV4_DATA));
+	if(ret != 0)
+		return ret;
+	
+	//SLV4_EN clears itself once the transfer is done, kept out of the shadow cache
+	ret = I2C_Transmit(dev->Bus, dev->Addr, I2C_SLV4_CTRL, I2C_SLV_EN);
+	if(ret != 0)
+		return ret;
+	
+	/* The auxiliary master runs the write on its next sample slot */
+	for(n = 0; n < MPU6050_AUX_POLL_MAX; n++){
+		ret = I2C_Burst_Receive(dev->Bus, dev->Addr, I2C_MST_STATUS, &status, 1);
+		if(ret != 0)
+			return ret;
+		if(status & I2C_MST_SLV4_NACK)
+			return MPU6050_AUX_NACK;
+		if(status & I2C_MST_SLV4_DONE)
+			return 0;
 	}
+	
+	return MPU6050_AUX_NACK;
 }
 
 /*
- *	---------------MPU6050_Process_Gyro----------------
- *	Process Raw Gyroscope Data into usable data and store it in
- *	the user struct
- *	Input: MPU6050 Gyro User Instance Struct
+ *	-----------------MPU6050_DRDY_Done-----------------
+ *	Local completion callback of the data-ready read (I2C handler context)
+ *	Input: Finished Descriptor
  * 	Output: none
  */
-void MPU6050_Process_Gyro(MPU6050_GYRO_t* Gyro_Instance){
+static void MPU6050_DRDY_Done(I2C_XFER_t* xfer){
+	MPU6050_t* dev = (MPU6050_t*)xfer->context;
 	
-	char LSB_Sensitivity;
+	//A failed read is dropped, the Seq gap tells the reader
+	if(xfer->status != I2C_XFER_DONE)
+		return;
 	
-	//Read LSB Sensitivity Setting from GYRO_CONFIG Register
-	#ifndef USE_HIGH
-		LSB_Sensitivity = I2C0_Receive(MPU6050_ADDR_AD0_LOW, ACCEL_CONFIG);
-	#else
-		LSB_Sensitivity = I2C0_Receive(MPU6050_ADDR_AD0_HIGH, ACCEL_CONFIG);
-	#endif
+	MPU6050_Parse_Sample(dev->DRDY_Data, &dev->DRDY_Latest.Accel, &dev->DRDY_Latest.Gyro, &dev->DRDY_Latest.Temp_RAW);
+	MPU6050_Copy_Ext(&dev->DRDY_Latest, &dev->DRDY_Data[MPU6050_SAMPLE_BURST_SIZE], xfer->size - MPU6050_SAMPLE_BURST_SIZE);
+	dev->DRDY_Latest.Timestamp = dev->DRDY_Edge_Time;
+	dev->DRDY_Latest.Seq = dev->DRDY_Edge_Seq;
+	dev->Timestamp = dev->DRDY_Edge_Time;
+	dev->Temp_RAW = dev->DRDY_Latest.Temp_RAW;
+	dev->DRDY_Ready = 1;
 	
-	//Based on setting, process raw data accordingly
-	switch(LSB_Sensitivity){
-		case GYRO_FS_SEL_0:
-			Gyro_Instance->Gx = (float)Gyro_Instance->Gx_RAW / GYRO_LSB_0_VALUE;
-			Gyro_Instance->Gy = (float)Gyro_Instance->Gy_RAW / GYRO_LSB_0_VALUE;
-			Gyro_Instance->Gz = (float)Gyro_Instance->Gz_RAW / GYRO_LSB_0_VALUE;
-			break;
-		case GYRO_FS_SEL_1:
-			Gyro_Instance->Gx = (float)Gyro_Instance->Gx_RAW / GYRO_LSB_1_VALUE;
-			Gyro_Instance->Gy = (float)Gyro_Instance->Gy_RAW / GYRO_LSB_1_VALUE;
-			Gyro_Instance->Gz = (float)Gyro_Instance->Gz_RAW / GYRO_LSB_1_VALUE;
-			break;
-		case GYRO_FS_SEL_2:
-			Gyro_Instance->Gx = (float)Gyro_Instance->Gx_RAW / GYRO_LSB_2_VALUE;
-			Gyro_Instance->Gy = (float)Gyro_Instance->Gy_RAW / GYRO_LSB_2_VALUE;
-			Gyro_Instance->Gz = (float)Gyro_Instance->Gz_RAW / GYRO_LSB_2_VALUE;
+	if(dev->DRDY_Callback)
+		dev->DRDY_Callback(&dev->DRDY_Latest);
+}
+
+/*
+ *	-----------------GPIOPortE_Handler-----------------
+ *	MPU6050 INT rising edge: timestamp first, then queue the sample
+ *	read at real-time priority. If the previous read is still on the
+ *	bus this sample is skipped
+ *	Input: none
+ * 	Output: none
+ */
+void GPIOPortE_Handler(void){
+	uint32_t now = CYCCNT_Read();
+	MPU6050_t* dev = DRDY_Dev;
+	
+	GPIO_PORTE_ICR_R = MPU6050_INT_PIN;
+	if(dev == 0)
+		return;
+	
+	/* While idle the only interrupt source is motion */
+	if(dev->Idle){
+		dev->Motion = 1;
+		return;
+	}
+	dev->DRDY_Edges++;
+	
+	if((dev->DRDY_Xfer.status == I2C_XFER_PENDING) || (dev->DRDY_Xfer.status == I2C_XFER_ACTIVE))
+		return;
+	
+	dev->DRDY_Edge_Time = now;
+	dev->DRDY_Edge_Seq = dev->DRDY_Edges;
+	dev->DRDY_Xfer.priority = I2C_PRIO_REALTIME;
+	dev->DRDY_Xfer.context = dev;
+	I2C_Async_Receive(dev->Bus, &dev->DRDY_Xfer, dev->Addr, ACCEL_XOUT_H, dev->DRDY_Data, MPU6050_SAMPLE_BURST_SIZE + dev->Aux_Len, MPU6050_DRDY_Done);
+}
+
+/*
+ *	-----------------MPU6050_DRDY_Init-----------------
+ *	Enable the data-ready interrupt and arm PE1 for the INT line
+ *	(one device owns PE1, a second MPU6050 is read with Get_Sample).
+ *	Every edge is timestamped and starts an asynchronous 14-byte
+ *	sample read, so acquisition runs at the sensor's sample rate
+ *	with no polling. At 1kHz the bus must run in Fast-mode (a sample
+ *	read takes ~1.6ms at 100kHz and every other edge is skipped)
+ *	Input: Device Handle
+ * 	Output: Any I2C Errors if detected, otherwise 0
+ */
+uint8_t MPU6050_DRDY_Init(MPU6050_t* dev){
+	uint8_t ret;
+	
+	/* Active high push-pull 50us pulse, nothing to acknowledge per sample */
+	ret = MPU6050_Write_Reg(dev, INT_PIN_CFG, 0);
+	if(ret != 0)
+		return ret;
+	
+	DRDY_Dev = dev;
+	
+	/* PE1 input with pull-down, rising edge interrupt */
+	SYSCTL_RCGCGPIO_R |= SYSCTL_RCGCGPIO_R4;
+	while((SYSCTL_PRGPIO_R & SYSCTL_PRGPIO_R4) == 0){};
+	
+	GPIO_PORTE_DIR_R 		&= ~MPU6050_INT_PIN;														// PE1 Input
+	GPIO_PORTE_AFSEL_R 	&= ~MPU6050_INT_PIN;														// no alternate function
+	GPIO_PORTE_AMSEL_R 	&= ~MPU6050_INT_PIN;														// disable analog function
+	GPIO_PORTE_PCTL_R 	&= ~MPU6050_INT_PCTL_MSK;												// GPIO clear bit PCTL
+	GPIO_PORTE_PDR_R 		|= MPU6050_INT_PIN;															// pull-down keeps an unconnected line quiet
+	GPIO_PORTE_DEN_R 		|= MPU6050_INT_PIN;															// enable digital pin PE1
+	
+	GPIO_PORTE_IS_R 		&= ~MPU6050_INT_PIN;														// edge sensitive
+	GPIO_PORTE_IBE_R 		&= ~MPU6050_INT_PIN;														// single edge
+	GPIO_PORTE_IEV_R 		|= MPU6050_INT_PIN;															// rising edge
+	GPIO_PORTE_ICR_R 		 = MPU6050_INT_PIN;															// clear interrupt flag
+	GPIO_PORTE_IM_R 		|= MPU6050_INT_PIN;															// arm interrupt on PE1
+	
+	NVIC_PRI1_R 				 = (NVIC_PRI1_R & 0xFFFFFF1F) | (MPU6050_INT_PRIORITY << 5);
+	NVIC_EN0_R 					|= (1UL << MPU6050_INT_IRQ_NUM);								// enable interrupt 4 in NVIC
+	
+	/* Start generating edges last */
+	return MPU6050_Write_Reg(dev, INT_ENABLE, INT_EN_DATA_RDY);
+}
+
+/*
+ *	--------------MPU6050_DRDY_Set_Callback------------
+ *	Hand every data-ready sample to a consumer as soon as it is read,
+ *	for streams that cannot afford to miss one between DRDY_Get calls.
+ *	The callback runs in the I2C interrupt and must be short
+ *	Input: Device Handle, Callback (0 to remove)
+ * 	Output: none
+ */
+void MPU6050_DRDY_Set_Callback(MPU6050_t* dev, void (*callback)(MPU6050_SAMPLE_t* sample)){
+	dev->DRDY_Callback = callback;
+}
+
+/*
+ *	-----------------MPU6050_DRDY_Get------------------
+ *	Take the newest data-ready sample if one arrived since the last call
+ *	Input: Device Handle, Sample destination
+ * 	Output: 1 if a new sample was copied, otherwise 0
+ */
+uint8_t MPU6050_DRDY_Get(MPU6050_t* dev, MPU6050_SAMPLE_t* sample){
+	long sr;
+	
+	if(!dev->DRDY_Ready)
+		return 0;
+	
+	sr = StartCritical();
+	*sample = dev->DRDY_Latest;
+	dev->DRDY_Ready = 0;
+	EndCritical(sr);
+	
+	return 1;
+}
+
+/*
+ *	-----------------MPU6050_DRDY_Wait-----------------
+ *	Sleep until the next data-ready sample arrives and take it
+ *	Input: Device Handle, Sample destination
+ * 	Output: none
+ */
+void MPU6050_DRDY_Wait(MPU6050_t* dev, MPU6050_SAMPLE_t* sample){
+	long sr;
+	
+	while(1){
+		/* Check and sleep with interrupts masked so a sample landing in
+			 between cannot be slept through, WFI still wakes on it */
+		sr = StartCritical();
+		if(dev->DRDY_Ready){
+			*sample = dev->DRDY_Latest;
+			dev->DRDY_Ready = 0;
+			EndCritical(sr);
+			return;
+		}
+		WaitForInterrupt();
+		EndCritical(sr);
+	}
+}
+
+/*
+ *	-----------------MPU6050_Idle_Enter----------------
+ *	Put the device into accel-only cycle mode: gyro and temperature
+ *	off, one accel sample per wake-up, and the INT line only pulses
+ *	on motion. Needs MPU6050_DRDY_Init on the same device first
+ *	Input: Device Handle, Threshold (mg), Wake Rate (PWR_2_WAKE_0 .. 3)
+ * 	Output: Any I2C Errors, 1 if the device does not own the INT pin, otherwise 0
+ */
+uint8_t MPU6050_Idle_Enter(MPU6050_t* dev, uint16_t threshold_mg, uint8_t wake){
+	uint32_t thr = threshold_mg / MPU6050_MOT_MG_PER_LSB;
+	uint8_t accel = MPU6050_Config_Reg(dev, ACCEL_CONFIG) & ~ACCEL_HPF_MSK;
+	uint8_t ret;
+	
+	/* Asserting Param */
+	if(DRDY_Dev != dev)
+		return 1;
+	
+	if(thr == 0)
+		thr = 1;
+	if(thr > 0xFF)
+		thr = 0xFF;
+	
+	/* Stop the data-ready edges first, anything after this is motion */
+	ret = MPU6050_Write_Reg(dev, INT_ENABLE, 0);
+	if(ret != 0)
+		return ret;
+	dev->Idle = 1;
+	
+	/* Motion is judged on the high passed accel, let the filter settle then hold it */
+	ret = MPU6050_Write_Reg(dev, ACCEL_CONFIG, accel | ACCEL_HPF_5HZ);
+	if(ret == 0)
+		ret = MPU6050_Write_Reg(dev, MOT_THR, (uint8_t)thr);
+	if(ret == 0)
+		ret = MPU6050_Write_Reg(dev, MOT_DUR, MPU6050_IDLE_DUR_MS);
+	if(ret == 0)
+		ret = MPU6050_Write_Reg(dev, MOT_DETECT_CTRL, MOT_DETECT_ON_DELAY_1 | MOT_DETECT_COUNT_1);
+	if(ret == 0)
+		ret = MPU6050_Write_Reg(dev, INT_ENABLE, INT_EN_MOT);
+	if(ret != 0){
+		dev->Idle = 0;
+		return ret;
+	}
+	
+	DELAY_1MS(MPU6050_IDLE_HPF_SETTLE_MS);
+	ret = MPU6050_Write_Reg(dev, ACCEL_CONFIG, accel | ACCEL_HPF_HOLD);
+	
+	/* Gyro in standby, accel sampled at the wake rate, everything else asleep */
+	if(ret == 0)
+		ret = MPU6050_Write_Reg(dev, PWR_MGMT_2, (wake & PWR_2_WAKE_MSK) | PWR_2_STBY_GYRO);
+	if(ret == 0)
+		ret = MPU6050_Write_Reg(dev, PWR_MGMT_1, PWR_CLK_SEL_INTERNAL | PWR_CYCLE | PWR_TEMP_DIS);
+	
+	/* Edges while the high pass filter settled were not real motion */
+	dev->Motion = 0;
+	
+	return ret;
+}
+
+/*
+ *	-----------------MPU6050_Idle_Exit-----------------
+ *	Leave cycle mode and resume full-rate data-ready streaming
+ *	Input: Device Handle
+ * 	Output: Any I2C Errors if detected, otherwise 0
+ */
+uint8_t MPU6050_Idle_Exit(MPU6050_t* dev){
+	uint8_t ret;
+	
+	ret = MPU6050_Write_Reg(dev, PWR_MGMT_1, PWR_CLK_SEL_INTERNAL);
+	if(ret == 0)
+		ret = MPU6050_Write_Reg(dev, PWR_MGMT_2, 0);
+	if(ret == 0)
+		ret = MPU6050_Write_Reg(dev, ACCEL_CONFIG, MPU6050_Config_Reg(dev, ACCEL_CONFIG) & ~ACCEL_HPF_MSK);
+	if(ret != 0)
+		return ret;
+	
+	/* Back to data-ready edges, the Seq gap covers the idle time */
+	dev->Idle = 0;
+	return MPU6050_Write_Reg(dev, INT_ENABLE, INT_EN_DATA_RDY);
+}
+
+/*
+ *	-----------------MPU6050_Idle_Wait-----------------
+ *	Enter cycle mode, sleep the MCU (WFI) until motion is detected,
+ *	then resume full-rate streaming
+ *	Input: Device Handle, Threshold (mg), Wake Rate (PWR_2_WAKE_0 .. 3)
+ * 	Output: Any I2C Errors, 1 if the device does not own the INT pin, otherwise 0
+ */
+uint8_t MPU6050_Idle_Wait(MPU6050_t* dev, uint16_t threshold_mg, uint8_t wake){
+	uint8_t ret;
+	long sr;
+	
+	ret = MPU6050_Idle_Enter(dev, threshold_mg, wake);
+	if(ret != 0)
+		return ret;
+	
+	/* Same masked check-then-sleep as MPU6050_DRDY_Wait, other interrupts just loop */
+	while(1){
+		sr = StartCritical();
+		if(dev->Motion){
+			EndCritical(sr);
 			break;
-		case GYRO_FS_SEL_3:
-			Gyro_Instance->Gx = (float)Gyro_Instance->Gx_RAW / GYRO_LSB_3_VALUE;
-			Gyro_Instance->Gy = (float)Gyro_Instance->Gy_RAW / GYRO_LSB_3_VALUE;
-			Gyro_Instance->Gz = (float)Gyro_Instance->Gz_RAW / GYRO_LSB_3_VALUE;
+		}
+		WaitForInterrupt();
+		EndCritical(sr);
+	}
+	
+	return MPU6050_Idle_Exit(dev);
+}
+
+/*
+ *	---------------MPU6050_FIFO_Restart----------------
+ *	Local function to empty the FIFO and (re)start it. FIFO_RESET is
+ *	ignored while the FIFO is enabled, so it is stopped first
+ *	Input: Device Handle, 1 to leave the FIFO running, 0 to leave it stopped
+ * 	Output: Any I2C Errors if detected, otherwise 0
+ */
+static uint8_t MPU6050_FIFO_Restart(MPU6050_t* dev, uint8_t run){
+	uint8_t ctrl = MPU6050_Config_Reg(dev, USER_CTRL) & ~(USER_CTRL_FIFO_EN | USER_CTRL_FIFO_RESET);
+	uint8_t ret;
+	
+	ret = MPU6050_Write_Reg(dev, USER_CTRL, ctrl);
+	if(ret == 0)
+		ret = MPU6050_Write_Reg(dev, USER_CTRL, ctrl | USER_CTRL_FIFO_RESET);
+	
+	//FIFO_RESET clears itself, this also keeps it out of the shadow cache
+	if(ret == 0)
+		ret = MPU6050_Write_Reg(dev, USER_CTRL, run ? (ctrl | USER_CTRL_FIFO_EN) : ctrl);
+	
+	return ret;
+}
+
+/*
+ *	----------------MPU6050_FIFO_Enable----------------
+ *	Start streaming accel and gyro samples into the hardware FIFO
+ *	at the configured sample rate. The FIFO is reset first so the
+ *	first drained frame is aligned
+ *	Input: Device Handle
+ * 	Output: Any I2C Errors if detected, otherwise 0
+ */
+uint8_t MPU6050_FIFO_Enable(MPU6050_t* dev){
+	uint8_t ret;
+	
+	ret = MPU6050_Write_Reg(dev, FIFO_EN, MPU6050_FIFO_SOURCES);
+	if(ret != 0)
+		return ret;
+	
+	return MPU6050_FIFO_Restart(dev, 1);
+}
+
+/*
+ *	----------------MPU6050_FIFO_Disable---------------
+ *	Stop streaming and leave the FIFO empty
+ *	Input: Device Handle
+ * 	Output: Any I2C Errors if detected, otherwise 0
+ */
+uint8_t MPU6050_FIFO_Disable(MPU6050_t* dev){
+	uint8_t ret;
+	
+	ret = MPU6050_Write_Reg(dev, FIFO_EN, 0);
+	if(ret != 0)
+		return ret;
+	
+	return MPU6050_FIFO_Restart(dev, 0);
+}
+
+/*
+ *	-----------------MPU6050_FIFO_Drain----------------
+ *	Read every whole frame currently in the FIFO (up to max_frames)
+ *	into the caller's buffer using large FIFO_R_W bursts. A full FIFO
+ *	means samples were dropped and frame alignment is lost, so the
+ *	FIFO is reset and MPU6050_FIFO_OVERFLOW is returned with no frames
+ *	Input: Device Handle, Frame Buffer, Buffer Length in frames, Frames Read (out)
+ * 	Output: Any I2C Errors or MPU6050_FIFO_OVERFLOW, otherwise 0
+ */
+uint8_t MPU6050_FIFO_Drain(MPU6050_t* dev, MPU6050_FIFO_FRAME_t* frames, uint32_t max_frames, uint32_t* count){
+	
+	/* Local Variables */
+	uint8_t COUNT_DATA[2];
+	uint8_t* raw;
+	int16_t* word;
+	uint32_t available;
+	uint32_t burst;
+	uint32_t i;
+	uint8_t ret;
+	
+	*count = 0;
+	
+	/* FIFO_COUNTH/L hold the byte count, read both in one burst so they match */
+	ret = I2C_Burst_Receive(dev->Bus, dev->Addr, FIFO_COUNTH, COUNT_DATA, sizeof(COUNT_DATA));
+	if(ret != 0)
+		return ret;
+	available = (uint32_t)(COUNT_DATA[0] << 8 | COUNT_DATA[1]);
+	
+	/*
+	1024 is not a multiple of the frame size, so a full FIFO has already
+	overwritten part of a frame. Nothing in it can be trusted, start over
+	*/
+	if(available >= MPU6050_FIFO_SIZE){
+		ret = MPU6050_FIFO_Restart(dev, 1);
+		return (ret != 0) ? ret : MPU6050_FIFO_OVERFLOW;
+	}
+	
+	/* Only whole frames, a partial one is finished by the next sample */
+	available /= MPU6050_FIFO_FRAME_SIZE;
+	if(available > max_frames)
+		available = max_frames;
+	
+	while(*count < available){
+		burst = available - *count;
+		if(burst > MPU6050_FIFO_BURST_FRAMES)
+			burst = MPU6050_FIFO_BURST_FRAMES;
+		
+		/* FIFO_R_W does not auto-increment, a burst keeps popping the FIFO */
+		raw = (uint8_t*)&frames[*count];
+		ret = I2C_Burst_Receive(dev->Bus, dev->Addr, FIFO_R_W, raw, burst * MPU6050_FIFO_FRAME_SIZE);
+		if(ret != 0)
+			return ret;
+		
+		/* Big endian bytes to int16_t in place, each word only reads its own two bytes */
+		word = (int16_t*)raw;
+		for(i = 0; i < burst * (MPU6050_FIFO_FRAME_SIZE / 2); i++)
+			word[i] = (int16_t)(raw[2 * i] << 8 | raw[2 * i + 1]);
+		
+		*count += burst;
+	}
+	
+	return 0;
+}
+
+/*
+ *	------------------MPU6050_Get_Temp------------------
+ *	Receive the Raw Temperature (TEMP_OUT_H/L in one burst)
+ *	Input: Device Handle, Raw Temperature destination
+ * 	Output: Any I2C Errors if detected, otherwise 0
+ */
+uint8_t MPU6050_Get_Temp(MPU6050_t* dev, int16_t* Temp_RAW){
+	uint8_t TEMP_DATA[2];
+	uint8_t ret;
+	
+	ret = I2C_Burst_Receive(dev->Bus, dev->Addr, TEMP_OUT_H, TEMP_DATA, sizeof(TEMP_DATA));
+	if(ret != 0)
+		return ret;
+	
+	*Temp_RAW = (int16_t)(TEMP_DATA[0] << 8 | TEMP_DATA[1]);
+	dev->Temp_RAW = *Temp_RAW;
+	
+	return 0;
+}
+
+/*
+ *	------------------MPU6050_Temp_C--------------------
+ *	Convert a Raw Temperature to degrees Celsius
+ *	Input: Raw Temperature
+ * 	Output: Temperature (degC)
+ */
+float MPU6050_Temp_C(int16_t Temp_RAW){
+	return (float)Temp_RAW * (1.0f / MPU6050_TEMP_LSB_PER_C) + MPU6050_TEMP_OFFSET_C;
+}
+
+/*
+ *	--------------MPU6050_Thermal_Resolve---------------
+ *	Local function to evaluate the gyro bias line at a temperature
+ *	Input: Device Handle, Raw Temperature
+ * 	Output: none
+ */
+static void MPU6050_Thermal_Resolve(MPU6050_t* dev, int16_t Temp_RAW){
+	int32_t delta = Temp_RAW - dev->Temp_Ref_RAW;
+	uint8_t k;
+	
+	//slope is per degC and delta is in 1/340 degC, the product needs 64 bits
+	for(k = 0; k < 3; k++)
+		dev->Gyro_Bias_Q16[k] = dev->Gyro_Offset_Q16[k] + (int32_t)(((int64_t)dev->Gyro_Slope_Q16[k] * delta) / MPU6050_TEMP_LSB_PER_C);
+	
+	dev->Bias_Temp_RAW = Temp_RAW;
+	dev->Bias_Stale = 0;
+}
+
+/*
+ *	----------------MPU6050_Thermal_Log-----------------
+ *	Feed one raw sample to the stationary gyro log. Every
+ *	MPU6050_THERMAL_BLOCK still samples become a (temperature, bias)
+ *	point; a block with motion in it is thrown away
+ *	Input: Device Handle, Raw Gyro, Raw Temperature
+ * 	Output: none
+ */
+void MPU6050_Thermal_Log(MPU6050_t* dev, MPU6050_GYRO_t* Gyro_Instance, int16_t Temp_RAW){
+	MPU6050_THERMAL_LOG_t* log = &dev->Thermal;
+	int16_t* axis = &Gyro_Instance->Gx_RAW;
+	float x;
+	float y;
+	uint8_t k;
+	
+	if(log->Block_Count == 0){
+		log->Block_Temp_Sum = 0;
+		for(k = 0; k < 3; k++){
+			log->Block_Sum[k] = 0;
+			log->Block_Min[k] = axis[k];
+			log->Block_Max[k] = axis[k];
+		}
+	}
+	
+	/* Same peak-to-peak test as MPU6050_Calibrate, any motion voids the block */
+	for(k = 0; k < 3; k++){
+		log->Block_Sum[k] += axis[k];
+		if(axis[k] < log->Block_Min[k]) log->Block_Min[k] = axis[k];
+		if(axis[k] > log->Block_Max[k]) log->Block_Max[k] = axis[k];
+		if((log->Block_Max[k] - log->Block_Min[k]) > MPU6050_CAL_GYRO_SPAN_MAX){
+			log->Block_Count = 0;
+			return;
+		}
+	}
+	log->Block_Temp_Sum += Temp_RAW;
+	
+	if(++log->Block_Count < MPU6050_THERMAL_BLOCK)
+		return;
+	log->Block_Count = 0;
+	
+	/* Halving keeps the fit following the sensor as it ages */
+	if(log->N >= MPU6050_THERMAL_MAX_POINTS){
+		log->N *= 0.5f;
+		log->Sx *= 0.5f;
+		log->Sxx *= 0.5f;
+		for(k = 0; k < 3; k++){
+			log->Sy[k] *= 0.5f;
+			log->Sxy[k] *= 0.5f;
+		}
+	}
+	
+	x = MPU6050_Temp_C(0) + (float)log->Block_Temp_Sum * (1.0f / (MPU6050_TEMP_LSB_PER_C * MPU6050_THERMAL_BLOCK));
+	log->N += 1.0f;
+	log->Sx += x;
+	log->Sxx += x * x;
+	for(k = 0; k < 3; k++){
+		/* Fractional mean, same scale as MPU6050_Q16_SCALE without its rounding */
+		y = (float)log->Block_Sum[k] * (1.0f / MPU6050_THERMAL_BLOCK) * (float)dev->Gyro_Q16_Mult / (float)(1UL << dev->Gyro_Q16_Shift);
+		log->Sy[k] += y;
+		log->Sxy[k] += x * y;
+	}
+}
+
+/*
+ *	----------------MPU6050_Thermal_Fit-----------------
+ *	Fit the per-axis gyro bias line to the logged points and use it
+ *	from the next sample on. With too little temperature spread only
+ *	the offset is refreshed and the previous slope is kept
+ *	Input: Device Handle
+ * 	Output: 0 if fitted, MPU6050_THERMAL_NARROW, MPU6050_THERMAL_NO_DATA
+ */
+uint8_t MPU6050_Thermal_Fit(MPU6050_t* dev){
+	MPU6050_THERMAL_LOG_t* log = &dev->Thermal;
+	float mean_x;
+	float mean_y;
+	float var_x;
+	uint8_t wide;
+	uint8_t k;
+	
+	if(log->N < MPU6050_THERMAL_MIN_POINTS)
+		return MPU6050_THERMAL_NO_DATA;
+	
+	mean_x = log->Sx / log->N;
+	var_x = log->Sxx / log->N - mean_x * mean_x;
+	wide = (var_x >= MPU6050_THERMAL_MIN_VAR);
+	
+	/* The least squares line passes through the means, so the offset is taken there */
+	for(k = 0; k < 3; k++){
+		mean_y = log->Sy[k] / log->N;
+		if(wide)
+			dev->Gyro_Slope_Q16[k] = (int32_t)((log->Sxy[k] / log->N - mean_x * mean_y) / var_x);
+		dev->Gyro_Offset_Q16[k] = (int32_t)mean_y;
+	}
+	dev->Temp_Ref_RAW = (int16_t)((mean_x - MPU6050_TEMP_OFFSET_C) * MPU6050_TEMP_LSB_PER_C);
+	dev->Bias_Stale = 1;
+	
+	return wide ? 0 : MPU6050_THERMAL_NARROW;
+}
+
+/*
+ *	---------------MPU6050_Sample_Period---------------
+ *	Local function to work out the time between samples from the
+ *	cached SMPLRT_DIV and DLPF setting
+ *	Input: Device Handle
+ * 	Output: Sample period in CYCCNT cycles
+ */
+static uint32_t MPU6050_Sample_Period(MPU6050_t* dev){
+	uint8_t dlpf = MPU6050_Config_Reg(dev, CONFIG) & CONFIG_DFPL_MSK;
+	uint32_t rate = ((dlpf == CONFIG_DFPL_0) || (dlpf == CONFIG_DFPL_7)) ? MPU6050_GYRO_RATE_8K : MPU6050_GYRO_RATE_1K;
+	
+	rate /= (1 + MPU6050_Config_Reg(dev, SMPLRT_DIV));
+	
+	return SYS_CLOCK_HZ / rate;
+}
+
+/*
+ *	----------------MPU6050_Block_Drain----------------
+ *	Drain the FIFO (MPU6050_FIFO_Enable first) into a sample block,
+ *	de-interleaving frames into the per-axis arrays. The newest
+ *	sample is stamped with the time of the last drain, earlier ones
+ *	are spaced by the configured sample period. On an error the block
+ *	comes back empty (Count 0)
+ *	Input: Device Handle, Block
+ * 	Output: Any I2C Errors or MPU6050_FIFO_OVERFLOW, otherwise 0
+ */
+uint8_t MPU6050_Block_Drain(MPU6050_t* dev, MPU6050_BLOCK_t* block){
+	
+	/* Local Variables */
+	MPU6050_FIFO_FRAME_t frames[MPU6050_FIFO_BURST_FRAMES];
+	int16_t* axis;
+	uint32_t want;
+	uint32_t count;
+	uint32_t now;
+	uint32_t n = 0;
+	uint32_t i;
+	uint8_t k;
+	uint8_t ret;
+	
+	/* Burst by burst until a drain comes back short, i.e. the FIFO was emptied */
+	do{
+		want = MPU6050_BLOCK_SIZE - n;
+		if(want > MPU6050_FIFO_BURST_FRAMES)
+			want = MPU6050_FIFO_BURST_FRAMES;
+		
+		now = CYCCNT_Read();
+		ret = MPU6050_FIFO_Drain(dev, frames, want, &count);
+		if(ret != 0)
 			break;
+		
+		for(i = 0; i < count; i++){
+			axis = &frames[i].Ax_RAW;
+			for(k = 0; k < MPU6050_AXES; k++)
+				block->Axis[k][n + i] = axis[k];
+		}
+		n += count;
+	} while((count == want) && (n < MPU6050_BLOCK_SIZE));
+	
+	/* An overflow reset the FIFO under the frames already copied, and the
+		 stamp belongs to the failed read: publish nothing */
+	if(ret != 0){
+		block->Count = 0;
+		return ret;
 	}
+	
+	block->Count = n;
+	block->Period = MPU6050_Sample_Period(dev);
+	block->Timestamp = now - ((n != 0) ? (n - 1) * block->Period : 0);
+	dev->Timestamp = now;
+	
+	return ret;
+}
+
+/*
+ *	----------------MPU6050_Block_Scale----------------
+ *	Local function to look up everything the per-sample path would,
+ *	once, so the block loops only multiply, shift and subtract
+ *	Input: Device Handle, Axis, Multiplier, Shift and Bias (out)
+ * 	Output: none
+ */
+static void MPU6050_Block_Scale(MPU6050_t* dev, MPU6050_AXIS axis, int32_t* mult, uint8_t* shift, int32_t* bias){
+	int16_t temp = dev->Temp_RAW;
+	int32_t drift = temp - dev->Bias_Temp_RAW;
+	
+	if(axis < MPU6050_GX){
+		*mult = dev->Accel_Q16_Mult;
+		*shift = ACCEL_Q16_SHIFT;
+		*bias = dev->Accel_Offset_Q16[axis];
+		return;
+	}
+	
+	if(dev->Bias_Stale || (drift > MPU6050_THERMAL_DEADBAND) || (drift < -MPU6050_THERMAL_DEADBAND))
+		MPU6050_Thermal_Resolve(dev, temp);
+	*mult = dev->Gyro_Q16_Mult;
+	*shift = dev->Gyro_Q16_Shift;
+	*bias = dev->Gyro_Bias_Q16[axis - MPU6050_GX];
+}
+
+/*
+ *	----------------MPU6050_Block_To_Q16---------------
+ *	Scale one axis of a block into Q16.16 g or deg/s minus the
+ *	bias, the scale and bias are resolved once per block
+ *	Input: Device Handle, Block, Axis, Output array [block->Count]
+ * 	Output: none
+ */
+void MPU6050_Block_To_Q16(MPU6050_t* dev, MPU6050_BLOCK_t* block, MPU6050_AXIS axis, int32_t* out){
+	const int16_t* in = block->Axis[axis];
+	uint32_t n = block->Count;
+	uint32_t i;
+	int32_t mult;
+	int32_t bias;
+	uint8_t shift;
+	
+	MPU6050_Block_Scale(dev, axis, &mult, &shift, &bias);
+	for(i = 0; i < n; i++)
+		out[i] = MPU6050_Q16_SCALE(in[i], mult, shift) - bias;
+}
+
+/*
+ *	---------------MPU6050_Block_To_Float--------------
+ *	Scale one axis of a block into float g or deg/s minus the bias
+ *	Input: Device Handle, Block, Axis, Output array [block->Count]
+ * 	Output: none
+ */
+void MPU6050_Block_To_Float(MPU6050_t* dev, MPU6050_BLOCK_t* block, MPU6050_AXIS axis, float* out){
+	const int16_t* in = block->Axis[axis];
+	uint32_t n = block->Count;
+	uint32_t i;
+	int32_t mult;
+	int32_t bias;
+	uint8_t shift;
+	
+	MPU6050_Block_Scale(dev, axis, &mult, &shift, &bias);
+	for(i = 0; i < n; i++)
+		out[i] = (float)(MPU6050_Q16_SCALE(in[i], mult, shift) - bias) * MPU6050_Q16_TO_FLOAT;
+}
+
+/*
+ *	----------------MPU6050_Axis_Scale----------------
+ *	Float conversion of one axis as value = raw * scale - offset, for
+ *	filters that run on the raw samples and convert their output
+ *	Input: Device Handle, Axis, Units per LSB and Bias (out)
+ * 	Output: none
+ */
+void MPU6050_Axis_Scale(MPU6050_t* dev, MPU6050_AXIS axis, float* scale, float* offset){
+	int32_t mult;
+	int32_t bias;
+	uint8_t shift;
+	
+	MPU6050_Block_Scale(dev, axis, &mult, &shift, &bias);
+	*scale = (float)mult / (float)(1UL << shift) * MPU6050_Q16_TO_FLOAT;
+	*offset = (float)bias * MPU6050_Q16_TO_FLOAT;
+}
+
+/*
+ *	--------------MPU6050_Accel_G_Per_LSB--------------
+ *	Accelerometer sensitivity for the current range, for code that
+ *	works on raw accel samples
+ *	Input: Device Handle
+ * 	Output: g per LSB
+ */
+float MPU6050_Accel_G_Per_LSB(MPU6050_t* dev){
+	return (float)dev->Accel_Q16_Mult / (float)(1UL << ACCEL_Q16_SHIFT) * MPU6050_Q16_TO_FLOAT;
+}
+
+/*
+ *	-----------------MPU6050_Block_Stats---------------
+ *	Sum, minimum and maximum of one axis of a block
+ *	Input: Block, Axis, Stats destination
+ * 	Output: none
+ */
+void MPU6050_Block_Stats(MPU6050_BLOCK_t* block, MPU6050_AXIS axis, MPU6050_BLOCK_STATS_t* stats){
+	const int16_t* in = block->Axis[axis];
+	uint32_t n = block->Count;
+	uint32_t i;
+	int32_t sum = 0;
+	int16_t min = INT16_MAX;
+	int16_t max = INT16_MIN;
+	
+	/* Locals only, so the loop stays in registers */
+	for(i = 0; i < n; i++){
+		sum += in[i];
+		if(in[i] < min) min = in[i];
+		if(in[i] > max) max = in[i];
+	}
+	
+	stats->Sum = sum;
+	stats->Min = min;
+	stats->Max = max;
+}
+
+/*
+ *	------------------MPU6050_Block_EMA----------------
+ *	Exponential moving average of one axis in place,
+ *	y += (x - y) / 2^shift. The filter state carries across blocks
+ *	Input: Block, Axis, State (raw << MPU6050_EMA_FRAC_BITS, seed with the first sample), Shift (1-12)
+ * 	Output: none
+ */
+void MPU6050_Block_EMA(MPU6050_BLOCK_t* block, MPU6050_AXIS axis, int32_t* state, uint8_t shift){
+	int16_t* x = block->Axis[axis];
+	uint32_t n = block->Count;
+	uint32_t i;
+	int32_t y = *state;
+	
+	//12 fraction bits keep a full scale step (2^28) inside int32
+	for(i = 0; i < n; i++){
+		y += (((int32_t)x[i] << MPU6050_EMA_FRAC_BITS) - y) >> shift;
+		x[i] = (int16_t)((y + (1L << (MPU6050_EMA_FRAC_BITS - 1))) >> MPU6050_EMA_FRAC_BITS);
+	}
+	
+	*state = y;
+}
+
+/*
+ *	-------------MPU6050_Process_Accel_Q16--------------
+ *	Process Raw Accelerometer Data into Q16.16 g with one integer
+ *	multiply per axis
+ *	Input: Device Handle, MPU6050 Accel User Instance Struct
+ * 	Output: none
+ */
+void MPU6050_Process_Accel_Q16(MPU6050_t* dev, MPU6050_ACCEL_t* Accel_Instance){
+	
+	//Sensitivity was resolved when ACCEL_CONFIG was last written, no bus traffic here
+	Accel_Instance->Ax_Q16 = MPU6050_Q16_SCALE(Accel_Instance->Ax_RAW, dev->Accel_Q16_Mult, ACCEL_Q16_SHIFT) - dev->Accel_Offset_Q16[0];
+	Accel_Instance->Ay_Q16 = MPU6050_Q16_SCALE(Accel_Instance->Ay_RAW, dev->Accel_Q16_Mult, ACCEL_Q16_SHIFT) - dev->Accel_Offset_Q16[1];
+	Accel_Instance->Az_Q16 = MPU6050_Q16_SCALE(Accel_Instance->Az_RAW, dev->Accel_Q16_Mult, ACCEL_Q16_SHIFT) - dev->Accel_Offset_Q16[2];
+}
+
+/*
+ *	--------------MPU6050_Process_Gyro_Q16--------------
+ *	Process Raw Gyroscope Data into Q16.16 deg/s with one integer
+ *	multiply per axis
+ *	Input: Device Handle, MPU6050 Gyro User Instance Struct
+ * 	Output: none
+ */
+void MPU6050_Process_Gyro_Q16(MPU6050_t* dev, MPU6050_GYRO_t* Gyro_Instance){
+	int16_t temp = dev->Temp_RAW;
+	int32_t drift = temp - dev->Bias_Temp_RAW;
+	
+	/* The die temperature moves slowly, the bias is only re-resolved past the deadband */
+	if(dev->Bias_Stale || (drift > MPU6050_THERMAL_DEADBAND) || (drift < -MPU6050_THERMAL_DEADBAND))
+		MPU6050_Thermal_Resolve(dev, temp);
+	
+	//Sensitivity was resolved when GYRO_CONFIG was last written, no bus traffic here
+	Gyro_Instance->Gx_Q16 = MPU6050_Q16_SCALE(Gyro_Instance->Gx_RAW, dev->Gyro_Q16_Mult, dev->Gyro_Q16_Shift) - dev->Gyro_Bias_Q16[0];
+	Gyro_Instance->Gy_Q16 = MPU6050_Q16_SCALE(Gyro_Instance->Gy_RAW, dev->Gyro_Q16_Mult, dev->Gyro_Q16_Shift) - dev->Gyro_Bias_Q16[1];
+	Gyro_Instance->Gz_Q16 = MPU6050_Q16_SCALE(Gyro_Instance->Gz_RAW, dev->Gyro_Q16_Mult, dev->Gyro_Q16_Shift) - dev->Gyro_Bias_Q16[2];
+}
+
+/*
+ *	---------------MPU6050_Process_Accel----------------
+ *	Process Raw Accelerometer Data into usable data and store
+ *	it in the user stuct
+ *	Input: Device Handle, MPU6050 Accel User Instance Struct
+ * 	Output: none
+ */
+void MPU6050_Process_Accel(MPU6050_t* dev, MPU6050_ACCEL_t* Accel_Instance){
+	
+	MPU6050_Process_Accel_Q16(dev, Accel_Instance);
+	Accel_Instance->Ax = (float)Accel_Instance->Ax_Q16 * MPU6050_Q16_TO_FLOAT;
+	Accel_Instance->Ay = (float)Accel_Instance->Ay_Q16 * MPU6050_Q16_TO_FLOAT;
+	Accel_Instance->Az = (float)Accel_Instance->Az_Q16 * MPU6050_Q16_TO_FLOAT;
+}
+
+/*
+ *	---------------MPU6050_Process_Gyro----------------
+ *	Process Raw Gyroscope Data into usable data and store it in
+ *	the user struct
+ *	Input: Device Handle, MPU6050 Gyro User Instance Struct
+ * 	Output: none
+ */
+void MPU6050_Process_Gyro(MPU6050_t* dev, MPU6050_GYRO_t* Gyro_Instance){
+	
+	MPU6050_Process_Gyro_Q16(dev, Gyro_Instance);
+	Gyro_Instance->Gx = (float)Gyro_Instance->Gx_Q16 * MPU6050_Q16_TO_FLOAT;
+	Gyro_Instance->Gy = (float)Gyro_Instance->Gy_Q16 * MPU6050_Q16_TO_FLOAT;
+	Gyro_Instance->Gz = (float)Gyro_Instance->Gz_Q16 * MPU6050_Q16_TO_FLOAT;
 }
 
 /*
  *	-----------------MPU6050_Get_Angle-----------------
  *	Calculate Tilt Angle using processed Accelerometer and
  *	Gyroscope data and it in the user angle struct
- *	Input: MPU6050 Angle User Instance Struct
+ *	Input: Device Handle, MPU6050 Angle User Instance Struct
  * 	Output: none
  */
-void MPU6050_Get_Angle(MPU6050_ACCEL_t* Accel_Instance, MPU6050_GYRO_t* Gyro_Instance, MPU6050_ANGLE_t* Angle_Instance){
+void MPU6050_Get_Angle(MPU6050_t* dev, MPU6050_ACCEL_t* Accel_Instance, MPU6050_GYRO_t* Gyro_Instance, MPU6050_ANGLE_t* Angle_Instance){
 	
 	// Process the raw data first to get scaled values (if not already done)
 	// MPU6050_Process_Accel(Accel_Instance); // Should be called before this function now
@@ -300,11 +1269,16 @@ void MPU6050_Get_Angle(MPU6050_ACCEL_t* Accel_Instance, MPU6050_GYRO_t* Gyro_Ins
 	
 	// Calculate Roll (rotation around x-axis) using lecture formula Psi = atan( Ay / sqrt(Ax^2 + Az^2) )
 	// atan2f equivalent: atan2f( Ay, sqrt(Ax^2 + Az^2) )
-	Angle_Instance->ArX = atan2f(ay, sqrtf(ax*ax + az*az)) * RAD_TO_DEGREE_CONV;
-
 	// Calculate Pitch (rotation around y-axis) using standard formula atan2(-x, sqrt(y^2 + z^2))
 	// Lecture formula Theta = atan( Ax / sqrt(Ay^2 + Az^2) ) is similar but with different sign convention for Ax.
-	Angle_Instance->ArY = atan2f(-ax, sqrtf(ay*ay + az*az)) * RAD_TO_DEGREE_CONV;
+	if(dev->Angle_Mode == MPU6050_ANGLE_FAST){
+		Angle_Instance->ArX = FastMath_Atan2(ay, FastMath_Sqrt(ax*ax + az*az)) * RAD_TO_DEGREE_CONV;
+		Angle_Instance->ArY = FastMath_Atan2(-ax, FastMath_Sqrt(ay*ay + az*az)) * RAD_TO_DEGREE_CONV;
+	}
+	else{
+		Angle_Instance->ArX = atan2f(ay, sqrtf(ax*ax + az*az)) * RAD_TO_DEGREE_CONV;
+		Angle_Instance->ArY = atan2f(-ax, sqrtf(ay*ay + az*az)) * RAD_TO_DEGREE_CONV;
+	}
 	
 	// Calculate Z position based on acceleration, but only when acceleration is not zero
 	float gyro_magnitude = Gyro_Instance->Gz;
@@ -316,8 +1290,219 @@ void MPU6050_Get_Angle(MPU6050_ACCEL_t* Accel_Instance, MPU6050_GYRO_t* Gyro_Ins
 	} 
 }
 
-/* Used for Debugging Purposes */
-uint8_t MPU6050_Read_Reg(uint8_t reg){
-	return I2C0_Receive(MPU6050_ADDR_AD0_LOW, reg);
+/*
+ *	----------------MPU6050_Set_Profile----------------
+ *	Apply a named rate/bandwidth/range profile with a single
+ *	4-byte register burst and update the cached scale factors
+ *	Input: Device Handle, Profile
+ * 	Output: Any I2C Errors if detected, otherwise 0
+ */
+uint8_t MPU6050_Set_Profile(MPU6050_t* dev, MPU6050_PROFILE profile){
+	uint8_t data[MPU6050_PROFILE_REGS];
+	uint8_t ret;
+	uint8_t i;
+	
+	/* Asserting Param */
+	if(profile >= MPU6050_PROFILE_COUNT)
+		return 1;
+	
+	//The shadow write takes a mutable buffer, the table lives in flash
+	for(i = 0; i < MPU6050_PROFILE_REGS; i++)
+		data[i] = MPU6050_Profile[profile][i];
+	
+	ret = I2C_Shadow_Burst_Write(&dev->Shadow, SMPLRT_DIV, data, MPU6050_PROFILE_REGS);
+	if(ret != 0)
+		return ret;
+	
+	MPU6050_Resolve_Scale(dev, GYRO_CONFIG, data[GYRO_CONFIG - SMPLRT_DIV]);
+	MPU6050_Resolve_Scale(dev, ACCEL_CONFIG, data[ACCEL_CONFIG - SMPLRT_DIV]);
+	
+	return 0;
+}
+
+/*
+ *	-----------------MPU6050_Q16_Mean------------------
+ *	Local function to scale a sum of raw samples to a Q16 mean,
+ *	rounding once at the end instead of per sample or per LSB
+ *	Input: Raw Sum, Sample Count, Q16 Multiplier, Shift
+ * 	Output: Q16 mean
+ */
+static int32_t MPU6050_Q16_Mean(int32_t sum, uint32_t count, int32_t mult, uint8_t shift){
+	int64_t num = (int64_t)sum * mult;
+	int64_t den = (int64_t)count << shift;
+	
+	num += (num < 0) ? -(den / 2) : (den / 2);
+	return (int32_t)(num / den);
+}
+
+/*
+ *	-----------------MPU6050_Calibrate-----------------
+ *	Average stationary FIFO samples into the offset table subtracted
+ *	by the processing functions. The sensor must be still and level
+ *	with Z up (1g is removed from the Z accel mean)
+ *	Input: Device Handle, Number of samples (1 - 65535)
+ * 	Output: Any I2C Errors or MPU6050_CAL_MOVING, otherwise 0
+ */
+uint8_t MPU6050_Calibrate(MPU6050_t* dev, uint16_t samples){
+	
+	/* Local Variables */
+	MPU6050_FIFO_FRAME_t frames[MPU6050_FIFO_BURST_FRAMES];
+	int32_t sum[6] = {0, 0, 0, 0, 0, 0};		// 65535 * 32768 still fits in int32
+	int16_t gyro_min[3] = {INT16_MAX, INT16_MAX, INT16_MAX};
+	int16_t gyro_max[3] = {INT16_MIN, INT16_MIN, INT16_MIN};
+	int16_t* axis;
+	uint32_t got = 0;
+	uint32_t want;
+	uint32_t count;
+	uint32_t i;
+	uint8_t k;
+	uint8_t ret;
+	
+	if(samples == 0)
+		return MPU6050_CAL_INVALID;
+	
+	ret = MPU6050_FIFO_Enable(dev);
+	if(ret != 0)
+		return ret;
+	
+	/* Drain a burst every few ms, the frames are gap free so N frames is exactly N samples */
+	while(got < samples){
+		DELAY_1MS(MPU6050_FIFO_BURST_FRAMES);
+		
+		want = samples - got;
+		if(want > MPU6050_FIFO_BURST_FRAMES)
+			want = MPU6050_FIFO_BURST_FRAMES;
+		
+		ret = MPU6050_FIFO_Drain(dev, frames, want, &count);
+		if(ret == MPU6050_FIFO_OVERFLOW)
+			continue;																	// FIFO was reset, nothing taken
+		if(ret != 0)
+			break;
+		
+		for(i = 0; i < count; i++){
+			axis = &frames[i].Ax_RAW;
+			for(k = 0; k < 6; k++)
+				sum[k] += axis[k];
+			for(k = 0; k < 3; k++){
+				if(axis[3 + k] < gyro_min[k]) gyro_min[k] = axis[3 + k];
+				if(axis[3 + k] > gyro_max[k]) gyro_max[k] = axis[3 + k];
+			}
+		}
+		got += count;
+	}
+	
+	MPU6050_FIFO_Disable(dev);
+	if(ret != 0)
+		return ret;
+	
+	for(k = 0; k < 3; k++){
+		if((gyro_max[k] - gyro_min[k]) > MPU6050_CAL_GYRO_SPAN_MAX)
+			return MPU6050_CAL_MOVING;
+	}
+	
+	/* Sums are scaled before dividing so the means keep their sub-LSB part, level means 0g/0g/1g */
+	for(k = 0; k < 3; k++){
+		dev->Accel_Offset_Q16[k] = MPU6050_Q16_Mean(sum[k], samples, dev->Accel_Q16_Mult, ACCEL_Q16_SHIFT);
+		dev->Gyro_Offset_Q16[k] = MPU6050_Q16_Mean(sum[3 + k], samples, dev->Gyro_Q16_Mult, dev->Gyro_Q16_Shift);
+	}
+	dev->Accel_Offset_Q16[2] -= MPU6050_Q16_ONE;
+	
+	/* The FIFO carries no temperature, the offsets belong to the die temperature now */
+	ret = MPU6050_Get_Temp(dev, &dev->Temp_Ref_RAW);
+	dev->Bias_Stale = 1;
+	
+	return ret;
+}
+
+/*
+ *	--------------MPU6050_Save_Calibration-------------
+ *	Store the offset table in EEPROM with a CRC (EEPROM_Init first)
+ *	Input: Device Handle
+ * 	Output: Any EEPROM Errors if detected, otherwise 0
+ */
+uint8_t MPU6050_Save_Calibration(MPU6050_t* dev){
+	MPU6050_CAL_t cal;
+	uint8_t k;
+	
+	cal.Magic = MPU6050_CAL_MAGIC;
+	for(k = 0; k < 3; k++){
+		cal.Accel_Q16[k] = dev->Accel_Offset_Q16[k];
+		cal.Gyro_Q16[k] = dev->Gyro_Offset_Q16[k];
+		cal.Gyro_Slope_Q16[k] = dev->Gyro_Slope_Q16[k];
+	}
+	cal.Temp_Ref_RAW = dev->Temp_Ref_RAW;
+	cal.CRC = CRC32((uint8_t*)&cal, sizeof(cal) - sizeof(cal.CRC));
+	
+	return EEPROM_Write(MPU6050_CAL_EEPROM_ADDR(dev->Addr), (uint32_t*)&cal, sizeof(cal) / sizeof(uint32_t));
+}
+
+/*
+ *	--------------MPU6050_Load_Calibration-------------
+ *	Load the offset table from EEPROM (EEPROM_Init first)
+ *	Input: Device Handle
+ * 	Output: 0 if loaded, MPU6050_CAL_INVALID if missing or corrupt
+ */
+uint8_t MPU6050_Load_Calibration(MPU6050_t* dev){
+	MPU6050_CAL_t cal;
+	uint8_t k;
+	
+	if(EEPROM_Read(MPU6050_CAL_EEPROM_ADDR(dev->Addr), (uint32_t*)&cal, sizeof(cal) / sizeof(uint32_t)) != 0)
+		return MPU6050_CAL_INVALID;
+	
+	//An erased EEPROM reads 0xFFFFFFFF, the magic catches it before the CRC does
+	if((cal.Magic != MPU6050_CAL_MAGIC) || (cal.CRC != CRC32((uint8_t*)&cal, sizeof(cal) - sizeof(cal.CRC))))
+		return MPU6050_CAL_INVALID;
+	
+	for(k = 0; k < 3; k++){
+		dev->Accel_Offset_Q16[k] = cal.Accel_Q16[k];
+		dev->Gyro_Offset_Q16[k] = cal.Gyro_Q16[k];
+		dev->Gyro_Slope_Q16[k] = cal.Gyro_Slope_Q16[k];
+	}
+	dev->Temp_Ref_RAW = (int16_t)cal.Temp_Ref_RAW;
+	dev->Bias_Stale = 1;
+	
+	return 0;
+}
+
+/*
+ *	--------------MPU6050_Set_Angle_Mode---------------
+ *	Select the math used by MPU6050_Get_Angle
+ *	Input: Device Handle, MPU6050_ANGLE_PRECISE or MPU6050_ANGLE_FAST
+ * 	Output: none
+ */
+void MPU6050_Set_Angle_Mode(MPU6050_t* dev, MPU6050_ANGLE_MODE mode){
+	dev->Angle_Mode = mode;
+}
+
+/*
+ *	-----------------MPU6050_Write_Reg-----------------
+ *	Write a configuration register through the shadow cache, a
+ *	range change re-resolves the cached LSB sensitivity once here
+ *	Input: Device Handle, Register Address, Data to Write
+ * 	Output: Any I2C Errors if detected, otherwise 0
+ */
+uint8_t MPU6050_Write_Reg(MPU6050_t* dev, uint8_t reg, uint8_t data){
+	uint8_t ret;
+	
+	ret = I2C_Shadow_Write(&dev->Shadow, reg, data);
+	if(ret == 0)
+		MPU6050_Resolve_Scale(dev, reg, data);
+	
+	return ret;
+}
+
+/*
+ *	-----------------MPU6050_Config_Reg----------------
+ *	Read a configuration register from the shadow cache
+ *	Input: Device Handle, Register Address
+ * 	Output: Register value
+ */
+uint8_t MPU6050_Config_Reg(MPU6050_t* dev, uint8_t reg){
+	return I2C_Shadow_Read(&dev->Shadow, reg);
+}
+
+/* Used for Debugging Purposes (always reads the device) */
+uint8_t MPU6050_Read_Reg(MPU6050_t* dev, uint8_t reg){
+	return I2C_Receive(dev->Bus, dev->Addr, reg);
 }
 
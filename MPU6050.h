@@ -15,6 +15,7 @@
 
 #include <stdint.h>
 #include "util.h"
+#include "I2C.h"
 
 
 //NOTE: There will be no self-test regs
@@ -29,36 +30,32 @@ incure any penelties but will be a waste of time)
 
 /* List of MPU6050 Register Macros */
 
-//#define USE_HIGH
-
 /**********************************************************/
-#ifndef USE_HIGH
 #define MPU6050_ADDR_AD0_LOW		(0x68)
-#else
-//Only use if AD0 is pulled high
-#define MPU6050_ADDR_AD0_HIGH		(0x69)
-#endif
+#define MPU6050_ADDR_AD0_HIGH		(0x69) // AD0 pulled high, a second MPU6050 on the same bus
 
 /*************Sampling Rate Register*************/
 #define SMPLRT_DIV							(0x19)
-//	#define SMPLRT_DIV_1					()
-//	#define SMPLRT_DIV_2					()
-//	#define SMPLRT_DIV_3					()
-//	#define SMPLRT_DIV_4					()
-//	#define SMPLRT_DIV_5					()
-//	#define SMPLRT_DIV_6					()
-//	#define SMPLRT_DIV_7					()
+	#define SMPLRT_DIV_1					(0x00)
+	#define SMPLRT_DIV_2					(0x01)
+	#define SMPLRT_DIV_3					(0x02)
+	#define SMPLRT_DIV_4					(0x03)
+	#define SMPLRT_DIV_5					(0x04) // 200Hz = 1kHz / (1+4) with the DLPF on
+	#define SMPLRT_DIV_6					(0x05)
+	#define SMPLRT_DIV_7					(0x06)
 	#define SMPLRT_DIV_8					(0x07) // Sample Rate = Gyroscope Output Rate / (1 + SMPLRT_DIV) -> 1kHz = 8kHz / (1+7)
 
 /****************Config Register****************/
 #define CONFIG									(0x1A)
-	#define CONFIG_DFPL_0					(0x00) // DLPF_CFG = 0
-//	#define CONFIG_DFPL_1					()
-//	#define CONFIG_DFPL_2					()
-//	#define CONFIG_DFPL_3					()
-//	#define CONFIG_DFPL_4					()
-//	#define CONFIG_DFPL_5					()
-//	#define CONFIG_DFPL_6					()
+	#define CONFIG_DFPL_0					(0x00) // DLPF_CFG = 0, 260Hz accel / 256Hz gyro, gyro output rate 8kHz
+	#define CONFIG_DFPL_1					(0x01) // 184Hz / 188Hz, gyro output rate 1kHz from here on
+	#define CONFIG_DFPL_2					(0x02) // 94Hz / 98Hz
+	#define CONFIG_DFPL_3					(0x03) // 44Hz / 42Hz, 4.9ms delay
+	#define CONFIG_DFPL_4					(0x04) // 21Hz / 20Hz
+	#define CONFIG_DFPL_5					(0x05) // 10Hz / 10Hz
+	#define CONFIG_DFPL_6					(0x06) // 5Hz / 5Hz
+	#define CONFIG_DFPL_MSK				(0x07)
+	#define CONFIG_DFPL_7					(0x07) // Reserved, gyro output rate 8kHz like DLPF_CFG = 0
 
 /*************Gyro Config Register*************/
 #define GYRO_CONFIG							(0x1B)
@@ -73,14 +70,36 @@ incure any penelties but will be a waste of time)
 	#define ACCEL_AFS_SEL_1				(ACCEL_AFS_SEL_0 + 0x08)
 	#define ACCEL_AFS_SEL_2				(ACCEL_AFS_SEL_0 + 0x10)
 	#define ACCEL_AFS_SEL_3				(ACCEL_AFS_SEL_0 + 0x18)
+	#define ACCEL_HPF_5HZ					(0x01) // Motion detection high pass filter
+	#define ACCEL_HPF_HOLD				(0x07) // Freeze the filter, motion is measured against the held value
+	#define ACCEL_HPF_MSK					(0x07)
 /**********************************************************/
 
-#define MOT_THR             		(0x1F)
+#define MOT_THR             		(0x1F) // 1 LSB = 2mg
+#define MOT_DUR             		(0x20) // 1 LSB = 1ms
 #define FIFO_EN             		(0x23)
+	#define FIFO_EN_SLV0					(0x01)
+	#define FIFO_EN_SLV1					(0x02)
+	#define FIFO_EN_SLV2					(0x04)
+	#define FIFO_EN_ACCEL					(0x08) // ACCEL_XOUT_H .. ACCEL_ZOUT_L
+	#define FIFO_EN_ZG						(0x10)
+	#define FIFO_EN_YG						(0x20)
+	#define FIFO_EN_XG						(0x40)
+	#define FIFO_EN_TEMP					(0x80)
 #define I2C_MST_CTRL        		(0x24)
+	#define I2C_MST_CLK_400				(0x0D) // 400kHz from the 8MHz internal clock
+	#define I2C_MST_P_NSR					(0x10) // Restart instead of stop between slave reads
+	#define I2C_MST_WAIT_FOR_ES		(0x40) // Hold data ready until external data is loaded
+	#define I2C_MST_MULT_MST_EN		(0x80)
 #define I2C_SLV0_ADDR       		(0x25)
+	#define I2C_SLV_RNW						(0x80) // In I2C_SLVx_ADDR, 1 = read from the slave
 #define I2C_SLV0_REG        		(0x26)
 #define I2C_SLV0_CTRL       		(0x27)
+	#define I2C_SLV_LEN_MSK				(0x0F) // Bytes to read
+	#define I2C_SLV_GRP						(0x10) // Pair bytes from odd register addresses
+	#define I2C_SLV_REG_DIS				(0x20) // Read without writing the register address
+	#define I2C_SLV_BYTE_SW				(0x40) // Swap bytes within pairs
+	#define I2C_SLV_EN						(0x80)
 #define I2C_SLV1_ADDR       		(0x28)
 #define I2C_SLV1_REG        		(0x29)
 #define I2C_SLV1_CTRL       		(0x2A)
@@ -96,9 +115,24 @@ incure any penelties but will be a waste of time)
 #define I2C_SLV4_CTRL       		(0x34)
 #define I2C_SLV4_DI         		(0x35)
 #define I2C_MST_STATUS      		(0x36)
+	#define I2C_MST_SLV4_NACK			(0x10)
+	#define I2C_MST_SLV4_DONE			(0x40)
 #define INT_PIN_CFG         		(0x37)
+	#define INT_PIN_I2C_BYPASS_EN	(0x02)
+	#define INT_PIN_FSYNC_INT_EN	(0x04)
+	#define INT_PIN_RD_CLEAR			(0x10) // Any read clears INT_STATUS
+	#define INT_PIN_LATCH_EN			(0x20) // Hold INT until cleared, otherwise a 50us pulse
+	#define INT_PIN_OPEN					(0x40) // Open drain
+	#define INT_PIN_LEVEL_LOW			(0x80) // Active low
 #define INT_ENABLE          		(0x38)
+	#define INT_EN_DATA_RDY				(0x01)
+	#define INT_EN_I2C_MST				(0x08)
+	#define INT_EN_FIFO_OFLOW			(0x10)
+	#define INT_EN_MOT						(0x40)
 #define INT_STATUS          		(0x3A)
+	#define INT_STATUS_DATA_RDY		(0x01)
+	#define INT_STATUS_FIFO_OFLOW	(0x10)
+	#define INT_STATUS_MOT				(0x40)
 
 /**********************************************************/
 #define ACCEL_XOUT_H        		(0x3B)
@@ -146,9 +180,17 @@ incure any penelties but will be a waste of time)
 #define I2C_SLV2_DO         		(0x65)
 #define I2C_SLV3_DO         		(0x66)
 #define I2C_MST_DELAY_CTRL  		(0x67)
+	#define I2C_MST_DELAY_ES_SHADOW	(0x80) // Update EXT_SENS_DATA only once every slave has been read
 #define SIGNAL_PATH_RESET   		(0x68)
 #define MOT_DETECT_CTRL     		(0x69)
+	#define MOT_DETECT_COUNT_1		(0x01) // Motion counter decrement of 1 per quiet sample
+	#define MOT_DETECT_ON_DELAY_1	(0x10) // 1ms extra accel power-on delay in cycle mode
 #define USER_CTRL           		(0x6A)
+	#define USER_CTRL_SIG_COND_RESET	(0x01)
+	#define USER_CTRL_I2C_MST_RESET		(0x02)
+	#define USER_CTRL_FIFO_RESET			(0x04) // Self clearing, only acts while USER_CTRL_FIFO_EN is 0
+	#define USER_CTRL_I2C_MST_EN			(0x20)
+	#define USER_CTRL_FIFO_EN					(0x40)
 
 /**********Power Management & ID Register**********/
 #define PWR_MGMT_1          		(0x6B)
@@ -159,8 +201,8 @@ incure any penelties but will be a waste of time)
 //	#define PWR_CLK_SEL_EXT_32		()
 //	#define PWR_CLK_SEL_EXT_19		()
 //	#define PWR_CLK_SEL_STOP			()
-//	#define PWR_TEMP_DIS					(0x08) // Disable temperature sensor
-//	#define PWR_CYCLE							(0x20)
+	#define PWR_TEMP_DIS					(0x08) // Disable temperature sensor
+	#define PWR_CYCLE							(0x20) // Sleep, waking for one accel sample at the PWR_2_WAKE rate
 //	#define PWR_SLEEP							(0x40) // Put MPU-6050 in sleep mode
 	#define PWR_DEVICE_RESET			(0x80) // Reset device
 #define WHO_AM_I            		(0x75)
@@ -174,23 +216,100 @@ incure any penelties but will be a waste of time)
 	#define PWR_2_STBY_ZA					(0x08)
 	#define PWR_2_STBY_YA					(0x10)
 	#define PWR_2_STBY_XA					(0x20)
-	#define PWR_2_WAKE_0					(0x00)
-	#define PWR_2_WAKE_1					(0x40)
-	#define PWR_2_WAKE_2					(0x80)
-	#define PWR_2_WAKE_3					(0xC0)
+	#define PWR_2_STBY_GYRO				(PWR_2_STBY_XG | PWR_2_STBY_YG | PWR_2_STBY_ZG)
+	#define PWR_2_WAKE_0					(0x00) // 1.25Hz cycle mode wake-ups
+	#define PWR_2_WAKE_1					(0x40) // 5Hz
+	#define PWR_2_WAKE_2					(0x80) // 20Hz
+	#define PWR_2_WAKE_3					(0xC0) // 40Hz
+	#define PWR_2_WAKE_MSK				(0xC0)
 
 #define FIFO_COUNTH         		(0x72)
 #define FIFO_COUNTL         		(0x73)
 #define FIFO_R_W            		(0x74)
+#define MPU6050_FIFO_SIZE				(1024)	// Bytes, oldest data is overwritten when full
 
 #define RAD_TO_DEGREE_CONV			(180/3.1415)
 
+/* Q16.16 Fixed Point (processed accel in g, gyro in deg/s) */
+#define MPU6050_Q16_ONE					(65536)
+#define MPU6050_Q16_TO_FLOAT		(1.0f / 65536.0f)
+
+/* Shadow Cache Window (configuration registers SMPLRT_DIV .. PWR_MGMT_2) */
+#define MPU6050_SHADOW_BASE				(SMPLRT_DIV)
+#define MPU6050_SHADOW_SIZE				(PWR_MGMT_2 - SMPLRT_DIV + 1)
+#define MPU6050_FS_SEL_MSK				(0x18)	// FS_SEL / AFS_SEL bits in GYRO_CONFIG / ACCEL_CONFIG
+
+/* Burst Read Sizes (registers auto-increment from ACCEL_XOUT_H) */
+#define MPU6050_AXIS_BURST_SIZE		(6)			// X/Y/Z High and Low bytes
+#define MPU6050_SAMPLE_BURST_SIZE	(14)		// ACCEL_XOUT_H .. GYRO_ZOUT_L
+
+/* FIFO Streaming (accel + gyro, written in register order every sample) */
+#define MPU6050_FIFO_SOURCES			(FIFO_EN_ACCEL | FIFO_EN_XG | FIFO_EN_YG | FIFO_EN_ZG)
+#define MPU6050_FIFO_FRAME_SIZE		(12)		// Accel X/Y/Z then Gyro X/Y/Z, big endian
+#define MPU6050_FIFO_BURST_FRAMES	(16)		// Frames per I2C transaction (192 bytes, ~4.4ms @ 400kHz)
+#define MPU6050_FIFO_OVERFLOW			(0x40)	// Returned when the FIFO filled up and was reset
+
+/* Sample Blocks (structure of arrays, one FIFO's worth of frames) */
+#define MPU6050_BLOCK_SIZE				(MPU6050_FIFO_SIZE / MPU6050_FIFO_FRAME_SIZE)	// 85 frames
+#define MPU6050_GYRO_RATE_8K			(8000)	// Gyro output rate with DLPF_CFG 0 or 7
+#define MPU6050_GYRO_RATE_1K			(1000)	// Gyro output rate with the DLPF on
+#define MPU6050_EMA_FRAC_BITS			(12)		// Fraction bits of the block EMA state
+
+/* Bias Calibration (sensor stationary and level, Z axis up) */
+#define MPU6050_CAL_SAMPLES				(1000)	// 1s of FIFO frames at 1kHz
+#define MPU6050_CAL_GYRO_SPAN_MAX	(200)		// Raw gyro peak-to-peak allowed while averaging
+#define MPU6050_CAL_INVALID				(0x01)	// Returned when no valid stored calibration
+#define MPU6050_CAL_MOVING				(0x20)	// Returned when the sensor moved during calibration
+#define MPU6050_CAL_EEPROM_ADDR(addr)	(((addr) & 0x01) * 16)	// One EEPROM block (16 words) per AD0 setting
+#define MPU6050_CAL_MAGIC					(0x4D504332)	// "MPC2", bump when the record layout changes
+
+/* Temperature Sensor (degC = TEMP_OUT / 340 + 36.53) */
+#define MPU6050_TEMP_LSB_PER_C		(340)
+#define MPU6050_TEMP_OFFSET_C			(36.53f)
+
+/* Thermal Gyro Bias Model: bias(T) = offset + slope * (T - T_ref), fitted
+	 by least squares over 1s stationary blocks logged while running */
+#define MPU6050_THERMAL_BLOCK				(1000)	// Samples averaged into one regression point
+#define MPU6050_THERMAL_MIN_POINTS	(8)			// Points needed before a fit
+#define MPU6050_THERMAL_MAX_POINTS	(256)		// Sums are halved past this, older points fade out
+#define MPU6050_THERMAL_MIN_VAR			(1.0f)	// degC^2 of spread needed to fit a slope
+#define MPU6050_THERMAL_DEADBAND		(34)		// Raw temperature change (0.1 degC) that re-resolves the bias
+#define MPU6050_THERMAL_NO_DATA			(0x01)	// Returned when too few stationary blocks were logged
+#define MPU6050_THERMAL_NARROW			(0x02)	// Returned when only the offset was updated (temperature too steady)
+
+/* Auxiliary I2C Master (slaves 0-3 land in EXT_SENS_DATA, right after GYRO_ZOUT_L) */
+#define MPU6050_AUX_SLOTS					(4)			// SLV0 - SLV3
+#define MPU6050_EXT_SENS_MAX			(24)		// EXT_SENS_DATA_00 .. EXT_SENS_DATA_23
+#define MPU6050_SLV_REG_STRIDE		(3)			// ADDR, REG, CTRL per slave
+#define MPU6050_AUX_POLL_MAX			(20)		// I2C_MST_STATUS polls before an SLV4 write gives up
+#define MPU6050_AUX_NACK					(0x04)	// Returned when the auxiliary slave did not answer
+
+/* Wake-on-Motion Idle (accel-only cycle mode, motion interrupt on the data-ready pin) */
+#define MPU6050_MOT_MG_PER_LSB		(2)			// MOT_THR resolution
+#define MPU6050_IDLE_THR_MG				(40)		// Default motion threshold
+#define MPU6050_IDLE_WAKE					(PWR_2_WAKE_1)	// Default wake rate (5Hz, ~10uA)
+#define MPU6050_IDLE_DUR_MS				(1)			// Samples above threshold before the interrupt
+#define MPU6050_IDLE_HPF_SETTLE_MS	(5)		// Filter settling time before it is held
+
+/* Init Errors */
+#define MPU6050_NOT_FOUND					(0x01)	// WHO_AM_I did not match
+
+/* Data-Ready Interrupt Line (MPU6050 INT -> PE1, rising edge) */
+#define MPU6050_INT_PIN						(0x02)	// PE1
+#define MPU6050_INT_PCTL_MSK			(0x000000F0)
+#define MPU6050_INT_IRQ_NUM				(4)			// GPIO Port E
+#define MPU6050_INT_PRIORITY			(I2C_IRQ_PRIORITY)	// Equal to the I2C handlers so neither preempts the other
+
 /* Data Struct to store Accelerometer Data*/
 typedef struct{
 	int16_t Ax_RAW;
 	int16_t Ay_RAW;
 	int16_t Az_RAW;
 	
+	int32_t Ax_Q16;
+	int32_t Ay_Q16;
+	int32_t Az_Q16;
+	
 	float Ax;
 	float Ay;
 	float Az;
@@ -203,12 +322,32 @@ typedef struct{
 	int16_t Gy_RAW;
 	int16_t Gz_RAW;
 	
+	int32_t Gx_Q16;
+	int32_t Gy_Q16;
+	int32_t Gz_Q16;
+	
 	float Gx;
 	float Gy;
 	float Gz;
 	
 } MPU6050_GYRO_t;
 
+/* Configuration Profiles (SMPLRT_DIV .. ACCEL_CONFIG written in one burst) */
+#define MPU6050_PROFILE_REGS			(ACCEL_CONFIG - SMPLRT_DIV + 1)
+
+typedef enum{
+	MPU6050_PROFILE_LOW_LATENCY		= 0,	// DLPF off, 1kHz, +/-2g, +/-250 deg/s (init default)
+	MPU6050_PROFILE_LOW_NOISE			= 1,	// DLPF 3 (44Hz), 200Hz, +/-2g, +/-250 deg/s
+	MPU6050_PROFILE_HIGH_DYNAMICS	= 2,	// DLPF off, 1kHz, +/-16g, +/-2000 deg/s
+	MPU6050_PROFILE_COUNT					= 3
+} MPU6050_PROFILE;
+
+/* Tilt Angle Math Precision */
+typedef enum{
+	MPU6050_ANGLE_PRECISE	= 0,		// C library atan2f/sqrtf
+	MPU6050_ANGLE_FAST		= 1			// FastMath kernels, < 0.05 deg error (default)
+} MPU6050_ANGLE_MODE;
+
 /* Data Struct to store Tilt Angle Data*/
 typedef struct{
 	float ArX;
@@ -216,58 +355,493 @@ typedef struct{
 	float ArZ;
 } MPU6050_ANGLE_t;
 
+/* Stored Calibration Record (offsets in Q16 g and deg/s so a range change keeps them valid) */
+typedef struct{
+	uint32_t Magic;
+	int32_t Accel_Q16[3];
+	int32_t Gyro_Q16[3];
+	int32_t Gyro_Slope_Q16[3];	// Q16 deg/s per degC
+	int32_t Temp_Ref_RAW;		// Temperature the gyro offsets belong to
+	uint32_t CRC;						// CRC32 of everything above
+} MPU6050_CAL_t;
+
+/* Stationary Gyro Log for the thermal fit (x = degC, y = Q16 deg/s) */
+typedef struct{
+	int32_t Block_Sum[3];						// Raw gyro sums of the block being collected
+	int32_t Block_Temp_Sum;
+	int16_t Block_Min[3];
+	int16_t Block_Max[3];
+	uint16_t Block_Count;
+	float N;												// Regression sums over accepted blocks
+	float Sx;
+	float Sxx;
+	float Sy[3];
+	float Sxy[3];
+} MPU6050_THERMAL_LOG_t;
+
+/* One data-ready sample, timestamped at the INT edge */
+typedef struct{
+	uint32_t Timestamp;			// CYCCNT at the rising edge of INT
+	uint32_t Seq;						// Edge count, a gap means samples were skipped
+	MPU6050_ACCEL_t Accel;
+	MPU6050_GYRO_t Gyro;
+	int16_t Temp_RAW;
+	uint8_t Ext_Len;				// Auxiliary bytes below, 0 without MPU6050_Aux_Add_Slave
+	uint8_t Ext[MPU6050_EXT_SENS_MAX];		// EXT_SENS_DATA as read, same sample instant
+} MPU6050_SAMPLE_t;
+
+/* One FIFO frame, the layout matches the FIFO byte order so a burst
+	 can land directly in an array of frames and be byte swapped in place */
+typedef struct{
+	int16_t Ax_RAW;
+	int16_t Ay_RAW;
+	int16_t Az_RAW;
+	int16_t Gx_RAW;
+	int16_t Gy_RAW;
+	int16_t Gz_RAW;
+} MPU6050_FIFO_FRAME_t;
+
+/* Block Axis Index, same order as a FIFO frame */
+typedef enum{
+	MPU6050_AX		= 0,
+	MPU6050_AY		= 1,
+	MPU6050_AZ		= 2,
+	MPU6050_GX		= 3,
+	MPU6050_GY		= 4,
+	MPU6050_GZ		= 5,
+	MPU6050_AXES	= 6
+} MPU6050_AXIS;
+
+/* Block of evenly spaced raw samples, one contiguous array per axis so
+	 block kernels walk memory linearly. Sample i was taken at
+	 Timestamp + i * Period (CYCCNT) */
+typedef struct{
+	uint32_t Count;									// Valid samples in every axis array
+	uint32_t Timestamp;							// CYCCNT of sample 0
+	uint32_t Period;								// Cycles between samples
+	int16_t Axis[MPU6050_AXES][MPU6050_BLOCK_SIZE];
+} MPU6050_BLOCK_t;
+
+/* Block Statistics (raw LSB) */
+typedef struct{
+	int32_t Sum;
+	int16_t Min;
+	int16_t Max;
+} MPU6050_BLOCK_STATS_t;
+
+/* Device Handle (one per MPU6050, set up by MPU6050_Init) */
+typedef struct{
+	I2C_BUS_t* Bus;									// Bus the device is attached to
+	uint8_t Addr;										// MPU6050_ADDR_AD0_LOW or MPU6050_ADDR_AD0_HIGH
+	uint32_t Timestamp;							// CYCCNT of the last sample read
+	
+	/* Driver Private */
+	I2C_SHADOW_t Shadow;						// Cached configuration registers
+	uint8_t Shadow_Value[MPU6050_SHADOW_SIZE];
+	uint32_t Shadow_Valid[I2C_SHADOW_VALID_WORDS(MPU6050_SHADOW_SIZE)];
+	int32_t Accel_Q16_Mult;					// Q16 reciprocal sensitivity, resolved when a range is written
+	int32_t Gyro_Q16_Mult;
+	uint8_t Gyro_Q16_Shift;
+	int32_t Accel_Offset_Q16[3];		// Bias offsets (Q16), subtracted after scaling
+	int32_t Gyro_Offset_Q16[3];
+	int32_t Gyro_Slope_Q16[3];			// Thermal gyro bias slope (Q16 deg/s per degC)
+	int16_t Temp_Ref_RAW;						// Temperature Gyro_Offset_Q16 belongs to
+	volatile int16_t Temp_RAW;			// Newest temperature read with a sample
+	int16_t Bias_Temp_RAW;					// Temperature Gyro_Bias_Q16 was resolved at
+	uint8_t Bias_Stale;							// Offsets changed, resolve before the next sample
+	int32_t Gyro_Bias_Q16[3];				// Offset + thermal term, what processing subtracts
+	MPU6050_THERMAL_LOG_t Thermal;
+	MPU6050_ANGLE_MODE Angle_Mode;
+	uint8_t Aux_Slots;							// SLV0 .. SLV(n-1) in use
+	uint8_t Aux_Len;								// EXT_SENS_DATA bytes they fill
+	uint8_t Idle;										// In wake-on-motion cycle mode
+	volatile uint8_t Motion;				// Set by the motion interrupt while idle
+	
+	/* Data-Ready Acquisition (the edge handler and the read callback own these) */
+	I2C_XFER_t DRDY_Xfer;
+	uint8_t DRDY_Data[MPU6050_SAMPLE_BURST_SIZE + MPU6050_EXT_SENS_MAX];
+	uint32_t DRDY_Edges;						// Edges seen
+	uint32_t DRDY_Edge_Time;				// CYCCNT of the edge that started DRDY_Xfer
+	uint32_t DRDY_Edge_Seq;					// Edge number of the read in flight
+	MPU6050_SAMPLE_t DRDY_Latest;
+	volatile uint8_t DRDY_Ready;
+	void (*DRDY_Callback)(MPU6050_SAMPLE_t* sample);	// Per-sample consumer, I2C handler context
+} MPU6050_t;
+
 /*
  *	-------------------MPU6050_Init---------------------
  *	Basic Initialization Function for MPU6050 @ default settings
- *	Input: none
- * 	Output: none
+ *	Input: Device Handle, Bus the MPU6050 is attached to (must
+ *				 already be initialized), 7-bit Address
+ * 	Output: MPU6050_NOT_FOUND if WHO_AM_I did not match, otherwise 0
  */
-void MPU6050_Init(void);
+uint8_t MPU6050_Init(MPU6050_t* dev, I2C_BUS_t* bus, uint8_t addr);
 
 /*
  *	-----------------MPU6050_Get_Accel------------------
  *	Receive Raw Accelerometer Data and store it in the user struct
- *	Input: MPU6050 Accel User Instance Struct
+ *	Input: Device Handle, MPU6050 Accel User Instance Struct
  * 	Output: none
  */
-void MPU6050_Get_Accel(MPU6050_ACCEL_t* Accel_Instance);
+void MPU6050_Get_Accel(MPU6050_t* dev, MPU6050_ACCEL_t* Accel_Instance);
 
 /*
  *	-----------------MPU6050_Get_Gyro-------------------
  *	Receive Raw Gyroscope Data and store it in the user struct
- *	Input: MPU6050 Gyro User Instance Struct
+ *	Input: Device Handle, MPU6050 Gyro User Instance Struct
+ * 	Output: none
+ */
+void MPU6050_Get_Gyro(MPU6050_t* dev, MPU6050_GYRO_t* Gyro_Instance);	
+
+/*
+ *	-----------------MPU6050_Get_Sample-----------------
+ *	Receive Raw Accelerometer, Temperature and Gyroscope Data in
+ *	a single 14-byte burst so every axis comes from the same sample
+ *	Input: Device Handle, MPU6050 Accel and Gyro User Instance Structs,
+ *				 Raw Temperature destination (NULL if not needed)
+ * 	Output: Any I2C Errors if detected, otherwise 0
+ */
+uint8_t MPU6050_Get_Sample(MPU6050_t* dev, MPU6050_ACCEL_t* Accel_Instance, MPU6050_GYRO_t* Gyro_Instance, int16_t* Temp_RAW);
+
+/*
+ *	------------------MPU6050_Get_Temp------------------
+ *	Receive the Raw Temperature (TEMP_OUT_H/L in one burst)
+ *	Input: Device Handle, Raw Temperature destination
+ * 	Output: Any I2C Errors if detected, otherwise 0
+ */
+uint8_t MPU6050_Get_Temp(MPU6050_t* dev, int16_t* Temp_RAW);
+
+/*
+ *	------------------MPU6050_Temp_C--------------------
+ *	Convert a Raw Temperature to degrees Celsius
+ *	Input: Raw Temperature
+ * 	Output: Temperature (degC)
+ */
+float MPU6050_Temp_C(int16_t Temp_RAW);
+
+/*
+ *	----------------MPU6050_Thermal_Log-----------------
+ *	Feed one raw sample to the stationary gyro log. Every
+ *	MPU6050_THERMAL_BLOCK still samples become a (temperature, bias)
+ *	point; a block with motion in it is thrown away
+ *	Input: Device Handle, Raw Gyro, Raw Temperature
+ * 	Output: none
+ */
+void MPU6050_Thermal_Log(MPU6050_t* dev, MPU6050_GYRO_t* Gyro_Instance, int16_t Temp_RAW);
+
+/*
+ *	----------------MPU6050_Thermal_Fit-----------------
+ *	Fit the per-axis gyro bias line to the logged points and use it
+ *	from the next sample on. With too little temperature spread only
+ *	the offset is refreshed and the previous slope is kept
+ *	Input: Device Handle
+ * 	Output: 0 if fitted, MPU6050_THERMAL_NARROW, MPU6050_THERMAL_NO_DATA
+ */
+uint8_t MPU6050_Thermal_Fit(MPU6050_t* dev);
+
+/*
+ *	-------------MPU6050_Process_Accel_Q16--------------
+ *	Process Raw Accelerometer Data into Q16.16 g with one integer
+ *	multiply per axis
+ *	Input: Device Handle, MPU6050 Accel User Instance Struct
+ * 	Output: none
+ */
+void MPU6050_Process_Accel_Q16(MPU6050_t* dev, MPU6050_ACCEL_t* Accel_Instance);
+
+/*
+ *	--------------MPU6050_Process_Gyro_Q16--------------
+ *	Process Raw Gyroscope Data into Q16.16 deg/s with one integer
+ *	multiply per axis, minus the bias at the newest temperature
+ *	Input: Device Handle, MPU6050 Gyro User Instance Struct
  * 	Output: none
  */
-void MPU6050_Get_Gyro(MPU6050_GYRO_t* Gyro_Instance);	
+void MPU6050_Process_Gyro_Q16(MPU6050_t* dev, MPU6050_GYRO_t* Gyro_Instance);
 
 /*
  *	---------------MPU6050_Process_Accel----------------
  *	Process Raw Accelerometer Data into usable data and store
  *	it in the user stuct
- *	Input: MPU6050 Accel User Instance Struct
+ *	Input: Device Handle, MPU6050 Accel User Instance Struct
  * 	Output: none
  */
-void MPU6050_Process_Accel(MPU6050_ACCEL_t* Accel_Instance);
+void MPU6050_Process_Accel(MPU6050_t* dev, MPU6050_ACCEL_t* Accel_Instance);
 
 /*
  *	---------------MPU6050_Process_Gyro----------------
  *	Process Raw Gyroscope Data into usable data and store it in
  *	the user struct
- *	Input: MPU6050 Gyro User Instance Struct
+ *	Input: Device Handle, MPU6050 Gyro User Instance Struct
  * 	Output: none
  */
-void MPU6050_Process_Gyro(MPU6050_GYRO_t* Gyro_Instance);
+void MPU6050_Process_Gyro(MPU6050_t* dev, MPU6050_GYRO_t* Gyro_Instance);
 
 /*
  *	-----------------MPU6050_Get_Angle-----------------
  *	Calculate Tilt Angle using processed Accelerometer and
  *	Gyroscope data and it in the user angle struct
- *	Input: MPU6050 Angle User Instance Struct
+ *	Input: Device Handle, MPU6050 Angle User Instance Struct
  * 	Output: none
  */
-void MPU6050_Get_Angle(MPU6050_ACCEL_t* Accel_Instance, MPU6050_GYRO_t* Gyro_Instance, MPU6050_ANGLE_t* Angle_Instance);
+void MPU6050_Get_Angle(MPU6050_t* dev, MPU6050_ACCEL_t* Accel_Instance, MPU6050_GYRO_t* Gyro_Instance, MPU6050_ANGLE_t* Angle_Instance);
+
+/*
+ *	---------------MPU6050_Get_Sample_Ext--------------
+ *	Read accel, temperature, gyro and every auxiliary slave's data
+ *	in one burst (polled). The timestamp is the CYCCNT at the read
+ *	Input: Device Handle, Sample destination
+ * 	Output: Any I2C Errors if detected, otherwise 0
+ */
+uint8_t MPU6050_Get_Sample_Ext(MPU6050_t* dev, MPU6050_SAMPLE_t* sample);
+
+/*
+ *	------------------MPU6050_Aux_Init-----------------
+ *	Enable the MPU6050's own I2C master (400kHz) with no slaves.
+ *	Data ready waits for the slaves and EXT_SENS_DATA is shadowed,
+ *	so IMU and auxiliary data always come from the same sample
+ *	Input: Device Handle
+ * 	Output: Any I2C Errors if detected, otherwise 0
+ */
+uint8_t MPU6050_Aux_Init(MPU6050_t* dev);
+
+/*
+ *	---------------MPU6050_Aux_Add_Slave---------------
+ *	Have the MPU6050 read a block from an auxiliary device every
+ *	sample. Slaves fill EXT_SENS_DATA in the order they are added
+ *	Input: Device Handle, 7-bit Address, First Register, Length (1-15),
+ *				 Offset of the data in MPU6050_SAMPLE_t.Ext (out)
+ * 	Output: Any I2C Errors, 1 if out of slots or bytes, otherwise 0
+ */
+uint8_t MPU6050_Aux_Add_Slave(MPU6050_t* dev, uint8_t slave_addr, uint8_t reg, uint8_t len, uint8_t* offset);
+
+/*
+ *	-----------------MPU6050_Aux_Write-----------------
+ *	Write one register of an auxiliary device through SLV4, used to
+ *	configure it (e.g. put a magnetometer in continuous mode)
+ *	Input: Device Handle, 7-bit Address, Register, Data
+ * 	Output: Any I2C Errors, MPU6050_AUX_NACK, otherwise 0
+ */
+uint8_t MPU6050_Aux_Write(MPU6050_t* dev, uint8_t slave_addr, uint8_t reg, uint8_t data);
+
+/*
+ *	-----------------MPU6050_DRDY_Init-----------------
+ *	Enable the data-ready interrupt and arm PE1 for the INT line
+ *	(one device owns PE1, a second MPU6050 is read with Get_Sample).
+ *	Every edge is timestamped and starts an asynchronous 14-byte
+ *	sample read, so acquisition runs at the sensor's sample rate
+ *	with no polling. At 1kHz the bus must run in Fast-mode (a sample
+ *	read takes ~1.6ms at 100kHz and every other edge is skipped)
+ *	Input: Device Handle
+ * 	Output: Any I2C Errors if detected, otherwise 0
+ */
+uint8_t MPU6050_DRDY_Init(MPU6050_t* dev);
+
+/*
+ *	--------------MPU6050_DRDY_Set_Callback------------
+ *	Hand every data-ready sample to a consumer as soon as it is read,
+ *	for streams that cannot afford to miss one between DRDY_Get calls.
+ *	The callback runs in the I2C interrupt and must be short
+ *	Input: Device Handle, Callback (0 to remove)
+ * 	Output: none
+ */
+void MPU6050_DRDY_Set_Callback(MPU6050_t* dev, void (*callback)(MPU6050_SAMPLE_t* sample));
+
+/*
+ *	-----------------MPU6050_DRDY_Get------------------
+ *	Take the newest data-ready sample if one arrived since the last call
+ *	Input: Device Handle, Sample destination
+ * 	Output: 1 if a new sample was copied, otherwise 0
+ */
+uint8_t MPU6050_DRDY_Get(MPU6050_t* dev, MPU6050_SAMPLE_t* sample);
+
+/*
+ *	-----------------MPU6050_DRDY_Wait-----------------
+ *	Sleep until the next data-ready sample arrives and take it
+ *	Input: Device Handle, Sample destination
+ * 	Output: none
+ */
+void MPU6050_DRDY_Wait(MPU6050_t* dev, MPU6050_SAMPLE_t* sample);
+
+/*
+ *	-----------------MPU6050_Idle_Enter----------------
+ *	Put the device into accel-only cycle mode: gyro and temperature
+ *	off, one accel sample per wake-up, and the INT line only pulses
+ *	on motion. Needs MPU6050_DRDY_Init on the same device first
+ *	Input: Device Handle, Threshold (mg), Wake Rate (PWR_2_WAKE_0 .. 3)
+ * 	Output: Any I2C Errors, 1 if the device does not own the INT pin, otherwise 0
+ */
+uint8_t MPU6050_Idle_Enter(MPU6050_t* dev, uint16_t threshold_mg, uint8_t wake);
+
+/*
+ *	-----------------MPU6050_Idle_Exit-----------------
+ *	Leave cycle mode and resume full-rate data-ready streaming
+ *	Input: Device Handle
+ * 	Output: Any I2C Errors if detected, otherwise 0
+ */
+uint8_t MPU6050_Idle_Exit(MPU6050_t* dev);
+
+/*
+ *	-----------------MPU6050_Idle_Wait-----------------
+ *	Enter cycle mode, sleep the MCU (WFI) until motion is detected,
+ *	then resume full-rate streaming
+ *	Input: Device Handle, Threshold (mg), Wake Rate (PWR_2_WAKE_0 .. 3)
+ * 	Output: Any I2C Errors, 1 if the device does not own the INT pin, otherwise 0
+ */
+uint8_t MPU6050_Idle_Wait(MPU6050_t* dev, uint16_t threshold_mg, uint8_t wake);
+
+/*
+ *	----------------MPU6050_FIFO_Enable----------------
+ *	Start streaming accel and gyro samples into the hardware FIFO
+ *	at the configured sample rate. The FIFO is reset first so the
+ *	first drained frame is aligned
+ *	Input: Device Handle
+ * 	Output: Any I2C Errors if detected, otherwise 0
+ */
+uint8_t MPU6050_FIFO_Enable(MPU6050_t* dev);
+
+/*
+ *	----------------MPU6050_FIFO_Disable---------------
+ *	Stop streaming and leave the FIFO empty
+ *	Input: Device Handle
+ * 	Output: Any I2C Errors if detected, otherwise 0
+ */
+uint8_t MPU6050_FIFO_Disable(MPU6050_t* dev);
+
+/*
+ *	-----------------MPU6050_FIFO_Drain----------------
+ *	Read every whole frame currently in the FIFO (up to max_frames)
+ *	into the caller's buffer using large FIFO_R_W bursts. A full FIFO
+ *	means samples were dropped and frame alignment is lost, so the
+ *	FIFO is reset and MPU6050_FIFO_OVERFLOW is returned with no frames
+ *	Input: Device Handle, Frame Buffer, Buffer Length in frames, Frames Read (out)
+ * 	Output: Any I2C Errors or MPU6050_FIFO_OVERFLOW, otherwise 0
+ */
+uint8_t MPU6050_FIFO_Drain(MPU6050_t* dev, MPU6050_FIFO_FRAME_t* frames, uint32_t max_frames, uint32_t* count);
+
+/*
+ *	----------------MPU6050_Block_Drain----------------
+ *	Drain the FIFO (MPU6050_FIFO_Enable first) into a sample block,
+ *	de-interleaving frames into the per-axis arrays. The newest
+ *	sample is stamped with the time of the last drain, earlier ones
+ *	are spaced by the configured sample period. On an error the block
+ *	comes back empty (Count 0)
+ *	Input: Device Handle, Block
+ * 	Output: Any I2C Errors or MPU6050_FIFO_OVERFLOW, otherwise 0
+ */
+uint8_t MPU6050_Block_Drain(MPU6050_t* dev, MPU6050_BLOCK_t* block);
+
+/*
+ *	----------------MPU6050_Block_To_Q16---------------
+ *	Scale one axis of a block into Q16.16 g or deg/s minus the
+ *	bias, the scale and bias are resolved once per block
+ *	Input: Device Handle, Block, Axis, Output array [block->Count]
+ * 	Output: none
+ */
+void MPU6050_Block_To_Q16(MPU6050_t* dev, MPU6050_BLOCK_t* block, MPU6050_AXIS axis, int32_t* out);
+
+/*
+ *	---------------MPU6050_Block_To_Float--------------
+ *	Scale one axis of a block into float g or deg/s minus the bias
+ *	Input: Device Handle, Block, Axis, Output array [block->Count]
+ * 	Output: none
+ */
+void MPU6050_Block_To_Float(MPU6050_t* dev, MPU6050_BLOCK_t* block, MPU6050_AXIS axis, float* out);
+
+/*
+ *	----------------MPU6050_Axis_Scale----------------
+ *	Float conversion of one axis as value = raw * scale - offset, for
+ *	filters that run on the raw samples and convert their output
+ *	Input: Device Handle, Axis, Units per LSB and Bias (out)
+ * 	Output: none
+ */
+void MPU6050_Axis_Scale(MPU6050_t* dev, MPU6050_AXIS axis, float* scale, float* offset);
+
+/*
+ *	--------------MPU6050_Accel_G_Per_LSB--------------
+ *	Accelerometer sensitivity for the current range, for code that
+ *	works on raw accel samples
+ *	Input: Device Handle
+ * 	Output: g per LSB
+ */
+float MPU6050_Accel_G_Per_LSB(MPU6050_t* dev);
+
+/*
+ *	-----------------MPU6050_Block_Stats---------------
+ *	Sum, minimum and maximum of one axis of a block
+ *	Input: Block, Axis, Stats destination
+ * 	Output: none
+ */
+void MPU6050_Block_Stats(MPU6050_BLOCK_t* block, MPU6050_AXIS axis, MPU6050_BLOCK_STATS_t* stats);
+
+/*
+ *	------------------MPU6050_Block_EMA----------------
+ *	Exponential moving average of one axis in place,
+ *	y += (x - y) / 2^shift. The filter state carries across blocks
+ *	Input: Block, Axis, State (raw << MPU6050_EMA_FRAC_BITS, seed with the first sample), Shift (1-12)
+ * 	Output: none
+ */
+void MPU6050_Block_EMA(MPU6050_BLOCK_t* block, MPU6050_AXIS axis, int32_t* state, uint8_t shift);
+
+/*
+ *	----------------MPU6050_Set_Profile----------------
+ *	Apply a named rate/bandwidth/range profile with a single
+ *	4-byte register burst and update the cached scale factors
+ *	Input: Device Handle, Profile
+ * 	Output: Any I2C Errors if detected, otherwise 0
+ */
+uint8_t MPU6050_Set_Profile(MPU6050_t* dev, MPU6050_PROFILE profile);
+
+/*
+ *	-----------------MPU6050_Calibrate-----------------
+ *	Average stationary FIFO samples into the offset table subtracted
+ *	by the processing functions. The sensor must be still and level
+ *	with Z up (1g is removed from the Z accel mean)
+ *	Input: Device Handle, Number of samples (1 - 65535)
+ * 	Output: Any I2C Errors or MPU6050_CAL_MOVING, otherwise 0
+ */
+uint8_t MPU6050_Calibrate(MPU6050_t* dev, uint16_t samples);
+
+/*
+ *	--------------MPU6050_Save_Calibration-------------
+ *	Store the offset table in EEPROM with a CRC (EEPROM_Init first)
+ *	Input: Device Handle
+ * 	Output: Any EEPROM Errors if detected, otherwise 0
+ */
+uint8_t MPU6050_Save_Calibration(MPU6050_t* dev);
+
+/*
+ *	--------------MPU6050_Load_Calibration-------------
+ *	Load the offset table from EEPROM (EEPROM_Init first)
+ *	Input: Device Handle
+ * 	Output: 0 if loaded, MPU6050_CAL_INVALID if missing or corrupt
+ */
+uint8_t MPU6050_Load_Calibration(MPU6050_t* dev);
+
+/*
+ *	--------------MPU6050_Set_Angle_Mode---------------
+ *	Select the math used by MPU6050_Get_Angle
+ *	Input: Device Handle, MPU6050_ANGLE_PRECISE or MPU6050_ANGLE_FAST
+ * 	Output: none
+ */
+void MPU6050_Set_Angle_Mode(MPU6050_t* dev, MPU6050_ANGLE_MODE mode);
+
+/*
+ *	-----------------MPU6050_Write_Reg-----------------
+ *	Write a configuration register through the shadow cache, a
+ *	range change re-resolves the cached LSB sensitivity once here
+ *	Input: Device Handle, Register Address, Data to Write
+ * 	Output: Any I2C Errors if detected, otherwise 0
+ */
+uint8_t MPU6050_Write_Reg(MPU6050_t* dev, uint8_t reg, uint8_t data);
+
+/*
+ *	-----------------MPU6050_Config_Reg----------------
+ *	Read a configuration register from the shadow cache
+ *	Input: Device Handle, Register Address
+ * 	Output: Register value
+ */
+uint8_t MPU6050_Config_Reg(MPU6050_t* dev, uint8_t reg);
 
-/* Used for Debugging Purposes */
-uint8_t MPU6050_Read_Reg(uint8_t reg);
+/* Used for Debugging Purposes (always reads the device) */
+uint8_t MPU6050_Read_Reg(MPU6050_t* dev, uint8_t reg);
 
 #endif
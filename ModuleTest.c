@@ -12,6 +12,11 @@
 #include "ModuleTest.h"
 #include "TCS34727.h"
 #include "MPU6050.h"
+#include "AHRS.h"
+#include "FastMath.h"
+#include "DSP16.h"
+#include "Spectrum.h"
+#include "Decimator.h"
 #include "UART0.h"
 #include "Servo.h"
 #include "LCD.h"
@@ -22,10 +27,40 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdint.h>
+#include <math.h>
+
+/* MPU6050 Thermal Fit Period (calls of Test_MPU6050, 10 samples each) */
+#define THERMAL_FIT_PERIOD			(6000)		// ~60s at 1kHz
+
+/* MPU6050 Idle Test (stationary this long -> wake-on-motion until picked up) */
+#define IDLE_STILL_DPS					(2.0f)
+#define IDLE_STILL_SAMPLES			(2000)		// 2s at 1kHz
+
+/* Vibration Spectrum (Z accel at the 1kHz data-ready rate, 1.95Hz bins, one line per 512ms) */
+#define VIB_FFT_SIZE						(512)
+#define VIB_SAMPLE_HZ						(1000.0f)
+#define VIB_BANDS								(4)
+static const float Vib_Band_Edges_Hz[VIB_BANDS + 1] = {2.0f, 10.0f, 50.0f, 150.0f, 500.0f};
+
+/* Gyro Decimation (1kHz FIFO -> CIC /25 -> 40Hz -> FIR /4 -> 10Hz, the rate main.c prints at) */
+#define DECIM_ORDER							(3)
+#define DECIM_CIC_RATE					(25)
+#define DECIM_FIR_RATE					(4)
+#define DECIM_TAPS							(31)
+#define DECIM_OUT_MAX						(MPU6050_BLOCK_SIZE / (DECIM_CIC_RATE * DECIM_FIR_RATE) + 1)
+
+/* FastMath Benchmark Grid (32 x 8 points covering all four quadrants) */
+#define FASTMATH_BENCH_POINTS		(256)
+
+/* DSP16 Benchmark (one FIFO block through bias, gain and a 7 tap low pass summing to 1.0) */
+#define DSP16_BENCH_BIAS				(-1200)
+#define DSP16_BENCH_GAIN				(0.71f)
+#define DSP16_BENCH_TAPS				(7)
+static const float DSP16_Bench_Taps[DSP16_BENCH_TAPS] = {0.03125f, 0.09375f, 0.1875f, 0.375f, 0.1875f, 0.09375f, 0.03125f};
 
 static char printBuf[100];
-static char angleBuf[LCD_ROW_SIZE];
-static char colorBuf[LCD_ROW_SIZE];
+static char angleBuf[LCD_ROW_SIZE + 1];
+static char colorBuf[LCD_ROW_SIZE + 1];
 static char colorString[6];
 
 /* Test Mode Variables */
@@ -35,10 +70,33 @@ uint8_t current_test = 1;     // 1 for UART test, 2 for WTIMER0 test
 /* RGB Color Struct Instance */
 RGB_COLOR_HANDLE_t RGB_COLOR;
 	
+/* MPU6050 Device Handles */
+MPU6050_t IMU_Instance;
+MPU6050_t IMU2_Instance;
+
 /* MPU6050 Struct Instance */
 MPU6050_ACCEL_t Accel_Instance;
 MPU6050_GYRO_t 	Gyro_Instance;
 MPU6050_ANGLE_t Angle_Instance;
+MPU6050_SAMPLE_t Sample_Instance;
+
+/* Attitude Filter Instance */
+AHRS_t AHRS_Instance;
+AHRS_EULER_t Euler_Instance;
+
+/* MPU6050 FIFO Drain Buffer (a full FIFO's worth of frames) */
+static MPU6050_FIFO_FRAME_t FIFO_Frames[MPU6050_FIFO_SIZE / MPU6050_FIFO_FRAME_SIZE];
+
+/* Vibration Analyzer (fed from the data-ready callback) */
+static SPECTRUM_t Spectrum_Instance;
+static SPECTRUM_RESULT_t Spectrum_Result;
+
+/* Gyro X/Y/Z Decimators */
+static DECIM_t Decim_Instance[3];
+
+/* MPU6050 Sample Block and its scaled gyro Z */
+static MPU6050_BLOCK_t IMU_Block;
+static float Block_Gz[MPU6050_BLOCK_SIZE];
 
 static void Test_Delay(void){
 	static uint8_t led_state = 1;  // Track LED state (1 = on, 0 = off)
@@ -64,40 +122,357 @@ static void Test_UART(void){
 }
 
 static void Test_I2C(void){
-	uint8_t ret = I2C0_Receive(TCS34727_ADDR, TCS34727_CMD|TCS34727_ID_R_ADDR);
+	uint8_t ret = I2C_Receive(DISPLAY_BUS, TCS34727_ADDR, TCS34727_CMD|TCS34727_ID_R_ADDR);
 	sprintf(printBuf, "TCS34727 ID: 0x%02X\r\n", ret);
 	UART0_OutString(printBuf);
 	DELAY_1MS(1000);
 }
 
 static void Test_MPU6050(void){
-	/* Grab Accelerometer and Gyroscope Raw Data*/
-	MPU6050_Get_Accel(&Accel_Instance);
-	MPU6050_Get_Gyro(&Gyro_Instance);
+	static uint32_t fit_count = 0;
+	uint8_t i;
+	
+	/* Sleep on the data-ready samples and fuse every one, print every 10th (10ms at 1kHz) */
+	for(i = 0; i < 10; i++){
+		MPU6050_DRDY_Wait(&IMU_Instance, &Sample_Instance);
+		MPU6050_Thermal_Log(&IMU_Instance, &Sample_Instance.Gyro, Sample_Instance.Temp_RAW);
+		AHRS_Update_Sample(&AHRS_Instance, &IMU_Instance, &Sample_Instance);
+	}
+	
+	/* Refit the thermal gyro bias from the still periods about once a minute */
+	if(++fit_count == THERMAL_FIT_PERIOD){
+		fit_count = 0;
+		MPU6050_Thermal_Fit(&IMU_Instance);
+	}
 		
-	/* Process Raw Accelerometer and Gyroscope Data */
-	MPU6050_Process_Accel(&Accel_Instance);
-	MPU6050_Process_Gyro(&Gyro_Instance);
+	/* Calculate Attitude */
+	AHRS_Get_Euler(&AHRS_Instance, &Euler_Instance);
 		
-	/* Calculate Tilt Angle */
-	MPU6050_Get_Angle(&Accel_Instance, &Gyro_Instance, &Angle_Instance);
+	/* Format buffer to print attitude */
+	sprintf(printBuf, "Roll: %.2f Pitch: %.2f Yaw: %.2f Temp: %.1f Seq: %lu\r\n", 
+		Euler_Instance.Roll, Euler_Instance.Pitch, Euler_Instance.Yaw,
+		MPU6050_Temp_C(Sample_Instance.Temp_RAW), (unsigned long)Sample_Instance.Seq);
+	UART0_OutString(printBuf);
+}
+
+static void Test_MPU6050_FIFO(void){
+	uint32_t count;
+	uint32_t total = 0;
+	uint32_t overflows = 0;
+	uint8_t ret;
+	
+	MPU6050_FIFO_Enable(&IMU_Instance);
+	
+	/* Drain every 50ms, the FIFO holds ~85ms of 1kHz samples */
+	while(1){
+		ret = MPU6050_FIFO_Drain(&IMU_Instance, FIFO_Frames, sizeof(FIFO_Frames) / sizeof(FIFO_Frames[0]), &count);
+		if(ret == MPU6050_FIFO_OVERFLOW)
+			overflows++;
+		total += count;
 		
-	/* Format buffer to print data and angle */
-	sprintf(printBuf, "Accel: X=%.2f Y=%.2f Z=%.2f Angle: %.2f\r\n", 
-		Angle_Instance.ArX, Angle_Instance.ArY, Angle_Instance.ArZ, Angle_Instance.ArY);
+		if(count != 0){
+			sprintf(printBuf, "FIFO: %lu frames (total %lu, overflows %lu) Ax=%d Gz=%d\r\n",
+				(unsigned long)count, (unsigned long)total, (unsigned long)overflows,
+				FIFO_Frames[count - 1].Ax_RAW, FIFO_Frames[count - 1].Gz_RAW);
+			UART0_OutString(printBuf);
+		}
+		
+		DELAY_1MS(50);
+	}
+}
+
+static void Test_MPU6050_Block(void){
+	MPU6050_BLOCK_STATS_t stats;
+	uint32_t i;
+	float sum;
+	
+	MPU6050_FIFO_Enable(&IMU_Instance);
+	
+	/* Every 50ms: drain into the per-axis arrays, then run each kernel over the whole block */
+	while(1){
+		DELAY_1MS(50);
+		if((MPU6050_Block_Drain(&IMU_Instance, &IMU_Block) != 0) || (IMU_Block.Count == 0))
+			continue;
+		
+		MPU6050_Block_Stats(&IMU_Block, MPU6050_AZ, &stats);
+		MPU6050_Block_To_Float(&IMU_Instance, &IMU_Block, MPU6050_GZ, Block_Gz);
+		
+		sum = 0.0f;
+		for(i = 0; i < IMU_Block.Count; i++)
+			sum += Block_Gz[i];
+		
+		sprintf(printBuf, "Block: %lu samples  Az p-p %d LSB  Gz mean %.3f deg/s\r\n",
+			(unsigned long)IMU_Block.Count, stats.Max - stats.Min, sum / IMU_Block.Count);
+		UART0_OutString(printBuf);
+	}
+}
+
+static void Test_MPU6050_Idle(void){
+	static uint32_t still = 0;
+	MPU6050_GYRO_t* g = &Sample_Instance.Gyro;
+	
+	MPU6050_DRDY_Wait(&IMU_Instance, &Sample_Instance);
+	AHRS_Update_Sample(&AHRS_Instance, &IMU_Instance, &Sample_Instance);
+	
+	/* Count back-to-back samples with every gyro axis inside the still band */
+	if((fabsf(g->Gx) < IDLE_STILL_DPS) && (fabsf(g->Gy) < IDLE_STILL_DPS) && (fabsf(g->Gz) < IDLE_STILL_DPS))
+		still++;
+	else
+		still = 0;
+	
+	if(still < IDLE_STILL_SAMPLES)
+		return;
+	
+	UART0_OutString("Still, idling until motion\r\n");
+	still = 0;
+	if(MPU6050_Idle_Wait(&IMU_Instance, MPU6050_IDLE_THR_MG, MPU6050_IDLE_WAKE) == 0)
+		UART0_OutString("Motion, streaming resumed\r\n");
+}
+
+static void Vibration_Sample(MPU6050_SAMPLE_t* sample){
+	Spectrum_Push(&Spectrum_Instance, sample->Accel.Az_RAW, sample->Seq, sample->Timestamp);
+}
+
+static void Test_MPU6050_Vibration(void){
+	SPECTRUM_RESULT_t* r = &Spectrum_Result;
+	
+	/* g per LSB for the current accel range */
+	if(Spectrum_Init(&Spectrum_Instance, VIB_FFT_SIZE, VIB_SAMPLE_HZ, MPU6050_Accel_G_Per_LSB(&IMU_Instance),
+		Vib_Band_Edges_Hz, VIB_BANDS) != 0)
+		return;
+	MPU6050_DRDY_Set_Callback(&IMU_Instance, Vibration_Sample);
+	
+	/* Capture keeps running in the interrupts, each full block is analysed here */
+	while(1){
+		if(!Spectrum_Process(&Spectrum_Instance, r)){
+			WaitForInterrupt();
+			continue;
+		}
+		
+		sprintf(printBuf, "Vib %lu: peak %.1f Hz %.4f g  rms %.4f g  %lu us\r\n", (unsigned long)r->Seq,
+			r->Peak_Hz, r->Peak_Amp, r->RMS, (unsigned long)(r->Cycles / (SYS_CLOCK_HZ / 1000000)));
+		UART0_OutString(printBuf);
+		sprintf(printBuf, "  bands %.4f %.4f %.4f %.4f g  gaps %lu  overruns %lu\r\n",
+			r->Band_RMS[0], r->Band_RMS[1], r->Band_RMS[2], r->Band_RMS[3],
+			(unsigned long)Spectrum_Instance.Gaps, (unsigned long)Spectrum_Instance.Overruns);
+		UART0_OutString(printBuf);
+	}
+}
+
+static void Test_MPU6050_Decim(void){
+	float out[3][DECIM_OUT_MAX];
+	float scale, offset;
+	uint32_t count, i;
+	uint8_t k;
+	
+	/* Blocks come from the FIFO, the data-ready reads would only compete for the bus */
+	MPU6050_Write_Reg(&IMU_Instance, INT_ENABLE, 0);
+	
+	for(k = 0; k < 3; k++){
+		MPU6050_Axis_Scale(&IMU_Instance, (MPU6050_AXIS)(MPU6050_GX + k), &scale, &offset);
+		Decim_Init(&Decim_Instance[k], DECIM_ORDER, DECIM_CIC_RATE, DECIM_FIR_RATE, DECIM_TAPS, scale);
+	}
+	MPU6050_FIFO_Enable(&IMU_Instance);
+	
+	while(1){
+		DELAY_1MS(50);
+		if((MPU6050_Block_Drain(&IMU_Instance, &IMU_Block) != 0) || (IMU_Block.Count == 0))
+			continue;
+		
+		/* The bias can follow temperature, the filter state is untouched */
+		for(k = 0; k < 3; k++){
+			MPU6050_Axis_Scale(&IMU_Instance, (MPU6050_AXIS)(MPU6050_GX + k), &scale, &offset);
+			Decim_Set_Offset(&Decim_Instance[k], offset);
+			count = Decim_Process(&Decim_Instance[k], IMU_Block.Axis[MPU6050_GX + k], IMU_Block.Count, out[k]);
+		}
+		
+		/* All three axes share a rate, so they produce the same number of outputs */
+		for(i = 0; i < count; i++){
+			sprintf(printBuf, "Decim Gx: %.3f  Gy: %.3f  Gz: %.3f deg/s\r\n", out[0][i], out[1][i], out[2][i]);
+			UART0_OutString(printBuf);
+		}
+	}
+}
+
+static void Test_MPU6050_Dual(void){
+	MPU6050_ACCEL_t accel2;
+	MPU6050_GYRO_t gyro2;
+	uint32_t skew;
+	
+	/* Back-to-back bursts, the timestamps show how far apart the two reads landed */
+	if((MPU6050_Get_Sample(&IMU_Instance, &Accel_Instance, &Gyro_Instance, NULL) != 0) ||
+		 (MPU6050_Get_Sample(&IMU2_Instance, &accel2, &gyro2, NULL) != 0))
+		return;
+	skew = IMU2_Instance.Timestamp - IMU_Instance.Timestamp;
+	
+	/* Each device scales with its own range and calibration */
+	MPU6050_Process_Gyro(&IMU_Instance, &Gyro_Instance);
+	MPU6050_Process_Gyro(&IMU2_Instance, &gyro2);
+	
+	sprintf(printBuf, "Gz: %.2f / %.2f  Diff: %.2f deg/s  Skew: %lu cyc\r\n",
+		Gyro_Instance.Gz, gyro2.Gz, Gyro_Instance.Gz - gyro2.Gz, (unsigned long)skew);
+	UART0_OutString(printBuf);
+	DELAY_1MS(100);
+}
+
+static void Test_FastMath(void){
+	volatile float sink;
+	float y, x, ref, err;
+	float atan_err = 0.0f;
+	float sqrt_err = 0.0f;
+	float invsqrt_err = 0.0f;
+	uint32_t overhead, t0, i;
+	uint32_t libm_cyc[3] = {0, 0, 0};
+	uint32_t fast_cyc[3] = {0, 0, 0};
+	
+	CYCCNT_Init();
+	t0 = CYCCNT_Read();
+	overhead = CYCCNT_Read() - t0;
+	
+	for(i = 0; i < FASTMATH_BENCH_POINTS; i++){
+		y = (float)((int32_t)(i & 0x1F) - 16) * 0.0625f;
+		x = (float)((int32_t)(i >> 5) - 4) * 0.25f + 0.125f;
+		
+		/* atan2, error in degrees */
+		t0 = CYCCNT_Read(); ref = atan2f(y, x); libm_cyc[0] += CYCCNT_Read() - t0 - overhead;
+		t0 = CYCCNT_Read(); sink = FastMath_Atan2(y, x); fast_cyc[0] += CYCCNT_Read() - t0 - overhead;
+		err = (sink - ref) * AHRS_RAD_TO_DEG;
+		if(err < 0.0f) err = -err;
+		if(err > atan_err) atan_err = err;
+		
+		/* sqrt and 1/sqrt on x^2 + y^2, relative error */
+		x = x * x + y * y;
+		t0 = CYCCNT_Read(); ref = sqrtf(x); libm_cyc[1] += CYCCNT_Read() - t0 - overhead;
+		t0 = CYCCNT_Read(); sink = FastMath_Sqrt(x); fast_cyc[1] += CYCCNT_Read() - t0 - overhead;
+		err = (sink - ref) / ref;
+		if(err < 0.0f) err = -err;
+		if(err > sqrt_err) sqrt_err = err;
+		
+		t0 = CYCCNT_Read(); ref = 1.0f / sqrtf(x); libm_cyc[2] += CYCCNT_Read() - t0 - overhead;
+		t0 = CYCCNT_Read(); sink = FastMath_InvSqrt(x); fast_cyc[2] += CYCCNT_Read() - t0 - overhead;
+		err = (sink - ref) / ref;
+		if(err < 0.0f) err = -err;
+		if(err > invsqrt_err) invsqrt_err = err;
+	}
+	
+	/* Average cycles per call */
+	sprintf(printBuf, "atan2:   libm %lu cyc, fast %lu cyc, max err %.4f deg\r\n",
+		(unsigned long)(libm_cyc[0] / FASTMATH_BENCH_POINTS), (unsigned long)(fast_cyc[0] / FASTMATH_BENCH_POINTS), atan_err);
+	UART0_OutString(printBuf);
+	sprintf(printBuf, "sqrt:    libm %lu cyc, fast %lu cyc, max rel err %.2e\r\n",
+		(unsigned long)(libm_cyc[1] / FASTMATH_BENCH_POINTS), (unsigned long)(fast_cyc[1] / FASTMATH_BENCH_POINTS), sqrt_err);
+	UART0_OutString(printBuf);
+	sprintf(printBuf, "invsqrt: libm %lu cyc, fast %lu cyc, max rel err %.2e\r\n\r\n",
+		(unsigned long)(libm_cyc[2] / FASTMATH_BENCH_POINTS), (unsigned long)(fast_cyc[2] / FASTMATH_BENCH_POINTS), invsqrt_err);
+	UART0_OutString(printBuf);
+	
+	DELAY_1MS(1000);
+}
+
+static void Test_DSP16(void){
+	static int16_t simd[MPU6050_BLOCK_SIZE];
+	static int16_t other[MPU6050_BLOCK_SIZE];
+	static float ref[MPU6050_BLOCK_SIZE];
+	static float line[DSP16_BENCH_TAPS];
+	static DSP16_FIR_t fir;
+	int16_t taps[DSP16_BENCH_TAPS];
+	int16_t gain = DSP16_Q15(DSP16_BENCH_GAIN);
+	uint32_t overhead, t0, i, k;
+	uint32_t float_cyc[4];
+	uint32_t simd_cyc[4];
+	volatile int64_t dot;
+	volatile float fdot;
+	float acc, err;
+	float max_err = 0.0f;
+	
+	CYCCNT_Init();
+	t0 = CYCCNT_Read();
+	overhead = CYCCNT_Read() - t0;
+	
+	/* Synthetic gyro axis: slow swing plus alternating noise, well inside int16 */
+	for(i = 0; i < MPU6050_BLOCK_SIZE; i++){
+		simd[i] = (int16_t)(((int32_t)i * 311) % 12000 - 6000 + ((i & 1) ? 400 : -400));
+		other[i] = (int16_t)(((int32_t)i * 97) % 8000 - 4000);
+		ref[i] = simd[i];
+	}
+	for(k = 0; k < DSP16_BENCH_TAPS; k++){
+		taps[k] = DSP16_Q15(DSP16_Bench_Taps[k]);
+		line[k] = 0.0f;
+	}
+	DSP16_FIR_Init(&fir, taps, DSP16_BENCH_TAPS);
+	
+	/* Bias subtraction */
+	t0 = CYCCNT_Read();
+	for(i = 0; i < MPU6050_BLOCK_SIZE; i++)
+		ref[i] -= DSP16_BENCH_BIAS;
+	float_cyc[0] = CYCCNT_Read() - t0 - overhead;
+	t0 = CYCCNT_Read();
+	DSP16_Sub_Bias(simd, DSP16_BENCH_BIAS, MPU6050_BLOCK_SIZE);
+	simd_cyc[0] = CYCCNT_Read() - t0 - overhead;
+	
+	/* Scaling */
+	t0 = CYCCNT_Read();
+	for(i = 0; i < MPU6050_BLOCK_SIZE; i++)
+		ref[i] *= DSP16_BENCH_GAIN;
+	float_cyc[1] = CYCCNT_Read() - t0 - overhead;
+	t0 = CYCCNT_Read();
+	DSP16_Scale(simd, gain, DSP16_Q15_SHIFT, MPU6050_BLOCK_SIZE);
+	simd_cyc[1] = CYCCNT_Read() - t0 - overhead;
+	
+	/* FIR low pass */
+	t0 = CYCCNT_Read();
+	for(i = 0; i < MPU6050_BLOCK_SIZE; i++){
+		for(k = DSP16_BENCH_TAPS - 1; k > 0; k--)
+			line[k] = line[k - 1];
+		line[0] = ref[i];
+		acc = 0.0f;
+		for(k = 0; k < DSP16_BENCH_TAPS; k++)
+			acc += DSP16_Bench_Taps[k] * line[k];
+		ref[i] = acc;
+	}
+	float_cyc[2] = CYCCNT_Read() - t0 - overhead;
+	t0 = CYCCNT_Read();
+	DSP16_FIR(&fir, simd, MPU6050_BLOCK_SIZE);
+	simd_cyc[2] = CYCCNT_Read() - t0 - overhead;
+	
+	/* Dot product */
+	t0 = CYCCNT_Read();
+	acc = 0.0f;
+	for(i = 0; i < MPU6050_BLOCK_SIZE; i++)
+		acc += ref[i] * other[i];
+	fdot = acc;
+	float_cyc[3] = CYCCNT_Read() - t0 - overhead;
+	t0 = CYCCNT_Read();
+	dot = DSP16_Dot(simd, other, MPU6050_BLOCK_SIZE);
+	simd_cyc[3] = CYCCNT_Read() - t0 - overhead;
+	
+	/* Fixed point error after the whole chain, in LSB */
+	for(i = 0; i < MPU6050_BLOCK_SIZE; i++){
+		err = (float)simd[i] - ref[i];
+		if(err < 0.0f) err = -err;
+		if(err > max_err) max_err = err;
+	}
+	
+	/* Cycles per block of MPU6050_BLOCK_SIZE samples */
+	sprintf(printBuf, "bias:  float %lu cyc, simd %lu cyc\r\n", (unsigned long)float_cyc[0], (unsigned long)simd_cyc[0]);
+	UART0_OutString(printBuf);
+	sprintf(printBuf, "scale: float %lu cyc, simd %lu cyc\r\n", (unsigned long)float_cyc[1], (unsigned long)simd_cyc[1]);
+	UART0_OutString(printBuf);
+	sprintf(printBuf, "fir%u:  float %lu cyc, simd %lu cyc, max err %.2f LSB\r\n", DSP16_BENCH_TAPS,
+		(unsigned long)float_cyc[2], (unsigned long)simd_cyc[2], max_err);
+	UART0_OutString(printBuf);
+	sprintf(printBuf, "dot:   float %lu cyc, simd %lu cyc, rel err %.2e\r\n\r\n", (unsigned long)float_cyc[3],
+		(unsigned long)simd_cyc[3], (double)(((float)dot - fdot) / fdot));
 	UART0_OutString(printBuf);
 	
-	DELAY_1MS(10);
+	DELAY_1MS(1000);
 }
 
 static void Test_TCS34727(void){
 	/* Main test loop */
 	while(1){
-		/* Get raw color data */
-		RGB_COLOR.C_RAW = TCS34727_GET_RAW_CLEAR();
-		RGB_COLOR.R_RAW = TCS34727_GET_RAW_RED();
-		RGB_COLOR.G_RAW = TCS34727_GET_RAW_GREEN();
-		RGB_COLOR.B_RAW = TCS34727_GET_RAW_BLUE();
+		/* Get raw color data in one burst */
+		TCS34727_GET_RAW_RGBC(&RGB_COLOR);
 		
 		/* Convert raw data to RGB values */
 		TCS34727_GET_RGB(&RGB_COLOR);
@@ -190,16 +565,15 @@ static void Test_LCD(void){
 }
 
 static void Test_Full_System(void){
-	/* Grab Accelerometer and Gyroscope Raw Data*/
-	MPU6050_Get_Accel(&Accel_Instance);
-	MPU6050_Get_Gyro(&Gyro_Instance);
+	/* Grab Accelerometer and Gyroscope Raw Data in one burst */
+	MPU6050_Get_Sample(&IMU_Instance, &Accel_Instance, &Gyro_Instance, NULL);
 		
 	/* Process Raw Accelerometer and Gyroscope Data */
-	MPU6050_Process_Accel(&Accel_Instance);
-	MPU6050_Process_Gyro(&Gyro_Instance);
+	MPU6050_Process_Accel(&IMU_Instance, &Accel_Instance);
+	MPU6050_Process_Gyro(&IMU_Instance, &Gyro_Instance);
 		
 	/* Calculate Tilt Angle */
-	MPU6050_Get_Angle(&Accel_Instance, &Gyro_Instance, &Angle_Instance);
+	MPU6050_Get_Angle(&IMU_Instance, &Accel_Instance, &Gyro_Instance, &Angle_Instance);
 		
 	/* Drive Servo Accordingly to Tilt Angle on X-Axis*/
 	Drive_Servo(Angle_Instance.ArX);
@@ -209,11 +583,8 @@ static void Test_Full_System(void){
 		Accel_Instance.Ax, Accel_Instance.Ay, Accel_Instance.Az, Angle_Instance.ArX);
 	UART0_OutString(printBuf);
 		
-	/* Grab Raw Color Data From Sensor and Process it */
-	RGB_COLOR.C_RAW = TCS34727_GET_RAW_CLEAR();
-	RGB_COLOR.R_RAW = TCS34727_GET_RAW_RED();
-	RGB_COLOR.G_RAW = TCS34727_GET_RAW_GREEN();
-	RGB_COLOR.B_RAW = TCS34727_GET_RAW_BLUE();
+	/* Grab Raw Color Data From Sensor in one burst and Process it */
+	TCS34727_GET_RAW_RGBC(&RGB_COLOR);
 	TCS34727_GET_RGB(&RGB_COLOR);
 		
 	/* Change Onboard RGB LED Color to Detected Color */
@@ -243,15 +614,14 @@ static void Test_Full_System(void){
 	/* Print String to Terminal through USB */
 	UART0_OutString(printBuf);
 		
-	/* Update LCD With Current Angle and Color Detected */
-	sprintf(angleBuf, "Angle:%0.2f", Angle_Instance.ArX);
-	sprintf(colorBuf, "Color:%s", colorString);
+	/* Update LCD With Current Angle and Color Detected, padded to the
+		 row width so old text is overwritten without a slow LCD_Clear */
+	sprintf(angleBuf, "Angle:%-10.2f", Angle_Instance.ArX);
+	sprintf(colorBuf, "Color:%-9s", colorString);
 	
-	LCD_Clear();
-	DELAY_1MS(2);
+	/* Queued as bulk traffic, the next MPU6050 read goes ahead of it */
 	LCD_Set_Cursor(0, 0);
 	LCD_Print_Str((uint8_t*)angleBuf);
-	DELAY_1MS(2);
 	LCD_Set_Cursor(1, 1);
 	LCD_Print_Str((uint8_t*)colorBuf);
 		
@@ -302,6 +672,38 @@ void Module_Test(MODULE_TEST_NAME test){
 			Test_MPU6050();
 			break;
 		
+		case MPU6050_FIFO_TEST:
+			Test_MPU6050_FIFO();
+			break;
+		
+		case MPU6050_BLOCK_TEST:
+			Test_MPU6050_Block();
+			break;
+		
+		case MPU6050_VIBRATION_TEST:
+			Test_MPU6050_Vibration();
+			break;
+		
+		case MPU6050_DECIM_TEST:
+			Test_MPU6050_Decim();
+			break;
+		
+		case MPU6050_DUAL_TEST:
+			Test_MPU6050_Dual();
+			break;
+		
+		case MPU6050_IDLE_TEST:
+			Test_MPU6050_Idle();
+			break;
+		
+		case FASTMATH_TEST:
+			Test_FastMath();
+			break;
+		
+		case DSP16_TEST:
+			Test_DSP16();
+			break;
+		
 		case TCS34727_TEST:
 			Test_TCS34727();
 			break;
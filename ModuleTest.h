@@ -15,6 +15,13 @@
 #include <stdint.h>
 #include "ButtonLED.h"
 #include "TCS34727.h"
+#include "I2C.h"
+#include "AHRS.h"
+
+/* Bus Assignment (point DISPLAY_BUS at &I2C1_Bus, PA6/PA7, to keep the
+	 slow LCD and color sensor traffic off the MPU6050 bus) */
+#define IMU_BUS							(&I2C0_Bus)
+#define DISPLAY_BUS					(&I2C0_Bus)
 
 /* Test Mode Variables */
 extern uint8_t current_led;    // Current LED color
@@ -23,11 +30,26 @@ extern uint8_t current_test;   // Current test mode (1 for UART, 2 for WTIMER0)
 /* RGB Color Struct Instance */
 extern RGB_COLOR_HANDLE_t RGB_COLOR;
 
+/* MPU6050 Device Handles (AD0 low, AD0 high for a redundant second IMU) */
+extern MPU6050_t IMU_Instance;
+extern MPU6050_t IMU2_Instance;
+
+/* Attitude Filter Instance */
+extern AHRS_t AHRS_Instance;
+
 typedef enum{
 	DELAY_TEST,
 	UART_TEST,
 	I2C_TEST,
 	MPU6050_TEST,
+	MPU6050_FIFO_TEST,
+	MPU6050_BLOCK_TEST,
+	MPU6050_DUAL_TEST,
+	MPU6050_IDLE_TEST,
+	MPU6050_VIBRATION_TEST,
+	MPU6050_DECIM_TEST,
+	FASTMATH_TEST,
+	DSP16_TEST,
 	TCS34727_TEST,
 	SERVO_TEST,
 	LCD_TEST,
@@ -0,0 +1,318 @@
+/*
+ * Spectrum.c
+ *
+ *	Double-buffered block capture and real FFT spectrum analysis
+ *
+ */
+
+#include "Spectrum.h"
+#include "util.h"
+#include "FastMath.h"
+#include <math.h>
+
+/*
+ *	-----------------Spectrum_Twiddle-------------------
+ *	Local function to read cos/sin(2 pi e / N) from the quarter wave table
+ *	Input: Analyzer, Exponent (any value, taken mod N), cos and sin destination
+ * 	Output: none
+ */
+static void Spectrum_Twiddle(SPECTRUM_t* s, uint32_t e, float* c, float* sn){
+	uint32_t q = s->N >> 2;
+
+	e &= s->N - 1U;
+	if(e <= q){
+		*c = s->Cos[e];
+		*sn = s->Cos[q - e];
+	}
+	else if(e <= 2 * q){
+		*c = -s->Cos[2 * q - e];
+		*sn = s->Cos[e - q];
+	}
+	else if(e <= 3 * q){
+		*c = -s->Cos[e - 2 * q];
+		*sn = -s->Cos[3 * q - e];
+	}
+	else{
+		*c = s->Cos[4 * q - e];
+		*sn = -s->Cos[e - 3 * q];
+	}
+}
+
+/*
+ *	-------------------Spectrum_Init--------------------
+ *	Configure the block size and bands and clear both blocks
+ *	Input: Analyzer, Block Size (power of two, 16 .. SPECTRUM_MAX_N),
+ *				 Sample Rate (Hz), Units per LSB, Band Edges (Hz, bands + 1
+ *				 ascending values), Band Count
+ * 	Output: 0 on success, 1 on bad parameters
+ */
+uint8_t Spectrum_Init(SPECTRUM_t* s, uint16_t n, float sample_hz, float scale, const float* edges_hz, uint8_t bands){
+	uint32_t k;
+	float bin;
+
+	/* Asserting Param */
+	if((n < SPECTRUM_MIN_N) || (n > SPECTRUM_MAX_N) || ((n & (n - 1U)) != 0))
+		return 1;
+	if((bands > SPECTRUM_MAX_BANDS) || (sample_hz <= 0.0f))
+		return 1;
+
+	s->N = n;
+	s->Sample_Hz = sample_hz;
+	s->Scale = scale;
+	s->Bands = bands;
+
+	for(k = 0; k <= (uint32_t)(n >> 2); k++)
+		s->Cos[k] = cosf(2.0f * SPECTRUM_PI * (float)k / (float)n);
+
+	/* Band edges to bins, DC (bin 0) never counts */
+	for(k = 0; (bands != 0) && (k <= bands); k++){
+		bin = edges_hz[k] * (float)n / sample_hz + 0.5f;
+		if(bin < 1.0f)
+			bin = 1.0f;
+		if(bin > (float)(n >> 1) + 1.0f)
+			bin = (float)(n >> 1) + 1.0f;
+		s->Band_Bin[k] = (uint16_t)bin;
+	}
+
+	s->Count = 0;
+	s->Fill = 0;
+	s->Full = 0;
+	s->Next_Seq = 0;
+	s->Gaps = 0;
+	s->Overruns = 0;
+
+	return 0;
+}
+
+/*
+ *	-------------------Spectrum_Push--------------------
+ *	Add one sample (interrupt safe, meant for the data-ready callback).
+ *	A skipped sequence number restarts the partial block, so every
+ *	block is contiguous
+ *	Input: Analyzer, Sample, Sequence Number, CYCCNT Timestamp
+ * 	Output: none
+ */
+void Spectrum_Push(SPECTRUM_t* s, int16_t sample, uint32_t seq, uint32_t timestamp){
+	uint8_t fill = s->Fill;
+
+	if((s->Count != 0) && (seq != s->Next_Seq)){
+		s->Count = 0;
+		s->Gaps++;
+	}
+	s->Next_Seq = seq + 1;
+
+	if(s->Count == 0){
+		s->Block_Time[fill] = timestamp;
+		s->Block_Seq[fill] = seq;
+	}
+	s->Block[fill][s->Count++] = sample;
+
+	if(s->Count < s->N)
+		return;
+	s->Count = 0;
+
+	/* The other block is still waiting: drop this one and refill it */
+	if(s->Full){
+		s->Overruns++;
+		return;
+	}
+
+	s->Full = fill + 1;
+	s->Fill = fill ^ 1;
+}
+
+/*
+ *	------------------Spectrum_Real_FFT-----------------
+ *	In-place forward FFT of N real values. Output is packed: x[0] is
+ *	bin 0, x[1] is bin N/2 (both real), x[2k], x[2k + 1] are the real
+ *	and imaginary parts of bin k for 0 < k < N/2
+ *	Input: Analyzer (N and twiddles), Data (N floats)
+ * 	Output: none
+ */
+void Spectrum_Real_FFT(SPECTRUM_t* s, float* x){
+	const uint32_t m = s->N >> 1;										// Complex points, x[2i] + j x[2i + 1]
+	uint32_t i, j, k, bit, L, base, step;
+	float t, c1, s1, c2, s2, c3, s3;
+	float ar, ai, br, bi, cr, ci, dr, di;
+	float t0r, t0i, t1r, t1i, t2r, t2i, t3r, t3i;
+	float er, ei, or_, oi;
+
+	/* Bit reversed order, then every stage below reads and writes in place */
+	for(i = 1, j = 0; i < m; i++){
+		for(bit = m >> 1; j & bit; bit >>= 1)
+			j ^= bit;
+		j |= bit;
+		if(i < j){
+			t = x[2*i];		x[2*i] = x[2*j];		x[2*j] = t;
+			t = x[2*i+1];	x[2*i+1] = x[2*j+1];	x[2*j+1] = t;
+		}
+	}
+
+	/* One radix-2 stage when log2(m) is odd leaves a power of four to go */
+	L = 1;
+	for(bit = m; bit > 1; bit >>= 2){
+		if(bit == 2){
+			for(i = 0; i < m; i += 2){
+				ar = x[2*i];	ai = x[2*i+1];
+				br = x[2*i+2];	bi = x[2*i+3];
+				x[2*i] = ar + br;		x[2*i+1] = ai + bi;
+				x[2*i+2] = ar - br;	x[2*i+3] = ai - bi;
+			}
+			L = 2;
+			break;
+		}
+	}
+
+	/*
+	 * Radix-4 stages: four length L transforms become one of length 4L.
+	 * After bit reversal the quarters hold the residues 0, 2, 1, 3 of
+	 * the merged sequence, so the twiddles W^k, W^2k, W^3k go on the
+	 * quarters at 2L, L and 3L
+	 */
+	for(; L < m; L <<= 2){
+		step = m / (4 * L) * 2;									// W_4L^k = W_N^(k * step)
+		for(k = 0; k < L; k++){
+			Spectrum_Twiddle(s, k * step, &c1, &s1);
+			Spectrum_Twiddle(s, 2 * k * step, &c2, &s2);
+			Spectrum_Twiddle(s, 3 * k * step, &c3, &s3);
+
+			for(base = 0; base < m; base += 4 * L){
+				i = base + k;
+
+				/* a = F0, b = W^k F1, c = W^2k F2, d = W^3k F3 (W = cos - j sin) */
+				ar = x[2*i];							ai = x[2*i+1];
+				t = x[2*(i+2*L)];				t0i = x[2*(i+2*L)+1];
+				br = t * c1 + t0i * s1;	bi = t0i * c1 - t * s1;
+				t = x[2*(i+L)];					t0i = x[2*(i+L)+1];
+				cr = t * c2 + t0i * s2;	ci = t0i * c2 - t * s2;
+				t = x[2*(i+3*L)];				t0i = x[2*(i+3*L)+1];
+				dr = t * c3 + t0i * s3;	di = t0i * c3 - t * s3;
+
+				t0r = ar + cr;	t0i = ai + ci;
+				t1r = ar - cr;	t1i = ai - ci;
+				t2r = br + dr;	t2i = bi + di;
+				t3r = br - dr;	t3i = bi - di;
+
+				/* X[k] = t0 + t2, X[k+L] = t1 - j t3, X[k+2L] = t0 - t2, X[k+3L] = t1 + j t3 */
+				x[2*i] = t0r + t2r;						x[2*i+1] = t0i + t2i;
+				x[2*(i+L)] = t1r + t3i;				x[2*(i+L)+1] = t1i - t3r;
+				x[2*(i+2*L)] = t0r - t2r;			x[2*(i+2*L)+1] = t0i - t2i;
+				x[2*(i+3*L)] = t1r - t3i;			x[2*(i+3*L)+1] = t1i + t3r;
+			}
+		}
+	}
+
+	/*
+	 * Real split: with A = Z[k], B = conj(Z[m - k]), the even and odd
+	 * halves are E = (A + B) / 2 and O = -j (A - B) / 2, and
+	 * X[k] = E + W^k O, X[m - k] = conj(E - W^k O)
+	 */
+	t = x[0];
+	x[0] = t + x[1];
+	x[1] = t - x[1];
+	for(k = 1; k <= m / 2; k++){
+		j = m - k;
+		er = 0.5f * (x[2*k] + x[2*j]);				ei = 0.5f * (x[2*k+1] - x[2*j+1]);
+		or_ = 0.5f * (x[2*k+1] + x[2*j+1]);		oi = -0.5f * (x[2*k] - x[2*j]);
+
+		/* W^k O with W^k = cos - j sin */
+		Spectrum_Twiddle(s, k, &c1, &s1);
+		t0r = or_ * c1 + oi * s1;
+		t0i = oi * c1 - or_ * s1;
+
+		x[2*k] = er + t0r;		x[2*k+1] = ei + t0i;
+		x[2*j] = er - t0r;		x[2*j+1] = t0i - ei;
+	}
+}
+
+/*
+ *	-----------------Spectrum_Process-------------------
+ *	Analyse the waiting block if there is one. Afterwards Work[0 .. N/2]
+ *	holds the bin power (raw LSB^2 of the windowed block)
+ *	Input: Analyzer, Result destination
+ * 	Output: 1 if a block was processed, otherwise 0
+ */
+uint8_t Spectrum_Process(SPECTRUM_t* s, SPECTRUM_RESULT_t* result){
+	uint32_t start = CYCCNT_Read();
+	const uint32_t n = s->N;
+	const uint32_t m = n >> 1;
+	float* x = s->Work;
+	int16_t* block;
+	int32_t sum = 0;
+	uint32_t k, peak, lo, hi;
+	float mean, c, sn, p, top, nyq, norm;
+	float a, b, d;
+	uint8_t idx;
+
+	if(s->Full == 0)
+		return 0;
+	idx = s->Full - 1;
+	block = s->Block[idx];
+	result->Timestamp = s->Block_Time[idx];
+	result->Seq = s->Block_Seq[idx];
+
+	/* Mean removal (gravity) and Hann window, w = (1 - cos(2 pi k / N)) / 2 */
+	for(k = 0; k < n; k++)
+		sum += block[k];
+	mean = (float)sum / (float)n;
+	for(k = 0; k < n; k++){
+		Spectrum_Twiddle(s, k, &c, &sn);
+		x[k] = ((float)block[k] - mean) * 0.5f * (1.0f - c);
+	}
+
+	/* Copied out, the capture side can have the block back */
+	s->Full = 0;
+
+	Spectrum_Real_FFT(s, x);
+
+	/* Power in place: bin k lands in x[k], which has already been read */
+	nyq = x[1] * x[1];
+	x[0] = x[0] * x[0];
+	for(k = 1; k < m; k++)
+		x[k] = x[2*k] * x[2*k] + x[2*k+1] * x[2*k+1];
+	x[m] = nyq;
+
+	/* Total, bands and peak over the one-sided spectrum without DC */
+	norm = SPECTRUM_HANN_RMS_NUM / ((float)n * (float)n);
+	p = 0.0f;
+	peak = 1;
+	top = x[1];
+	for(k = 1; k <= m; k++){
+		p += x[k];
+		if(x[k] > top){
+			top = x[k];
+			peak = k;
+		}
+	}
+	result->RMS = FastMath_Sqrt(p * norm) * s->Scale;
+
+	for(k = 0; k < s->Bands; k++){
+		p = 0.0f;
+		for(lo = s->Band_Bin[k]; (lo < s->Band_Bin[k + 1]) && (lo <= m); lo++)
+			p += x[lo];
+		result->Band_RMS[k] = FastMath_Sqrt(p * norm) * s->Scale;
+	}
+
+	/* Parabola through the magnitudes either side of the peak bin */
+	d = 0.0f;
+	if((peak > 1) && (peak < m)){
+		a = FastMath_Sqrt(x[peak - 1]);
+		b = FastMath_Sqrt(x[peak]);
+		c = FastMath_Sqrt(x[peak + 1]);
+		if((a - 2.0f * b + c) != 0.0f)
+			d = 0.5f * (a - c) / (a - 2.0f * b + c);
+	}
+	result->Peak_Hz = ((float)peak + d) * s->Sample_Hz / (float)n;
+
+	/* The window spreads a tone over a few bins, summing them avoids scalloping loss */
+	lo = (peak > SPECTRUM_PEAK_SPAN) ? peak - SPECTRUM_PEAK_SPAN : 1;
+	hi = (peak + SPECTRUM_PEAK_SPAN < m) ? peak + SPECTRUM_PEAK_SPAN : m;
+	p = 0.0f;
+	for(k = lo; k <= hi; k++)
+		p += x[k];
+	result->Peak_Amp = FastMath_Sqrt(2.0f * p * norm) * s->Scale;
+
+	result->Cycles = CYCCNT_Read() - start;
+
+	return 1;
+}
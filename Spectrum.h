@@ -0,0 +1,109 @@
+/*
+ * Spectrum.h
+ *
+ *	Vibration spectrum of one accelerometer axis. Samples are pushed
+ *	from the data-ready interrupt into one of two int16 blocks; when
+ *	a block fills the interrupt moves on to the other one and the
+ *	main loop takes the full block, removes its mean, applies a Hann
+ *	window and runs an in-place real FFT (N/2 point complex radix-4,
+ *	with one radix-2 stage when log2(N/2) is odd, then the real split).
+ *	Each block yields the power spectrum, the RMS in a set of bands
+ *	and the interpolated peak frequency. The block is released as
+ *	soon as it is copied, so processing has a whole block period
+ *	(512ms for N = 512 at 1kHz) before the next one is due
+ *
+ */
+
+#ifndef SPECTRUM_H_
+#define SPECTRUM_H_
+
+#include <stdint.h>
+
+/* Block Sizes */
+#define SPECTRUM_MIN_N					(16)
+#define SPECTRUM_MAX_N					(512)         // Sizes the buffers, any power of two up to this works
+#define SPECTRUM_MAX_BANDS			(6)
+
+/* Hann window scaling: a tone of amplitude A puts (A N / 4)^2 in its
+	 peak bin, and RMS^2 = 16 / (3 N^2) * (one-sided bin power sum) */
+#define SPECTRUM_HANN_RMS_NUM		(16.0f / 3.0f)
+#define SPECTRUM_PEAK_SPAN			(2)           // Bins either side summed into the peak amplitude
+
+#define SPECTRUM_PI							(3.14159265f)
+
+/* Per-Block Results (amplitudes in the units set by Spectrum_Init's scale) */
+typedef struct{
+	uint32_t Timestamp;							// CYCCNT of the block's first sample
+	uint32_t Seq;										// Sample sequence number of the first sample
+	float Peak_Hz;									// Strongest non-DC component, parabolic interpolation
+	float Peak_Amp;									// Its amplitude (peak, not RMS)
+	float RMS;											// Everything but DC
+	float Band_RMS[SPECTRUM_MAX_BANDS];
+	uint32_t Cycles;								// CYCCNT spent in Spectrum_Process
+} SPECTRUM_RESULT_t;
+
+/* Analyzer State */
+typedef struct{
+	/* Configuration */
+	uint16_t N;
+	float Sample_Hz;
+	float Scale;										// Units per LSB
+	uint8_t Bands;
+	uint16_t Band_Bin[SPECTRUM_MAX_BANDS + 1];	// Band b covers bins [Band_Bin[b], Band_Bin[b + 1])
+	float Cos[SPECTRUM_MAX_N / 4 + 1];			// Quarter wave, cos(2 pi k / N)
+
+	/* Acquisition (Spectrum_Push owns these) */
+	int16_t Block[2][SPECTRUM_MAX_N];
+	uint32_t Block_Time[2];
+	uint32_t Block_Seq[2];
+	uint16_t Count;									// Samples in the block being filled
+	uint8_t Fill;										// Block being filled
+	volatile uint8_t Full;					// Full block index + 1, 0 when none is waiting
+	uint32_t Next_Seq;
+	volatile uint32_t Gaps;					// Partial blocks restarted because a sample was skipped
+	volatile uint32_t Overruns;			// Full blocks dropped because processing fell behind
+
+	/* Processing */
+	float Work[SPECTRUM_MAX_N];			// FFT in place, then power of bins 0 .. N/2
+} SPECTRUM_t;
+
+/*
+ *	-------------------Spectrum_Init--------------------
+ *	Configure the block size and bands and clear both blocks
+ *	Input: Analyzer, Block Size (power of two, 16 .. SPECTRUM_MAX_N),
+ *				 Sample Rate (Hz), Units per LSB, Band Edges (Hz, bands + 1
+ *				 ascending values), Band Count
+ * 	Output: 0 on success, 1 on bad parameters
+ */
+uint8_t Spectrum_Init(SPECTRUM_t* s, uint16_t n, float sample_hz, float scale, const float* edges_hz, uint8_t bands);
+
+/*
+ *	-------------------Spectrum_Push--------------------
+ *	Add one sample (interrupt safe, meant for the data-ready callback).
+ *	A skipped sequence number restarts the partial block, so every
+ *	block is contiguous
+ *	Input: Analyzer, Sample, Sequence Number, CYCCNT Timestamp
+ * 	Output: none
+ */
+void Spectrum_Push(SPECTRUM_t* s, int16_t sample, uint32_t seq, uint32_t timestamp);
+
+/*
+ *	------------------Spectrum_Real_FFT-----------------
+ *	In-place forward FFT of N real values. Output is packed: x[0] is
+ *	bin 0, x[1] is bin N/2 (both real), x[2k], x[2k + 1] are the real
+ *	and imaginary parts of bin k for 0 < k < N/2
+ *	Input: Analyzer (N and twiddles), Data (N floats)
+ * 	Output: none
+ */
+void Spectrum_Real_FFT(SPECTRUM_t* s, float* x);
+
+/*
+ *	-----------------Spectrum_Process-------------------
+ *	Analyse the waiting block if there is one. Afterwards Work[0 .. N/2]
+ *	holds the bin power (raw LSB^2 of the windowed block)
+ *	Input: Analyzer, Result destination
+ * 	Output: 1 if a block was processed, otherwise 0
+ */
+uint8_t Spectrum_Process(SPECTRUM_t* s, SPECTRUM_RESULT_t* result);
+
+#endif
@@ -16,20 +16,34 @@
 #include <stdio.h>
 #include "tm4c123gh6pm.h"
 
+/* Bus the sensor is attached to, set by TCS34727_Init */
+static I2C_BUS_t* TCS34727_Bus;
+
+/* Shadow Cache of Configuration Registers */
+static uint8_t TCS34727_Shadow_Value[TCS34727_SHADOW_SIZE];
+static uint32_t TCS34727_Shadow_Valid[I2C_SHADOW_VALID_WORDS(TCS34727_SHADOW_SIZE)];
+static I2C_SHADOW_t TCS34727_Shadow = {
+	0, TCS34727_ADDR, TCS34727_CMD, TCS34727_SHADOW_BASE, TCS34727_SHADOW_SIZE,
+	TCS34727_Shadow_Value, TCS34727_Shadow_Valid
+};
+
 /*	-------------------TCS34727_Init------------------
  *	Basic Initialization Function for TCS34727 at default settings
- *	Input: none
+ *	Input: Bus the TCS34727 is attached to (must already be initialized)
  *	Output: none
  */
-void TCS34727_Init(void){
+void TCS34727_Init(I2C_BUS_t* bus){
 	uint8_t ret;																//Temp Variable to hold return values
 	char printBuf[20];													//String buffer to print
 	
+	TCS34727_Bus = bus;
+	TCS34727_Shadow.bus = bus;
+	
 	// Add a small delay after I2C Init and before first communication
 	DELAY_1MS(5); // Delay 5ms
 	
 	/* Check if RGB Color Sensor has been detected */
-	ret = I2C0_Receive(TCS34727_ADDR, TCS34727_CMD|TCS34727_ID_R_ADDR);
+	ret = I2C_Receive(TCS34727_Bus, TCS34727_ADDR, TCS34727_CMD|TCS34727_ID_R_ADDR);
 	
 	//Print ID or Error to Terminal
 	sprintf(printBuf, "ID: %x\r\n", ret);
@@ -42,7 +56,7 @@ void TCS34727_Init(void){
 	UART0_OutString("TCS34727 has been Detected\r\n");
 	
 	/* Set Integration Time to 24ms in timing register for better sensitivity */
-	ret = I2C0_Transmit(TCS34727_ADDR, TCS34727_CMD|TCS34727_TIMING_R_ADDR, 0xF6); // 24ms
+	ret = I2C_Shadow_Write(&TCS34727_Shadow, TCS34727_TIMING_R_ADDR, 0xF6); // 24ms
 	if(ret != 0)
 		UART0_OutString("Error on Transmit\r\n");
 	else
@@ -52,14 +66,14 @@ void TCS34727_Init(void){
 	DELAY_1MS(3);
 	
 	/* Setting Gain to 16X gain for better sensitivity */
-	ret = I2C0_Transmit(TCS34727_ADDR, TCS34727_CMD|TCS34727_CTRL_R_ADDR, 0x02); // 16x gain
+	ret = I2C_Shadow_Write(&TCS34727_Shadow, TCS34727_CTRL_R_ADDR, 0x02); // 16x gain
 	if(ret != 0)
 		UART0_OutString("Error on Transmit\r\n");
 	else
 		UART0_OutString("TCS34727 Gain Set\r\n");
 	
 	/* Powering On Sensor at Enable register */
-	ret = I2C0_Transmit(TCS34727_ADDR, TCS34727_CMD|TCS34727_ENABLE_R_ADDR, TCS34727_ENABLE_PON);
+	ret = I2C_Shadow_Write(&TCS34727_Shadow, TCS34727_ENABLE_R_ADDR, TCS34727_ENABLE_PON);
 	if(ret != 0)
 		UART0_OutString("Error on Transmit\r\n");
 	else
@@ -69,7 +83,7 @@ void TCS34727_Init(void){
 	DELAY_1MS(3);
 	
 	/* Enabling RGBC 2-Channel ADC at Enable register */
-	ret = I2C0_Transmit(TCS34727_ADDR, TCS34727_CMD|TCS34727_ENABLE_R_ADDR, TCS34727_ENABLE_PON |TCS34727_ENABLE_AEN);
+	ret = I2C_Shadow_Write(&TCS34727_Shadow, TCS34727_ENABLE_R_ADDR, TCS34727_ENABLE_PON |TCS34727_ENABLE_AEN);
 	if(ret != 0)
 		UART0_OutString("Error on Transmit\r\n");
 	else
@@ -92,8 +106,8 @@ uint16_t TCS34727_GET_RAW_CLEAR(void){
 	uint16_t CLEAR_DATA;
 	
 	/* Use I2C to grab both HIGH and LOW data */
-	CLEAR_LOW = I2C0_Receive(TCS34727_ADDR, TCS34727_CMD|TCS34727_CDATAL_R_ADDR);
-	CLEAR_HIGH = I2C0_Receive(TCS34727_ADDR, TCS34727_CMD|TCS34727_CDATAH_R_ADDR);
+	CLEAR_LOW = I2C_Receive(TCS34727_Bus, TCS34727_ADDR, TCS34727_CMD|TCS34727_CDATAL_R_ADDR);
+	CLEAR_HIGH = I2C_Receive(TCS34727_Bus, TCS34727_ADDR, TCS34727_CMD|TCS34727_CDATAH_R_ADDR);
 	
 	/* Concatanate into 16-bit value */
 	CLEAR_DATA = (CLEAR_HIGH << 8) | CLEAR_LOW;
@@ -115,8 +129,8 @@ uint16_t TCS34727_GET_RAW_RED(void){
 	uint16_t RED_DATA;
 	
 	/* Use I2C to grab both HIGH and LOW data */
-	RED_LOW = I2C0_Receive(TCS34727_ADDR, TCS34727_CMD|TCS34727_RDATAL_R_ADDR);
-	RED_HIGH = I2C0_Receive(TCS34727_ADDR, TCS34727_CMD|TCS34727_RDATAH_R_ADDR);
+	RED_LOW = I2C_Receive(TCS34727_Bus, TCS34727_ADDR, TCS34727_CMD|TCS34727_RDATAL_R_ADDR);
+	RED_HIGH = I2C_Receive(TCS34727_Bus, TCS34727_ADDR, TCS34727_CMD|TCS34727_RDATAH_R_ADDR);
 	
 	/* Concatanate into 16-bit value */
 	RED_DATA = (RED_HIGH << 8) | RED_LOW;
@@ -138,8 +152,8 @@ uint16_t TCS34727_GET_RAW_GREEN(void){
 	uint16_t GREEN_DATA;
 	
 	/* Use I2C to grab both HIGH and LOW data */
-	GREEN_LOW = I2C0_Receive(TCS34727_ADDR, TCS34727_CMD|TCS34727_GDATAL_R_ADDR);
-	GREEN_HIGH = I2C0_Receive(TCS34727_ADDR, TCS34727_CMD|TCS34727_GDATAH_R_ADDR);
+	GREEN_LOW = I2C_Receive(TCS34727_Bus, TCS34727_ADDR, TCS34727_CMD|TCS34727_GDATAL_R_ADDR);
+	GREEN_HIGH = I2C_Receive(TCS34727_Bus, TCS34727_ADDR, TCS34727_CMD|TCS34727_GDATAH_R_ADDR);
 	
 	/* Concatanate into 16-bit value */
 	GREEN_DATA = (GREEN_HIGH << 8) | GREEN_LOW;
@@ -161,8 +175,8 @@ uint16_t TCS34727_GET_RAW_BLUE(void){
 	uint16_t BLUE_DATA;
 	
 	/* Use I2C to grab both HIGH and LOW data */
-	BLUE_LOW = I2C0_Receive(TCS34727_ADDR, TCS34727_CMD|TCS34727_BDATAL_R_ADDR);
-	BLUE_HIGH = I2C0_Receive(TCS34727_ADDR, TCS34727_CMD|TCS34727_BDATAH_R_ADDR);
+	BLUE_LOW = I2C_Receive(TCS34727_Bus, TCS34727_ADDR, TCS34727_CMD|TCS34727_BDATAL_R_ADDR);
+	BLUE_HIGH = I2C_Receive(TCS34727_Bus, TCS34727_ADDR, TCS34727_CMD|TCS34727_BDATAH_R_ADDR);
 	
 	/* Concatanate into 16-bit value*/
 	BLUE_DATA = (BLUE_HIGH << 8) | BLUE_LOW;
@@ -173,6 +187,34 @@ uint16_t TCS34727_GET_RAW_BLUE(void){
 	return BLUE_DATA;
 }
 
+/*	---------------TCS34727_GET_RAW_RGBC-------------
+ *	Receive RAW clear, red, green and blue data in a single
+ *	auto-increment burst and store it in the user struct
+ *	Input: RGB Color User Instance Struct
+ *	Output: Any I2C Errors if detected, otherwise 0
+ */
+uint8_t TCS34727_GET_RAW_RGBC(RGB_COLOR_HANDLE_t* RGB_COLOR_Instance){
+	uint8_t RGBC_DATA[TCS34727_RGBC_BURST_SIZE];
+	uint8_t ret;
+	
+	/* 
+	Auto-increment protocol walks CDATAL..BDATAH in one transaction. Reading
+	CDATAL latches the upper bytes so all four channels come from the same
+	integration cycle, no integration delay is needed between channels
+	*/
+	ret = I2C_Burst_Receive(TCS34727_Bus, TCS34727_ADDR, TCS34727_CMD_AUTO_INC|TCS34727_CDATAL_R_ADDR, RGBC_DATA, sizeof(RGBC_DATA));
+	if(ret != 0)
+		return ret;
+	
+	/* Concatanate into 16-bit values (Low byte first) */
+	RGB_COLOR_Instance->C_RAW = (RGBC_DATA[1] << 8) | RGBC_DATA[0];
+	RGB_COLOR_Instance->R_RAW = (RGBC_DATA[3] << 8) | RGBC_DATA[2];
+	RGB_COLOR_Instance->G_RAW = (RGBC_DATA[5] << 8) | RGBC_DATA[4];
+	RGB_COLOR_Instance->B_RAW = (RGBC_DATA[7] << 8) | RGBC_DATA[6];
+	
+	return 0;
+}
+
 /*	---------------TCS34727_GET_RGB------------------
  *	Normalize RAW data into RGB range (0-255)
  *	Input: RGB Color Struct User Instance
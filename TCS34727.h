@@ -16,6 +16,7 @@
 
 #include <stdint.h>
 #include "util.h"
+#include "I2C.h"
 
 /* List of Fill In Macros (Not all need to be filled)
 
@@ -33,7 +34,9 @@ Comment Out All Macros that are not used
 #define TCS34727_ADDR							(0x29)
 
 /*************Command Register*************/
-#define TCS34727_CMD							(0x80)  // define the bit that indicates a command register (Includes Auto Increment Protocol)
+#define TCS34727_CMD							(0x80)  // define the bit that indicates a command register (Repeated Byte Protocol)
+	#define TCS34727_CMD_TYPE_AUTO_INC	(0x20)  // TYPE = 01: Auto-increment protocol transaction
+#define TCS34727_CMD_AUTO_INC			(TCS34727_CMD|TCS34727_CMD_TYPE_AUTO_INC)
 
 /*************Enable Registers*************/
 #define TCS34727_ENABLE_R_ADDR		(0x00)  // enable register address
@@ -62,6 +65,11 @@ Comment Out All Macros that are not used
 #define TCS34727_GDATAH_R_ADDR 					(0x19) // Green ADC high byte
 #define TCS34727_BDATAL_R_ADDR 					(0x1A) // Blue ADC low byte
 #define TCS34727_BDATAH_R_ADDR 					(0x1B) // Blue ADC high byte
+#define TCS34727_RGBC_BURST_SIZE				(8)    // CDATAL .. BDATAH
+
+/*************Shadow Cache Window (ENABLE .. CONTROL)*************/
+#define TCS34727_SHADOW_BASE					(TCS34727_ENABLE_R_ADDR)
+#define TCS34727_SHADOW_SIZE					(TCS34727_CTRL_R_ADDR - TCS34727_ENABLE_R_ADDR + 1)
 
 /*************TCS34727 device ID Values**************/
 #define TCS34727_ID			(0x4D) // Expected ID value for TCS34725 (Previously 0x4D for TCS34727)
@@ -88,10 +96,10 @@ typedef struct{
 
 /*	-------------------TCS34727_Init------------------
  *	Basic Initialization Function for TCS34727 at default settings
- *	Input: none
+ *	Input: Bus the TCS34727 is attached to (must already be initialized)
  *	Output: none
  */
-void TCS34727_Init(void);
+void TCS34727_Init(I2C_BUS_t* bus);
 
 /*	---------------TCS34727_GET_RAW_CLEAR-------------
  *	Receive RAW clear data reading from the sensor
@@ -121,6 +129,14 @@ uint16_t TCS34727_GET_RAW_GREEN(void);
  */
 uint16_t TCS34727_GET_RAW_BLUE(void);
 
+/*	---------------TCS34727_GET_RAW_RGBC-------------
+ *	Receive RAW clear, red, green and blue data in a single
+ *	auto-increment burst and store it in the user struct
+ *	Input: RGB Color User Instance Struct
+ *	Output: Any I2C Errors if detected, otherwise 0
+ */
+uint8_t TCS34727_GET_RAW_RGBC(RGB_COLOR_HANDLE_t* RGB_COLOR_Instance);
+
 /*	---------------TCS34727_GET_RGB------------------
  *	Normalize RAW data into RGB range (0-255)
  *	Input: RGB Color User Instance Struct
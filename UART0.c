@@ -48,6 +48,14 @@ unsigned char UART0_InChar(void){
   while((UART0_FR_R&UART_FR_RXFE) != 0); // wait until the receiving FIFO is not empty
   return((unsigned char)(UART0_DR_R&0xFF));
 }
+//------------UART_InCharNonBlocking------------
+// Get oldest serial port input without waiting
+// Input: none
+// Output: ASCII code for key typed, 0 if nothing has arrived
+unsigned char UART0_InCharNonBlocking(void){
+  if((UART0_FR_R&UART_FR_RXFE) != 0) return 0; // receive FIFO empty
+  return((unsigned char)(UART0_DR_R&0xFF));
+}
 //------------UART_OutChar------------
 // Output 8-bit to serial port
 // Input: letter is an 8-bit ASCII character to be transferred
@@ -0,0 +1,385 @@
+/*
+ * I2C_Bench.c
+ *
+ *	Host benchmark of the I2C driver against the register level
+ *	emulator. Runs each API call against stub MPU6050, TCS34727 and
+ *	LCD backpack devices on I2C0, checks the data that comes back,
+ *	and prints the simulated cycles per call next to the ideal wire
+ *	time so driver changes that add bus time show up as a regression.
+ *	Further checks cover the priority classes of the async engine,
+ *	timeout and recovery with a slave holding the bus low, and
+ *	register reads served from the shadow cache
+ *
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include "I2C.h"
+#include "I2C_Emu.h"
+#include "util.h"
+
+/* Stub Devices */
+#define BENCH_IMU_ADDR				(0x68U)       // MPU6050
+#define BENCH_IMU_WHO_AM_I		(0x75U)
+#define BENCH_IMU_ACCEL				(0x3BU)       // ACCEL_XOUT_H, 14 byte sample block
+#define BENCH_IMU_PWR_MGMT_1	(0x6BU)
+#define BENCH_COLOR_ADDR			(0x29U)       // TCS34727
+#define BENCH_COLOR_CMD				(0xA0U)       // Command bit + auto-increment
+#define BENCH_COLOR_ID				(0x12U)
+#define BENCH_LCD_ADDR				(0x3FU)       // PCF8574A backpack
+#define BENCH_NACK_ADDR				(0x50U)       // Nobody home
+
+/* Wire Bits per Call (START, bytes with ACK, repeated START, STOP) */
+#define BITS_RECEIVE					(1 + 9 + 9 + 1 + 9 + 9 + 1)
+#define BITS_TRANSMIT					(1 + 9 + 9 + 9 + 1)
+#define BITS_BURST_RX(n)			(1 + 9 + 9 + 1 + 9 + 9 * (n) + 1)
+#define BITS_BURST_TX(n)			(1 + 9 + 9 + 9 * (n) + 1)
+#define BITS_NACK							(1 + 9 + 1)
+
+/* Largest cost of a call that must stay off the bus (register accesses only) */
+#define BENCH_NO_WIRE_CYCLES	(64U)
+
+/* Shadow Window (MPU6050 configuration registers) */
+#define BENCH_SHADOW_BASE			(0x19U)       // SMPLRT_DIV
+#define BENCH_SHADOW_SIZE			(0x08U)
+
+static I2C_EMU_SLAVE_t Imu;
+static I2C_EMU_SLAVE_t Color;
+static I2C_EMU_SLAVE_t Lcd;
+static uint8_t Failures;
+
+/* Completion order of the async transfers in Bench_Priority */
+static I2C_XFER_t* Order[8];
+static uint8_t Order_Count;
+
+/*
+ *	-------------------Bench_Setup------------------
+ *	Reset the emulator, attach the stub devices and bring up I2C0
+ *	Input: SCL frequency
+ *	Output: None
+ */
+static void Bench_Setup(uint32_t scl_hz){
+	uint32_t i;
+
+	I2C_Emu_Reset();
+
+	Imu = (I2C_EMU_SLAVE_t){0};
+	Imu.addr = BENCH_IMU_ADDR;
+	Imu.reg_mask = 0xFF;
+	Imu.regs[BENCH_IMU_WHO_AM_I] = BENCH_IMU_ADDR;
+	for(i = 0; i < 14; i++)
+		Imu.regs[BENCH_IMU_ACCEL + i] = (uint8_t)(0x10 + i);
+
+	Color = (I2C_EMU_SLAVE_t){0};
+	Color.addr = BENCH_COLOR_ADDR;
+	Color.reg_mask = 0x1F;
+	Color.regs[BENCH_COLOR_ID] = 0x4D;
+
+	Lcd = (I2C_EMU_SLAVE_t){0};
+	Lcd.addr = BENCH_LCD_ADDR;
+	Lcd.reg_mask = 0x00;
+
+	I2C_Emu_Attach(0, &Imu);
+	I2C_Emu_Attach(0, &Color);
+	I2C_Emu_Attach(0, &Lcd);
+
+	I2C_Init(&I2C0_Bus);
+	I2C_Set_Speed(&I2C0_Bus, scl_hz);
+}
+
+/*
+ *	-------------------Bench_Report-----------------
+ *	Print one result row and count a failed data check
+ *	Input: Name, Cycles taken, Ideal wire bits, SCL frequency, Check passed
+ *	Output: None
+ */
+static void Bench_Report(const char* name, uint64_t cycles, uint32_t bits, uint32_t scl_hz, uint8_t ok){
+	uint64_t wire = (uint64_t)bits * SYS_CLOCK_HZ / scl_hz;
+
+	printf("  %-24s %8llu cyc %9.1f us   wire %8llu cyc   +%5.1f%%   %s\n",
+			name, (unsigned long long)cycles, cycles * 1e6 / SYS_CLOCK_HZ,
+			(unsigned long long)wire, wire ? (cycles - (double)wire) * 100.0 / wire : 0.0,
+			ok ? "ok" : "FAIL");
+
+	if(!ok)
+		Failures++;
+}
+
+/*
+ *	-------------------Bench_Check------------------
+ *	Print one pass/fail row and count a failure
+ *	Input: Name, Check passed
+ *	Output: None
+ */
+static void Bench_Check(const char* name, uint8_t ok){
+	printf("  %-58s %s\n", name, ok ? "ok" : "FAIL");
+
+	if(!ok)
+		Failures++;
+}
+
+/*
+ *	------------------Bench_Record------------------
+ *	Completion callback noting the order transfers finish in
+ *	Input: Completed transfer
+ *	Output: None
+ */
+static void Bench_Record(I2C_XFER_t* xfer){
+	if(Order_Count < sizeof(Order) / sizeof(Order[0]))
+		Order[Order_Count++] = xfer;
+}
+
+/*
+ *	--------------------Bench_Speed-----------------
+ *	Run every call once at one bus speed
+ *	Input: SCL frequency
+ *	Output: None
+ */
+static void Bench_Speed(uint32_t scl_hz){
+	I2C_XFER_t xfer = {0};
+	uint8_t buf[14];
+	uint8_t lcd[4] = {0x0C, 0x08, 0x3C, 0x38};
+	uint8_t ok;
+	uint8_t err;
+	uint64_t t0;
+	uint32_t i;
+
+	Bench_Setup(scl_hz);
+	printf("I2C0 @ %lu Hz (TPR %lu)\n", (unsigned long)I2C_Get_Speed(&I2C0_Bus), (unsigned long)(SYS_CLOCK_HZ / (20 * scl_hz) - 1));
+
+	t0 = I2C_Emu_Cycles();
+	ok = I2C_Receive(&I2C0_Bus, BENCH_IMU_ADDR, BENCH_IMU_WHO_AM_I) == BENCH_IMU_ADDR;
+	Bench_Report("Receive", I2C_Emu_Cycles() - t0, BITS_RECEIVE, scl_hz, ok);
+
+	t0 = I2C_Emu_Cycles();
+	err = I2C_Transmit(&I2C0_Bus, BENCH_IMU_ADDR, BENCH_IMU_PWR_MGMT_1, 0x01);
+	ok = (err == 0) && (Imu.regs[BENCH_IMU_PWR_MGMT_1] == 0x01);
+	Bench_Report("Transmit", I2C_Emu_Cycles() - t0, BITS_TRANSMIT, scl_hz, ok);
+
+	t0 = I2C_Emu_Cycles();
+	err = I2C_Burst_Receive(&I2C0_Bus, BENCH_IMU_ADDR, BENCH_IMU_ACCEL, buf, 6);
+	ok = (err == 0);
+	for(i = 0; i < 6; i++)
+		ok &= buf[i] == (uint8_t)(0x10 + i);
+	Bench_Report("Burst_Receive x6", I2C_Emu_Cycles() - t0, BITS_BURST_RX(6), scl_hz, ok);
+
+	t0 = I2C_Emu_Cycles();
+	err = I2C_Burst_Receive(&I2C0_Bus, BENCH_IMU_ADDR, BENCH_IMU_ACCEL, buf, 14);
+	ok = (err == 0);
+	for(i = 0; i < 14; i++)
+		ok &= buf[i] == (uint8_t)(0x10 + i);
+	Bench_Report("Burst_Receive x14", I2C_Emu_Cycles() - t0, BITS_BURST_RX(14), scl_hz, ok);
+
+	t0 = I2C_Emu_Cycles();
+	ok = I2C_Receive(&I2C0_Bus, BENCH_COLOR_ADDR, BENCH_COLOR_CMD | BENCH_COLOR_ID) == 0x4D;
+	Bench_Report("Receive (TCS34727 ID)", I2C_Emu_Cycles() - t0, BITS_RECEIVE, scl_hz, ok);
+
+	/* The backpack has no pointer, the first byte is data */
+	t0 = I2C_Emu_Cycles();
+	err = I2C_Burst_Transmit(&I2C0_Bus, BENCH_LCD_ADDR, lcd[0], &lcd[1], 3);
+	ok = (err == 0) && (Lcd.regs[0] == lcd[3]) && (Lcd.bytes_written == 3);
+	Bench_Report("Burst_Transmit x4 (LCD)", I2C_Emu_Cycles() - t0, BITS_BURST_TX(3), scl_hz, ok);
+
+	for(i = 0; i < 14; i++)
+		buf[i] = 0;
+	t0 = I2C_Emu_Cycles();
+	I2C_Async_Receive(&I2C0_Bus, &xfer, BENCH_IMU_ADDR, BENCH_IMU_ACCEL, buf, 14, 0);
+	err = I2C_Async_Wait(&xfer);
+	ok = (err == 0);
+	for(i = 0; i < 14; i++)
+		ok &= buf[i] == (uint8_t)(0x10 + i);
+	Bench_Report("Async_Receive x14", I2C_Emu_Cycles() - t0, BITS_BURST_RX(14), scl_hz, ok);
+
+	t0 = I2C_Emu_Cycles();
+	err = I2C_Burst_Receive(&I2C0_Bus, BENCH_NACK_ADDR, 0x00, buf, 6);
+	ok = (err & I2C_MCS_ERROR) != 0;
+	Bench_Report("Address NACK", I2C_Emu_Cycles() - t0, BITS_NACK, scl_hz, ok);
+
+	printf("\n");
+}
+
+/*
+ *	------------------Bench_Priority----------------
+ *	Queue transfers of every class behind one already on the bus and
+ *	check they finish by class (FIFO within a class) without the one
+ *	in flight being cut short, then check a blocking call takes the
+ *	bus at the next transaction boundary, ahead of queued work
+ *	Input: None
+ *	Output: None
+ */
+static void Bench_Priority(void){
+	I2C_XFER_t bulk[2] = {{0}};
+	I2C_XFER_t config = {0};
+	I2C_XFER_t realtime[2] = {{0}};
+	uint8_t buf[4][14];
+	uint8_t lcd[8] = {0};
+	uint8_t ok;
+
+	Bench_Setup(I2C_SPEED_FAST);
+	printf("Priority classes\n");
+
+	/* First BULK goes straight on the bus, the rest queue behind it */
+	Order_Count = 0;
+	bulk[0].priority = I2C_PRIO_BULK;
+	bulk[1].priority = I2C_PRIO_BULK;
+	config.priority = I2C_PRIO_CONFIG;
+	realtime[0].priority = I2C_PRIO_REALTIME;
+	realtime[1].priority = I2C_PRIO_REALTIME;
+	I2C_Async_Transmit(&I2C0_Bus, &bulk[0], BENCH_LCD_ADDR, 0x00, lcd, sizeof(lcd), Bench_Record);
+	I2C_Async_Transmit(&I2C0_Bus, &bulk[1], BENCH_LCD_ADDR, 0x00, lcd, sizeof(lcd), Bench_Record);
+	I2C_Async_Receive(&I2C0_Bus, &config, BENCH_COLOR_ADDR, BENCH_COLOR_CMD | BENCH_COLOR_ID, buf[0], 1, Bench_Record);
+	I2C_Async_Receive(&I2C0_Bus, &realtime[0], BENCH_IMU_ADDR, BENCH_IMU_ACCEL, buf[1], 14, Bench_Record);
+	I2C_Async_Receive(&I2C0_Bus, &realtime[1], BENCH_IMU_ADDR, BENCH_IMU_ACCEL, buf[2], 14, Bench_Record);
+
+	ok = (bulk[0].status == I2C_XFER_ACTIVE) && (realtime[0].status == I2C_XFER_PENDING);
+	Bench_Check("First submit goes on the bus, later ones queue", ok);
+
+	I2C_Async_Wait(&bulk[1]);
+	ok = (Order_Count == 5) && (Order[0] == &bulk[0]) && (Order[1] == &realtime[0]) &&
+			(Order[2] == &realtime[1]) && (Order[3] == &config) && (Order[4] == &bulk[1]);
+	ok &= (bulk[0].error == 0) && (bulk[1].error == 0) && (Lcd.bytes_written == 2 * sizeof(lcd));
+	Bench_Check("In flight BULK, then REALTIME x2, CONFIG, BULK", ok);
+
+	/* A blocking call waits for the transfer on the bus only */
+	Order_Count = 0;
+	I2C_Async_Transmit(&I2C0_Bus, &bulk[0], BENCH_LCD_ADDR, 0x00, lcd, sizeof(lcd), Bench_Record);
+	I2C_Async_Receive(&I2C0_Bus, &realtime[0], BENCH_IMU_ADDR, BENCH_IMU_ACCEL, buf[3], 14, Bench_Record);
+	ok = I2C_Receive(&I2C0_Bus, BENCH_IMU_ADDR, BENCH_IMU_WHO_AM_I) == BENCH_IMU_ADDR;
+	ok &= (Order_Count == 1) && (Order[0] == &bulk[0]) && (realtime[0].status != I2C_XFER_DONE);
+	Bench_Check("Blocking call takes the bus at the next boundary", ok);
+
+	ok = (I2C_Async_Wait(&realtime[0]) == 0) && (buf[3][13] == (uint8_t)(0x10 + 13));
+	Bench_Check("Queued transfer resumes after the blocking call", ok);
+
+	printf("\n");
+}
+
+/*
+ *	------------------Bench_Recovery----------------
+ *	Hold SCL, then SDA low from a stub slave and check that blocking
+ *	and queued calls end in I2C_ERR_TIMEOUT within their deadline,
+ *	that recovery reports the bus state and that traffic resumes
+ *	Input: None
+ *	Output: None
+ */
+static void Bench_Recovery(void){
+	I2C_XFER_t xfer = {0};
+	uint8_t buf[6];
+	uint64_t t0;
+	uint64_t limit;
+	uint8_t err;
+	uint8_t ok;
+
+	Bench_Setup(I2C_SPEED_STANDARD);
+	printf("Timeout and recovery (timeout %lu us)\n", (unsigned long)I2C_DEFAULT_TIMEOUT_US);
+
+	/* Every bus operation waits at most one timeout, plus recovery (~11 SCL clocks at 100kHz) */
+	limit = 4ULL * (SYS_CLOCK_HZ / 1000000) * I2C_DEFAULT_TIMEOUT_US;
+
+	/* Clock stretched forever, the hardware clock-low timeout fires */
+	I2C_Emu_Hold(0, I2C0_Bus.gpio_base, I2C0_Bus.sda_pin, I2C_EMU_HOLD_SCL);
+	t0 = I2C_Emu_Cycles();
+	err = I2C_Transmit(&I2C0_Bus, BENCH_IMU_ADDR, BENCH_IMU_PWR_MGMT_1, 0x02);
+	ok = (err == I2C_ERR_TIMEOUT) && ((I2C_Emu_Cycles() - t0) < limit) && (Imu.regs[BENCH_IMU_PWR_MGMT_1] != 0x02);
+	Bench_Check("SCL held: blocking call reports the clock timeout", ok);
+
+	t0 = I2C_Emu_Cycles();
+	I2C_Async_Receive(&I2C0_Bus, &xfer, BENCH_IMU_ADDR, BENCH_IMU_ACCEL, buf, 6, 0);
+	err = I2C_Async_Wait(&xfer);
+	ok = (err == I2C_ERR_TIMEOUT) && ((I2C_Emu_Cycles() - t0) < limit) && (I2C0_Bus.active == 0);
+	Bench_Check("SCL held: queued transfer reports the clock timeout", ok);
+	I2C_Emu_Hold(0, I2C0_Bus.gpio_base, I2C0_Bus.sda_pin, I2C_EMU_HOLD_NONE);
+
+	/* Data line stuck, only the CYCCNT deadline ends the wait */
+	I2C_Emu_Hold(0, I2C0_Bus.gpio_base, I2C0_Bus.sda_pin, I2C_EMU_HOLD_SDA);
+	t0 = I2C_Emu_Cycles();
+	err = I2C_Burst_Receive(&I2C0_Bus, BENCH_IMU_ADDR, BENCH_IMU_ACCEL, buf, 6);
+	ok = (err == I2C_ERR_TIMEOUT) && ((I2C_Emu_Cycles() - t0) < limit);
+	Bench_Check("SDA held: blocking call times out", ok);
+
+	Bench_Check("SDA held: recovery reports the bus still low", I2C_Bus_Recover(&I2C0_Bus) == 1);
+
+	I2C_Emu_Hold(0, I2C0_Bus.gpio_base, I2C0_Bus.sda_pin, I2C_EMU_HOLD_NONE);
+	Bench_Check("SDA released: recovery frees the bus", I2C_Bus_Recover(&I2C0_Bus) == 0);
+
+	ok = (I2C_Receive(&I2C0_Bus, BENCH_IMU_ADDR, BENCH_IMU_WHO_AM_I) == BENCH_IMU_ADDR);
+	ok &= (I2C_Async_Receive(&I2C0_Bus, &xfer, BENCH_IMU_ADDR, BENCH_IMU_ACCEL, buf, 6, 0) == 0) && (I2C_Async_Wait(&xfer) == 0);
+	ok &= (buf[5] == (uint8_t)(0x10 + 5));
+	Bench_Check("Blocking and queued traffic resume", ok);
+
+	printf("\n");
+}
+
+/*
+ *	-------------------Bench_Shadow-----------------
+ *	Read a configuration register through a shadow cache: the first
+ *	read fills it from the device, repeats must not touch the bus,
+ *	and writes or invalidation must keep it coherent
+ *	Input: None
+ *	Output: None
+ */
+static void Bench_Shadow(void){
+	I2C_SHADOW_t shadow;
+	uint8_t value[BENCH_SHADOW_SIZE];
+	uint32_t valid[I2C_SHADOW_VALID_WORDS(BENCH_SHADOW_SIZE)];
+	uint32_t reads;
+	uint32_t writes;
+	uint64_t t0;
+	uint8_t ok;
+	uint8_t i;
+
+	Bench_Setup(I2C_SPEED_FAST);
+	printf("Shadow cache\n");
+
+	Imu.regs[BENCH_SHADOW_BASE + 1] = 0x03;	// CONFIG, DLPF setting
+
+	shadow.bus = &I2C0_Bus;
+	shadow.slave_addr = BENCH_IMU_ADDR;
+	shadow.cmd = 0;
+	shadow.base_reg = BENCH_SHADOW_BASE;
+	shadow.size = BENCH_SHADOW_SIZE;
+	shadow.value = value;
+	shadow.valid = valid;
+	I2C_Shadow_Invalidate(&shadow);
+
+	t0 = I2C_Emu_Cycles();
+	ok = (I2C_Shadow_Read(&shadow, BENCH_SHADOW_BASE + 1) == 0x03) && (Imu.bytes_read == 1);
+	Bench_Report("Shadow_Read (fill)", I2C_Emu_Cycles() - t0, BITS_BURST_RX(1), I2C_SPEED_FAST, ok);
+
+	reads = Imu.bytes_read;
+	t0 = I2C_Emu_Cycles();
+	ok = 1;
+	for(i = 0; i < 8; i++)
+		ok &= I2C_Shadow_Read(&shadow, BENCH_SHADOW_BASE + 1) == 0x03;
+	ok &= (Imu.bytes_read == reads) && ((I2C_Emu_Cycles() - t0) < 8 * BENCH_NO_WIRE_CYCLES);
+	Bench_Report("Shadow_Read x8 (cached)", I2C_Emu_Cycles() - t0, 0, I2C_SPEED_FAST, ok);
+
+	/* A write goes to the device and updates the cache */
+	writes = Imu.bytes_written;
+	ok = (I2C_Shadow_Write(&shadow, BENCH_SHADOW_BASE + 1, 0x05) == 0) && (Imu.bytes_written == writes + 1);
+	t0 = I2C_Emu_Cycles();
+	ok &= (I2C_Shadow_Read(&shadow, BENCH_SHADOW_BASE + 1) == 0x05) && (Imu.bytes_read == reads);
+	ok &= (I2C_Emu_Cycles() - t0) < BENCH_NO_WIRE_CYCLES;
+	Bench_Check("Shadow_Write updates the cache without a read back", ok);
+
+	/* Invalidation forces the next read back onto the bus */
+	Imu.regs[BENCH_SHADOW_BASE + 1] = 0x06;
+	I2C_Shadow_Invalidate(&shadow);
+	ok = (I2C_Shadow_Read(&shadow, BENCH_SHADOW_BASE + 1) == 0x06) && (Imu.bytes_read == reads + 1);
+	Bench_Check("Shadow_Invalidate refills from the device", ok);
+
+	printf("\n");
+}
+
+int main(void){
+	Bench_Speed(I2C_SPEED_STANDARD);
+	Bench_Speed(I2C_SPEED_FAST);
+	Bench_Priority();
+	Bench_Recovery();
+	Bench_Shadow();
+
+	if(Failures)
+		printf("%u check(s) failed\n", Failures);
+
+	return Failures ? 1 : 0;
+}
@@ -0,0 +1,480 @@
+/*
+ * I2C_Emu.c
+ *
+ *	Register level emulator of the TM4C123 I2C master blocks.
+ *	A master command written to MCS is resolved against the stub
+ *	slaves immediately, but BUSY stays set until the simulated
+ *	clock has advanced by the bits it puts on the wire:
+ *	SCL period = 2 * (SCL_LP + SCL_HP) * (TPR + 1) system clocks.
+ *	The clock only moves on register accesses, CYCCNT reads and
+ *	WaitForInterrupt, so simulated time is bus time plus a fixed
+ *	cost per access, not host CPU time
+ *
+ */
+
+#include "I2C_Emu.h"
+#include "I2C.h"
+#include "tm4c123gh6pm.h"
+#include "util.h"
+
+/* Emulated Address Map */
+#define EMU_I2C_BASE				(0x40020000U)
+#define EMU_I2C_STRIDE			(0x1000U)
+#define EMU_SYSCTL_PRGPIO		(0x400FEA08U)
+#define EMU_SYSCTL_PRI2C		(0x400FEA20U)
+#define EMU_NVIC_EN_FIRST		(0xE000E100U)
+#define EMU_NVIC_EN_LAST		(0xE000E10CU)
+#define EMU_GPIO_DATA				(0x3FCU)
+#define EMU_GPIO_DIR				(0x400U)
+
+/* I2C Master Register Offsets */
+#define EMU_O_MSA						(0x000U)
+#define EMU_O_MCS						(0x004U)
+#define EMU_O_MDR						(0x008U)
+#define EMU_O_MTPR					(0x00CU)
+#define EMU_O_MIMR					(0x010U)
+#define EMU_O_MRIS					(0x014U)
+#define EMU_O_MMIS					(0x018U)
+#define EMU_O_MICR					(0x01CU)
+#define EMU_O_MCR						(0x020U)
+#define EMU_O_MCLKOCNT			(0x024U)
+
+/* Plain Memory for everything that is not an I2C block */
+#define EMU_MEM_SLOTS				(256U)
+
+/* MCS bits that describe the outcome of the last command */
+#define EMU_MCS_RESULT			(I2C_MCS_ERROR | I2C_MCS_ADRACK | I2C_MCS_DATACK | I2C_MCS_ARBLST | I2C_MCS_CLKTO)
+
+typedef struct{
+	uint32_t msa;
+	uint32_t mdr;
+	uint32_t mtpr;
+	uint32_t mimr;
+	uint32_t mris;
+	uint32_t mcr;
+	uint32_t mclkocnt;
+	uint32_t result;								// EMU_MCS_RESULT bits of the last command
+	uint64_t busy_until;						// Simulated cycle the command finishes
+	uint8_t op_pending;							// Command in flight, raises RIS when done
+	uint8_t holding;								// Between START and STOP
+	uint8_t reading;								// Direction of the current transfer
+	uint8_t ptr_next;								// Next written byte loads the slave pointer
+	I2C_EMU_SLAVE_t* target;				// Addressed slave, 0 if NACKed
+	I2C_EMU_SLAVE_t* slaves[I2C_EMU_SLAVES_MAX];
+	uint8_t slave_count;
+	uint8_t hold;										// I2C_EMU_HOLD_* lines held low
+	uint32_t sda_data;							// GPIO DATA register of the SDA pin
+	uint8_t sda_pin;
+} EMU_I2C_t;
+
+typedef struct{
+	uint32_t addr;
+	uint32_t val;
+	uint8_t used;
+} EMU_MEM_t;
+
+extern void I2C0_Handler(void);
+extern void I2C1_Handler(void);
+extern void I2C2_Handler(void);
+extern void I2C3_Handler(void);
+
+static void (* const Emu_Handler[I2C_EMU_MODULES])(void) = {
+	I2C0_Handler, I2C1_Handler, I2C2_Handler, I2C3_Handler
+};
+static const uint8_t Emu_IRQ[I2C_EMU_MODULES] = {
+	I2C0_IRQ_NUM, I2C1_IRQ_NUM, I2C2_IRQ_NUM, I2C3_IRQ_NUM
+};
+
+static EMU_I2C_t Emu_I2C[I2C_EMU_MODULES];
+static EMU_MEM_t Emu_Mem[EMU_MEM_SLOTS];
+static uint64_t Emu_Now;							// Simulated system clock cycles
+static long Emu_Masked;								// PRIMASK
+static uint8_t Emu_In_ISR;						// Handlers do not nest
+
+/*
+ *	------------------Emu_Mem_Slot------------------
+ *	Local function to find (or create) the plain memory cell for
+ *	an address, open addressing on a small table
+ *	Input: Address
+ *	Output: Memory cell
+ */
+static EMU_MEM_t* Emu_Mem_Slot(uint32_t addr){
+	uint32_t i = (addr >> 2) % EMU_MEM_SLOTS;
+	uint32_t n;
+
+	for(n = 0; n < EMU_MEM_SLOTS; n++, i = (i + 1) % EMU_MEM_SLOTS){
+		if(!Emu_Mem[i].used){
+			Emu_Mem[i].used = 1;
+			Emu_Mem[i].addr = addr;
+			Emu_Mem[i].val = 0;
+			return &Emu_Mem[i];
+		}
+		if(Emu_Mem[i].addr == addr)
+			return &Emu_Mem[i];
+	}
+
+	return &Emu_Mem[0];		// Table full, the driver only touches a few dozen cells
+}
+
+/*
+ *	---------------Emu_IRQ_Enabled-----------------
+ *	Local function to check the NVIC enable bit of a module
+ *	Input: Module number
+ *	Output: 1 if enabled
+ */
+static uint8_t Emu_IRQ_Enabled(uint8_t n){
+	uint8_t irq = Emu_IRQ[n];
+
+	return (Emu_Mem_Slot(EMU_NVIC_EN_FIRST + ((irq >> 5) << 2))->val >> (irq & 0x1F)) & 1;
+}
+
+/*
+ *	------------------Emu_Dispatch------------------
+ *	Local function to retire finished commands and run the
+ *	handler of every module with an unmasked pending interrupt
+ *	Input: None
+ *	Output: None
+ */
+static void Emu_Dispatch(void){
+	EMU_I2C_t* m;
+	uint8_t n;
+	uint8_t fired;
+
+	do{
+		fired = 0;
+		for(n = 0; n < I2C_EMU_MODULES; n++){
+			m = &Emu_I2C[n];
+
+			if(m->op_pending && (Emu_Now >= m->busy_until)){
+				m->op_pending = 0;
+				m->mris |= I2C_MRIS_RIS;
+				if(m->result & I2C_MCS_CLKTO)
+					m->mris |= I2C_MRIS_CLKRIS;
+			}
+
+			if(Emu_Masked || Emu_In_ISR || !Emu_IRQ_Enabled(n))
+				continue;
+
+			if(m->mris & m->mimr){
+				Emu_In_ISR = 1;
+				Emu_Handler[n]();
+				Emu_In_ISR = 0;
+				fired = 1;
+			}
+		}
+	}while(fired);
+}
+
+/*
+ *	--------------------Emu_Tick--------------------
+ *	Local function to advance the simulated clock
+ *	Input: Cycles
+ *	Output: None
+ */
+static void Emu_Tick(uint32_t cycles){
+	Emu_Now += cycles;
+	Emu_Dispatch();
+}
+
+/*
+ *	------------------Emu_Find_Slave----------------
+ *	Local function to look up the device answering an address
+ *	Input: Module, 7-bit address
+ *	Output: Slave, 0 if nobody ACKs
+ */
+static I2C_EMU_SLAVE_t* Emu_Find_Slave(EMU_I2C_t* m, uint8_t addr){
+	uint8_t i;
+
+	for(i = 0; i < m->slave_count; i++){
+		if(m->slaves[i]->addr == addr)
+			return m->slaves[i];
+	}
+
+	return 0;
+}
+
+/*
+ *	------------------Emu_Command-------------------
+ *	Local function to execute a master command written to MCS
+ *	Input: Module, Command (RUN/START/STOP/ACK)
+ *	Output: None
+ */
+static void Emu_Command(EMU_I2C_t* m, uint32_t cmd){
+	uint32_t period = 2 * (I2C_SCL_LP + I2C_SCL_HP) * ((m->mtpr & I2C_MTPR_TPR_M) + 1);
+	uint32_t bits = 0;
+	I2C_EMU_SLAVE_t* s;
+
+	if(!(m->mcr & I2C_MCR_MFE))
+		return;
+
+	m->result = 0;
+
+	/* SDA held low, the command waits for the bus forever */
+	if(m->hold & I2C_EMU_HOLD_SDA){
+		m->holding = 1;
+		m->busy_until = UINT64_MAX;
+		m->op_pending = 0;
+		return;
+	}
+
+	/* SCL held low, the clock-low counter (MCLKOCNT x 16 SCL periods) runs out, the master sends STOP */
+	if(m->hold & I2C_EMU_HOLD_SCL){
+		m->result = I2C_MCS_CLKTO;
+		m->holding = 0;
+		m->target = 0;
+		m->busy_until = Emu_Now + (uint64_t)(m->mclkocnt << 4) * period;
+		m->op_pending = 1;
+		return;
+	}
+
+	/* START (or repeated START) puts the address byte on the wire */
+	if(cmd & I2C_MCS_START){
+		bits += I2C_EMU_START_BITS + I2C_EMU_BYTE_BITS;
+		m->holding = 1;
+		m->reading = m->msa & I2C_MSA_RS;
+		m->target = Emu_Find_Slave(m, (uint8_t)(m->msa >> 1));
+		m->ptr_next = !m->reading;
+		if(m->target == 0)
+			m->result = I2C_MCS_ERROR | I2C_MCS_ADRACK;
+	}
+
+	/* RUN moves one data byte, skipped after an address NACK */
+	if((cmd & I2C_MCS_RUN) && m->holding && (m->target != 0)){
+		s = m->target;
+		bits += I2C_EMU_BYTE_BITS;
+
+		if(m->reading){
+			m->mdr = s->regs[s->ptr];
+			s->ptr = (s->ptr + 1) & s->reg_mask;
+			s->bytes_read++;
+		}
+		else if(m->ptr_next){
+			s->ptr = m->mdr & s->reg_mask;
+			m->ptr_next = 0;
+		}
+		else{
+			s->regs[s->ptr] = (uint8_t)m->mdr;
+			s->ptr = (s->ptr + 1) & s->reg_mask;
+			s->bytes_written++;
+		}
+	}
+
+	if(cmd & I2C_MCS_STOP){
+		bits += I2C_EMU_STOP_BITS;
+		m->holding = 0;
+		m->target = 0;
+	}
+
+	m->busy_until = Emu_Now + (uint64_t)bits * period;
+	m->op_pending = 1;
+}
+
+/*
+ *	-----------------I2C_Emu_Reset------------------
+ *	Clear every register, detach all slaves and zero the clock
+ *	Input: None
+ *	Output: None
+ */
+void I2C_Emu_Reset(void){
+	uint32_t i;
+	uint8_t n;
+
+	for(n = 0; n < I2C_EMU_MODULES; n++){
+		Emu_I2C[n] = (EMU_I2C_t){0};
+		Emu_I2C[n].mtpr = 0x1;						// Reset value
+	}
+	for(i = 0; i < EMU_MEM_SLOTS; i++)
+		Emu_Mem[i].used = 0;
+
+	Emu_Now = 0;
+	Emu_Masked = 0;
+	Emu_In_ISR = 0;
+}
+
+/*
+ *	-----------------I2C_Emu_Attach-----------------
+ *	Put a stub slave on one of the emulated buses
+ *	Input: Module number (n in I2Cn), Slave
+ *	Output: 0 if attached, 1 if the bus is full
+ */
+uint8_t I2C_Emu_Attach(uint8_t module, I2C_EMU_SLAVE_t* slave){
+	EMU_I2C_t* m = &Emu_I2C[module % I2C_EMU_MODULES];
+
+	if(m->slave_count == I2C_EMU_SLAVES_MAX)
+		return 1;
+
+	slave->ptr = 0;
+	m->slaves[m->slave_count++] = slave;
+	return 0;
+}
+
+/*
+ *	------------------I2C_Emu_Hold------------------
+ *	Have a slave hold bus lines low until called again with
+ *	I2C_EMU_HOLD_NONE. Disabling the master (MCR) abandons the
+ *	stalled command, as bus recovery does on target
+ *	Input: Module number, GPIO port base and SDA pin mask of the bus,
+ *				 Held lines (I2C_EMU_HOLD_SCL | I2C_EMU_HOLD_SDA)
+ *	Output: None
+ */
+void I2C_Emu_Hold(uint8_t module, uint32_t gpio_base, uint8_t sda_pin, uint8_t lines){
+	EMU_I2C_t* m = &Emu_I2C[module % I2C_EMU_MODULES];
+
+	m->hold = lines;
+	m->sda_data = gpio_base + EMU_GPIO_DATA;
+	m->sda_pin = sda_pin;
+}
+
+/*
+ *	-----------------I2C_Emu_Cycles-----------------
+ *	Simulated CPU cycles since reset (bus time plus register accesses)
+ *	Input: None
+ *	Output: Cycle count
+ */
+uint64_t I2C_Emu_Cycles(void){
+	return Emu_Now;
+}
+
+/*
+ *	------------------I2C_Emu_Read------------------
+ *	Register read used by REG_RD in I2C.c
+ *	Input: Address
+ *	Output: Register value
+ */
+uint32_t I2C_Emu_Read(uint32_t addr){
+	EMU_I2C_t* m;
+	uint32_t dir;
+	uint32_t val;
+	uint8_t n;
+
+	Emu_Tick(I2C_EMU_ACCESS_CYCLES);
+
+	/* I2C master blocks */
+	if((addr >= EMU_I2C_BASE) && (addr < EMU_I2C_BASE + I2C_EMU_MODULES * EMU_I2C_STRIDE)){
+		m = &Emu_I2C[(addr - EMU_I2C_BASE) / EMU_I2C_STRIDE];
+		switch(addr & (EMU_I2C_STRIDE - 1)){
+			case EMU_O_MSA:				return m->msa;
+			case EMU_O_MDR:				return m->mdr;
+			case EMU_O_MTPR:			return m->mtpr;
+			case EMU_O_MIMR:			return m->mimr;
+			case EMU_O_MRIS:			return m->mris;
+			case EMU_O_MMIS:			return m->mris & m->mimr;
+			case EMU_O_MCR:				return m->mcr;
+			case EMU_O_MCLKOCNT:	return m->mclkocnt;
+			case EMU_O_MCS:
+				if(Emu_Now < m->busy_until)
+					return I2C_MCS_BUSY | I2C_MCS_BUSBSY;
+				return m->result | (m->holding ? I2C_MCS_BUSBSY : I2C_MCS_IDLE);
+			default:							return 0;
+		}
+	}
+
+	/* Peripherals are ready as soon as they are clocked */
+	if((addr == EMU_SYSCTL_PRGPIO) || (addr == EMU_SYSCTL_PRI2C))
+		return 0xFFFFFFFF;
+
+	/* GPIO inputs float high (pull-ups), outputs read back what was driven, a held SDA reads low */
+	if((addr & 0xFFF) == EMU_GPIO_DATA){
+		dir = Emu_Mem_Slot(addr - EMU_GPIO_DATA + EMU_GPIO_DIR)->val;
+		val = (Emu_Mem_Slot(addr)->val & dir) | (~dir & 0xFF);
+		for(n = 0; n < I2C_EMU_MODULES; n++){
+			if((Emu_I2C[n].hold & I2C_EMU_HOLD_SDA) && (Emu_I2C[n].sda_data == addr))
+				val &= ~(uint32_t)Emu_I2C[n].sda_pin;
+		}
+		return val;
+	}
+
+	return Emu_Mem_Slot(addr)->val;
+}
+
+/*
+ *	-----------------I2C_Emu_Write------------------
+ *	Register write used by REG_WR in I2C.c
+ *	Input: Address, Value
+ *	Output: None
+ */
+void I2C_Emu_Write(uint32_t addr, uint32_t val){
+	EMU_I2C_t* m;
+
+	Emu_Tick(I2C_EMU_ACCESS_CYCLES);
+
+	if((addr >= EMU_I2C_BASE) && (addr < EMU_I2C_BASE + I2C_EMU_MODULES * EMU_I2C_STRIDE)){
+		m = &Emu_I2C[(addr - EMU_I2C_BASE) / EMU_I2C_STRIDE];
+		switch(addr & (EMU_I2C_STRIDE - 1)){
+			case EMU_O_MSA:				m->msa = val & 0xFF;										break;
+			case EMU_O_MDR:				m->mdr = val & 0xFF;										break;
+			case EMU_O_MTPR:			m->mtpr = val & I2C_MTPR_TPR_M;					break;
+			case EMU_O_MIMR:			m->mimr = val;													break;
+			case EMU_O_MICR:			m->mris &= ~val;												break;
+			case EMU_O_MCR:
+				m->mcr = val;
+				if(!(val & I2C_MCR_MFE)){										// Master reset abandons any command
+					m->op_pending = 0;
+					m->busy_until = 0;
+					m->holding = 0;
+					m->target = 0;
+					m->result = 0;
+				}
+				break;
+			case EMU_O_MCLKOCNT:	m->mclkocnt = val;											break;
+			case EMU_O_MCS:				Emu_Command(m, val);										break;
+			default:																										break;
+		}
+		Emu_Dispatch();												// Unmasking MIMR may fire at once
+		return;
+	}
+
+	/* NVIC set-enable registers are write 1 to set */
+	if((addr >= EMU_NVIC_EN_FIRST) && (addr <= EMU_NVIC_EN_LAST)){
+		Emu_Mem_Slot(addr)->val |= val;
+		return;
+	}
+
+	Emu_Mem_Slot(addr)->val = val;
+}
+
+/* Cycle Counter (util.c on target) */
+void CYCCNT_Init(void){
+}
+
+uint32_t CYCCNT_Read(void){
+	Emu_Tick(1);
+	return (uint32_t)Emu_Now;
+}
+
+/* Interrupt Control (startup.s on target) */
+void DisableInterrupts(void){
+	Emu_Masked = 1;
+}
+
+void EnableInterrupts(void){
+	Emu_Masked = 0;
+	Emu_Dispatch();
+}
+
+long StartCritical(void){
+	long sr = Emu_Masked;
+
+	Emu_Masked = 1;
+	return sr;
+}
+
+void EndCritical(long sr){
+	Emu_Masked = sr;
+	Emu_Dispatch();
+}
+
+/* Sleep until the next command completes (or a short idle if nothing is in flight) */
+void WaitForInterrupt(void){
+	uint64_t wake = Emu_Now + 1000;
+	uint8_t n;
+
+	for(n = 0; n < I2C_EMU_MODULES; n++){
+		if(Emu_I2C[n].op_pending && (Emu_I2C[n].busy_until < wake))
+			wake = Emu_I2C[n].busy_until;
+	}
+
+	if(wake > Emu_Now)
+		Emu_Now = wake;
+	Emu_Dispatch();
+}
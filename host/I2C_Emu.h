@@ -0,0 +1,97 @@
+/*
+ * I2C_Emu.h
+ *
+ *	Register level emulator of the TM4C123 I2C master blocks for
+ *	running I2C.c on a host machine. Models MSA/MCS/MDR/MTPR/MIMR/
+ *	MRIS/MMIS/MICR/MCR with bus timing derived from MTPR, raises
+ *	I2Cn_Handler on completion, and provides CYCCNT and the
+ *	startup.s interrupt helpers. Everything else (SYSCTL, GPIO,
+ *	NVIC) is plain memory
+ *
+ */
+
+#ifndef I2C_EMU_H_
+#define I2C_EMU_H_
+
+#include <stdint.h>
+
+/* Emulator Limits */
+#define I2C_EMU_MODULES				(4U)          // I2C0 - I2C3
+#define I2C_EMU_SLAVES_MAX		(8U)          // Devices per bus
+#define I2C_EMU_ACCESS_CYCLES	(2U)          // CPU cycles charged per register access
+
+/* Bus Timing (bits on the wire per master command) */
+#define I2C_EMU_START_BITS		(1U)          // START / repeated START
+#define I2C_EMU_BYTE_BITS			(9U)          // 8 data bits + ACK
+#define I2C_EMU_STOP_BITS			(1U)          // STOP
+
+/* Fault Injection (lines a misbehaving slave holds low) */
+#define I2C_EMU_HOLD_NONE			(0x0U)
+#define I2C_EMU_HOLD_SCL			(0x1U)        // Clock stretched forever, commands end in CLKTO after MCLKOCNT
+#define I2C_EMU_HOLD_SDA			(0x2U)        // Data stuck low, commands never finish and SDA reads low as GPIO
+
+/* Stub Slave, a register file with an auto-incrementing pointer.
+	 The first byte written after the address sets the pointer (masked
+	 with reg_mask so command bits such as the TCS34727 0x80/0xA0 are
+	 dropped), following writes store and increment, reads increment */
+typedef struct{
+	uint8_t addr;										// 7-bit slave address
+	uint8_t reg_mask;								// Pointer bits the device decodes
+	uint8_t ptr;										// Register pointer
+	uint8_t regs[256];							// Register file
+	uint32_t bytes_written;					// Data bytes received (pointer byte excluded)
+	uint32_t bytes_read;						// Data bytes returned
+} I2C_EMU_SLAVE_t;
+
+/*
+ *	-----------------I2C_Emu_Reset------------------
+ *	Clear every register, detach all slaves and zero the clock
+ *	Input: None
+ *	Output: None
+ */
+void I2C_Emu_Reset(void);
+
+/*
+ *	-----------------I2C_Emu_Attach-----------------
+ *	Put a stub slave on one of the emulated buses
+ *	Input: Module number (n in I2Cn), Slave
+ *	Output: 0 if attached, 1 if the bus is full
+ */
+uint8_t I2C_Emu_Attach(uint8_t module, I2C_EMU_SLAVE_t* slave);
+
+/*
+ *	------------------I2C_Emu_Hold------------------
+ *	Have a slave hold bus lines low until called again with
+ *	I2C_EMU_HOLD_NONE. Disabling the master (MCR) abandons the
+ *	stalled command, as bus recovery does on target
+ *	Input: Module number, GPIO port base and SDA pin mask of the bus,
+ *				 Held lines (I2C_EMU_HOLD_SCL | I2C_EMU_HOLD_SDA)
+ *	Output: None
+ */
+void I2C_Emu_Hold(uint8_t module, uint32_t gpio_base, uint8_t sda_pin, uint8_t lines);
+
+/*
+ *	-----------------I2C_Emu_Cycles-----------------
+ *	Simulated CPU cycles since reset (bus time plus register accesses)
+ *	Input: None
+ *	Output: Cycle count
+ */
+uint64_t I2C_Emu_Cycles(void);
+
+/*
+ *	------------------I2C_Emu_Read------------------
+ *	Register read used by REG_RD in I2C.c
+ *	Input: Address
+ *	Output: Register value
+ */
+uint32_t I2C_Emu_Read(uint32_t addr);
+
+/*
+ *	-----------------I2C_Emu_Write------------------
+ *	Register write used by REG_WR in I2C.c
+ *	Input: Address, Value
+ *	Output: None
+ */
+void I2C_Emu_Write(uint32_t addr, uint32_t val);
+
+#endif //I2C_EMU_H_
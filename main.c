@@ -18,37 +18,49 @@
 #include <math.h>      // For atan2f, sqrtf (if MPU6050_Get_Angle uses them)
 
 // Declare MPU6050 data structures globally or locally if preferred
+MPU6050_t IMU_Instance;
 MPU6050_ACCEL_t Accel_Instance;
 MPU6050_GYRO_t  Gyro_Instance;
 MPU6050_ANGLE_t Angle_Instance;
+MPU6050_SAMPLE_t Sample_Instance;
 
 char printBuffer[100]; // Buffer for sprintf
 
 int main(void){
+    uint32_t i;
+    
     /* Initialize UART0 for communication */
     UART0_Init();
     UART0_OutString("MPU6050 Angle Reading Demo\r\n");
     
     /* Initialize I2C0 for communication with MPU6050 */
-    I2C0_Init();
+    I2C_Init(&I2C0_Bus);
+    
+    /* MPU6050 is the only device on the bus, run it in Fast-mode (400kHz) */
+    I2C_Set_Speed(&I2C0_Bus, I2C_SPEED_FAST);
     
     /* Initialize MPU6050 */
-    MPU6050_Init(); // Initialize the MPU6050 sensor
+    MPU6050_Init(&IMU_Instance, &I2C0_Bus, MPU6050_ADDR_AD0_LOW); // Initialize the MPU6050 sensor
+    
+    /* Read every sample on the data-ready edge instead of pacing with a delay */
+    MPU6050_DRDY_Init(&IMU_Instance);
     
     /* Run the MPU6050 Reading Loop */
     // Module_Test(TCS34727_TEST); // Commented out TCS test
     
     while(1){
-        // 1. Get Raw Sensor Data
-        MPU6050_Get_Accel(&Accel_Instance);
-        MPU6050_Get_Gyro(&Gyro_Instance); 
+        // 1. Sleep until the 100th data-ready sample (10 Hz update rate at 1kHz)
+        for(i = 0; i < 100; i++)
+            MPU6050_DRDY_Wait(&IMU_Instance, &Sample_Instance);
+        Accel_Instance = Sample_Instance.Accel;
+        Gyro_Instance = Sample_Instance.Gyro;
         
         // Optional: Process raw data into physical units (g's, deg/s)
-        MPU6050_Process_Accel(&Accel_Instance);
-        // MPU6050_Process_Gyro(&Gyro_Instance);
+        MPU6050_Process_Accel(&IMU_Instance, &Accel_Instance);
+        // MPU6050_Process_Gyro(&IMU_Instance, &Gyro_Instance);
 
         // 2. Calculate Angles (using accelerometer data in this implementation)
-        MPU6050_Get_Angle(&Accel_Instance, &Gyro_Instance, &Angle_Instance);
+        MPU6050_Get_Angle(&IMU_Instance, &Accel_Instance, &Gyro_Instance, &Angle_Instance);
         
         // 3. Format and Print Angles via UART
         //    Using %f requires floating point support in printf/sprintf
@@ -60,9 +72,6 @@ int main(void){
                 Accel_Instance.Az_RAW,               // Print Raw Z value
                 Angle_Instance.ArX, Angle_Instance.ArY);
         UART0_OutString(printBuffer);
-        
-        // 4. Delay 
-        DELAY_1MS(100); // Delay 100 ms (10 Hz update rate)
     }
     
     // This point should never be reached in this setup
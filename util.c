@@ -14,6 +14,12 @@
 
 /* Local Macros */
 #define TIMER_32_MAX_RELOAD		(4294967295)	
+
+/* Cortex-M4 Data Watchpoint and Trace cycle counter (not in tm4c123gh6pm.h) */
+#define DWT_CTRL_R						(*((volatile uint32_t *)0xE0001000))
+#define DWT_CYCCNT_R					(*((volatile uint32_t *)0xE0001004))
+#define DWT_CTRL_CYCCNTENA		(0x00000001)	// Enable cycle counter
+#define DEMCR_TRCENA					(0x01000000)	// Enable DWT in Debug Exception and Monitor Control
  
 /* The reason why Wide Timer is used instead of regular time is because
 	 of the prescaler option */
@@ -41,6 +47,20 @@ void DELAY_1MS(uint32_t delay){
 	WTIMER0_CTL_R &= ~(WTIMER0_TAEN_BIT);
 }
 
+/* Free running 32-bit count of core clock cycles, wraps every ~268s at 16MHz.
+	 Compare timestamps with unsigned subtraction so wrap-around is harmless */
+void CYCCNT_Init(void){
+	if(DWT_CTRL_R & DWT_CTRL_CYCCNTENA)
+		return;																					//Already running
+	NVIC_DBG_INT_R |= DEMCR_TRCENA;										//Power up DWT block
+	DWT_CYCCNT_R = 0;
+	DWT_CTRL_R |= DWT_CTRL_CYCCNTENA;									//Start counting
+}
+
+uint32_t CYCCNT_Read(void){
+	return DWT_CYCCNT_R;
+}
+
 int16_t map(int16_t x, int16_t x_min, int16_t x_max, int16_t out_min, int16_t out_max){
 	if(x < x_min){
 		return x_min;
@@ -50,3 +70,16 @@ int16_t map(int16_t x, int16_t x_min, int16_t x_max, int16_t out_min, int16_t ou
 	}
 	return (x - x_min) * (out_max - out_min) / (x_max - x_min) + out_min;
 }
+
+uint32_t CRC32(const uint8_t* data, uint32_t len){
+	uint32_t crc = 0xFFFFFFFF;
+	uint8_t bit;
+	
+	while(len--){
+		crc ^= *data++;
+		for(bit = 0; bit < 8; bit++)
+			crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));			//Bitwise, no table, only runs on save/load
+	}
+	
+	return ~crc;
+}
@@ -18,6 +18,9 @@
 #define CONSTANT_FILL	(50)     // a place holder for all constants needs to be defined by students
 #define CODE_FILL	(0)     // a place holder for code needs to be defined by students
 
+/* System Clock (16MHz PIOSC, PLL is not configured) */
+#define SYS_CLOCK_HZ					(16000000)
+
 /* List of Fill In Macros */
 #define EN_WTIMER0_CLOCK			(0x01)     // Enable WTIMER0 clock
 #define WTIMER0_TAEN_BIT			(0x01)     // Timer A enable bit
@@ -25,8 +28,18 @@
 #define WTIMER0_PERIOD_MODE		(0x02)     // Periodic mode
 #define PRESCALER_VALUE				(16000)    // Prescaler value for 1ms period
 
+/* Interrupt Control (Defined in startup.s) */
+void DisableInterrupts(void);
+void EnableInterrupts(void);
+long StartCritical(void);
+void EndCritical(long sr);
+void WaitForInterrupt(void);
+
 void WTIMER0_Init(void);
 void DELAY_1MS(uint32_t);
+void CYCCNT_Init(void);
+uint32_t CYCCNT_Read(void);
 int16_t map(int16_t, int16_t, int16_t, int16_t, int16_t);
+uint32_t CRC32(const uint8_t* data, uint32_t len);		// IEEE 802.3 (reflected 0xEDB88320)
 
 #endif
\ No newline at end of file